@@ -0,0 +1,80 @@
+#include "ClassWriter.h"
+
+#include <benchmark/benchmark.h>
+#include <jvm/ClassLoader.h>
+#include <jvm/Opcode.h>
+
+#include <sese/io/InputBufferWrapper.h>
+
+#include <fstream>
+#include <iterator>
+
+namespace {
+    std::vector<uint8_t> readFile(const char *path) {
+        std::ifstream input(path, std::ios::binary);
+        return {std::istreambuf_iterator<char>(input), std::istreambuf_iterator<char>()};
+    }
+
+    /// 生成包含 count 个 (I)I 静态方法的类
+    std::vector<uint8_t> syntheticClass(int64_t count) {
+        bench::ClassWriter writer("Synthetic");
+        auto code = bench::CodeBuilder().op(jvm::iload_0).op(jvm::ireturn).build();
+        for (int64_t i = 0; i < count; ++i) {
+            writer.method("m" + std::to_string(i), "(I)I", 1, 1, code);
+        }
+        return writer.bytes();
+    }
+
+    const char *resource(int64_t index) {
+        constexpr const char *paths[] = {
+            PATH_TO_WORLD_CLASS,
+            PATH_TO_PRIME_CALCULATOR_CLASS,
+            PATH_TO_PI_CALCULATOR_CLASS
+        };
+        return paths[index];
+    }
+
+    void BM_LoadFromFile(benchmark::State &state) {
+        auto path = resource(state.range(0));
+        auto size = readFile(path).size();
+        for (auto _: state) {
+            benchmark::DoNotOptimize(jvm::ClassLoader::loadFromFile(path));
+        }
+        state.SetLabel(path);
+        state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * size));
+    }
+
+    void BM_LoadFromStream(benchmark::State &state) {
+        auto bytes = readFile(resource(state.range(0)));
+        for (auto _: state) {
+            sese::io::InputBufferWrapper input(reinterpret_cast<const char *>(bytes.data()), bytes.size());
+            benchmark::DoNotOptimize(jvm::ClassLoader::loadFromStream(&input));
+        }
+        state.SetLabel(resource(state.range(0)));
+        state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * bytes.size()));
+    }
+
+    void BM_LoadFromMemory(benchmark::State &state) {
+        auto bytes = readFile(resource(state.range(0)));
+        for (auto _: state) {
+            benchmark::DoNotOptimize(jvm::ClassLoader::loadFromMemory(bytes.data(), bytes.size()));
+        }
+        state.SetLabel(resource(state.range(0)));
+        state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * bytes.size()));
+    }
+
+    void BM_LoadSynthetic(benchmark::State &state) {
+        auto bytes = syntheticClass(state.range(0));
+        for (auto _: state) {
+            sese::io::InputBufferWrapper input(reinterpret_cast<const char *>(bytes.data()), bytes.size());
+            benchmark::DoNotOptimize(jvm::ClassLoader::loadFromStream(&input));
+        }
+        state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * bytes.size()));
+        state.SetItemsProcessed(state.iterations() * state.range(0));
+    }
+}
+
+BENCHMARK(BM_LoadFromFile)->DenseRange(0, 2);
+BENCHMARK(BM_LoadFromStream)->DenseRange(0, 2);
+BENCHMARK(BM_LoadFromMemory)->DenseRange(0, 2);
+BENCHMARK(BM_LoadSynthetic)->RangeMultiplier(16)->Range(16, 4096);
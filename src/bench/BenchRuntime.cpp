@@ -0,0 +1,229 @@
+#include "ClassWriter.h"
+
+#include <benchmark/benchmark.h>
+#include <jvm/ClassLoader.h>
+#include <jvm/Jit.h>
+#include <jvm/Opcode.h>
+#include <jvm/Runtime.h>
+
+#include <sese/io/InputBufferWrapper.h>
+
+#include <functional>
+
+namespace {
+    /// 每轮循环中被测序列重复的次数，摊薄循环本身的开销
+    constexpr int repeat = 32;
+
+    /// 生成 Kernel.run(I)I：循环 n 次，每次执行 repeat 遍被测序列，
+    /// 局部变量 1 为 int 累加器，2-3 为 double 累加器，被测序列需保持操作数栈平衡
+    std::shared_ptr<jvm::Class> kernelClass(const std::function<void(bench::ClassWriter &, bench::CodeBuilder &)> &body) {
+        bench::ClassWriter writer("Kernel");
+        bench::CodeBuilder callee;
+        callee.op(jvm::iload_0).op(jvm::ireturn);
+        writer.method("callee", "(I)I", 1, 1, callee.build());
+
+        bench::CodeBuilder code;
+        auto loop = code.label();
+        auto end = code.label();
+        code.op(jvm::iconst_0).op(jvm::istore_1);
+        code.op(jvm::dconst_0).op(jvm::dstore_2);
+        code.bind(loop);
+        code.op(jvm::iload_0).branch(jvm::ifle, end);
+        for (int i = 0; i < repeat; ++i) body(writer, code);
+        code.op(jvm::iinc).u1(0).u1(static_cast<uint8_t>(-1));
+        code.branch(jvm::goto_, loop);
+        code.bind(end);
+        code.op(jvm::iload_1).op(jvm::ireturn);
+        writer.method("run", "(I)I", 4, 4, code.build());
+
+        auto bytes = writer.bytes();
+        sese::io::InputBufferWrapper input(reinterpret_cast<const char *>(bytes.data()), bytes.size());
+        return jvm::ClassLoader::loadFromStream(&input);
+    }
+
+    void runKernel(benchmark::State &state, const std::shared_ptr<jvm::Class> &class_) {
+        jvm::Runtime runtime;
+        runtime.setJit(state.range(0) != 0);
+        runtime.regClass(class_);
+        std::vector<jvm::Slot> args(1);
+        args[0].i = 1024;
+        for (auto _: state) {
+            benchmark::DoNotOptimize(runtime.invokeStatic("Kernel", "run(I)I", args));
+        }
+        state.SetItemsProcessed(state.iterations() * args[0].i * repeat);
+    }
+
+    using Body = bench::CodeBuilder &;
+
+    void BM_Opcode_nop(benchmark::State &state) {
+        runKernel(state, kernelClass([](auto &, Body code) { code.op(jvm::nop); }));
+    }
+
+    void BM_Opcode_iload_istore(benchmark::State &state) {
+        runKernel(state, kernelClass([](auto &, Body code) { code.op(jvm::iload_1).op(jvm::istore_1); }));
+    }
+
+    void BM_Opcode_iadd(benchmark::State &state) {
+        runKernel(state, kernelClass([](auto &, Body code) {
+            code.op(jvm::iload_1).op(jvm::iload_0).op(jvm::iadd).op(jvm::istore_1);
+        }));
+    }
+
+    void BM_Opcode_imul(benchmark::State &state) {
+        runKernel(state, kernelClass([](auto &, Body code) {
+            code.op(jvm::iload_1).op(jvm::iload_0).op(jvm::imul).op(jvm::istore_1);
+        }));
+    }
+
+    void BM_Opcode_idiv(benchmark::State &state) {
+        runKernel(state, kernelClass([](auto &, Body code) {
+            code.op(jvm::iload_1).op(jvm::iload_0).op(jvm::idiv).op(jvm::istore_1);
+        }));
+    }
+
+    void BM_Opcode_iinc(benchmark::State &state) {
+        runKernel(state, kernelClass([](auto &, Body code) { code.op(jvm::iinc).u1(1).u1(1); }));
+    }
+
+    void BM_Opcode_dadd(benchmark::State &state) {
+        runKernel(state, kernelClass([](auto &, Body code) {
+            code.op(jvm::dload_2).op(jvm::dconst_1).op(jvm::dadd).op(jvm::dstore_2);
+        }));
+    }
+
+    void BM_Opcode_i2d(benchmark::State &state) {
+        runKernel(state, kernelClass([](auto &, Body code) { code.op(jvm::iload_0).op(jvm::i2d).op(jvm::dstore_2); }));
+    }
+
+    void BM_Opcode_goto(benchmark::State &state) {
+        runKernel(state, kernelClass([](auto &, Body code) {
+            auto next = code.label();
+            code.branch(jvm::goto_, next).bind(next);
+        }));
+    }
+
+    void BM_Invokestatic(benchmark::State &state) {
+        runKernel(state, kernelClass([](bench::ClassWriter &writer, Body code) {
+            auto callee = writer.methodRef("Kernel", "callee", "(I)I");
+            code.op(jvm::iload_1).op(jvm::invokestatic).u2(callee).op(jvm::istore_1);
+        }));
+    }
+
+    /// 宿主直接调用只返回参数的静态方法，衡量每次调用的固定开销
+    void BM_HostCall(benchmark::State &state) {
+        jvm::Runtime runtime;
+        runtime.setJit(state.range(0) != 0);
+        runtime.regClass(kernelClass([](auto &, Body code) { code.op(jvm::nop); }));
+        auto callee = runtime.findStatic("Kernel", "callee(I)I");
+        int32_t i = 0;
+        for (auto _: state) {
+            benchmark::DoNotOptimize(runtime.invoke<int32_t>(callee, i++));
+        }
+    }
+
+    void BM_HostCall_invokeStatic(benchmark::State &state) {
+        jvm::Runtime runtime;
+        runtime.setJit(state.range(0) != 0);
+        runtime.regClass(kernelClass([](auto &, Body code) { code.op(jvm::nop); }));
+        std::vector<jvm::Slot> args(1);
+        for (auto _: state) {
+            benchmark::DoNotOptimize(runtime.invokeStatic("Kernel", "callee(I)I", args));
+            ++args[0].i;
+        }
+    }
+
+    /// 批量调用，参数为每批的调用次数与线程数，工作线程在各批之间复用
+    void BM_HostCall_invokeBatch(benchmark::State &state) {
+        jvm::Runtime runtime;
+        runtime.regClass(kernelClass([](auto &, Body code) { code.op(jvm::nop); }));
+        auto callee = runtime.findStatic("Kernel", "callee(I)I");
+        std::vector<jvm::Slot> args(static_cast<size_t>(state.range(0))), results(args.size());
+        for (size_t i = 0; i < args.size(); ++i) {
+            args[i].i = static_cast<int32_t>(i);
+        }
+        for (auto _: state) {
+            runtime.invokeBatch(callee, args.data(), results.data(), args.size(),
+                                static_cast<size_t>(state.range(1)));
+            benchmark::DoNotOptimize(results.data());
+        }
+        state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(args.size()));
+    }
+
+    void BM_World(benchmark::State &state) {
+        jvm::Runtime runtime;
+        runtime.setJit(state.range(0) != 0);
+        runtime.regClass(jvm::ClassLoader::loadFromFile(PATH_TO_WORLD_CLASS));
+        for (auto _: state) {
+            runtime.run();
+        }
+    }
+
+    void BM_PrimeCalculator(benchmark::State &state) {
+        jvm::Runtime runtime;
+        runtime.setJit(state.range(1) != 0);
+        runtime.regClass(jvm::ClassLoader::loadFromFile(PATH_TO_PRIME_CALCULATOR_CLASS));
+        std::vector<jvm::Slot> args(1);
+        args[0].i = static_cast<int32_t>(state.range(0));
+        for (auto _: state) {
+            benchmark::DoNotOptimize(runtime.invokeStatic("PrimeCalculator", "findNthPrime(I)I", args));
+        }
+    }
+
+    /// 开启性能剖析前后的解释执行，衡量剖析的开销
+    void BM_PrimeCalculator_profiler(benchmark::State &state) {
+        jvm::Runtime runtime;
+        runtime.regClass(jvm::ClassLoader::loadFromFile(PATH_TO_PRIME_CALCULATOR_CLASS));
+        jvm::Profiler profiler;
+        if (state.range(1)) runtime.setProfiler(&profiler);
+        runtime.setFusion(false);
+        std::vector<jvm::Slot> args(1);
+        args[0].i = static_cast<int32_t>(state.range(0));
+        for (auto _: state) {
+            benchmark::DoNotOptimize(runtime.invokeStatic("PrimeCalculator", "findNthPrime(I)I", args));
+        }
+    }
+
+    void BM_PiCalculator(benchmark::State &state) {
+        jvm::Runtime runtime;
+        runtime.setJit(state.range(1) != 0);
+        runtime.regClass(jvm::ClassLoader::loadFromFile(PATH_TO_PI_CALCULATOR_CLASS));
+        std::vector<jvm::Slot> args(1);
+        args[0].i = static_cast<int32_t>(state.range(0));
+        for (auto _: state) {
+            benchmark::DoNotOptimize(runtime.invokeStatic("PiCalculator", "calculatePi(I)D", args));
+        }
+        state.SetItemsProcessed(state.iterations() * state.range(0));
+    }
+
+    /// JIT 不受支持的平台上只测量解释器
+    void modes(benchmark::internal::Benchmark *bench) {
+        bench->ArgName("jit")->Arg(0);
+        if (jvm::Jit::supported()) bench->Arg(1);
+    }
+
+    void sizes(benchmark::internal::Benchmark *bench, std::initializer_list<int64_t> values) {
+        bench->ArgNames({"n", "jit"});
+        for (auto value: values) {
+            bench->Args({value, 0});
+            if (jvm::Jit::supported()) bench->Args({value, 1});
+        }
+    }
+}
+
+BENCHMARK(BM_Opcode_nop)->Apply(modes);
+BENCHMARK(BM_Opcode_iload_istore)->Apply(modes);
+BENCHMARK(BM_Opcode_iadd)->Apply(modes);
+BENCHMARK(BM_Opcode_imul)->Apply(modes);
+BENCHMARK(BM_Opcode_idiv)->Apply(modes);
+BENCHMARK(BM_Opcode_iinc)->Apply(modes);
+BENCHMARK(BM_Opcode_dadd)->Apply(modes);
+BENCHMARK(BM_Opcode_i2d)->Apply(modes);
+BENCHMARK(BM_Opcode_goto)->Apply(modes);
+BENCHMARK(BM_Invokestatic)->Apply(modes);
+BENCHMARK(BM_HostCall)->Apply(modes);
+BENCHMARK(BM_HostCall_invokeStatic)->Apply(modes);
+BENCHMARK(BM_HostCall_invokeBatch)->ArgNames({"n", "threads"})->Args({1024, 1})->Args({1024, 4})->Args({1 << 20, 1})->Args({1 << 20, 4});
+BENCHMARK(BM_World)->Apply(modes);
+BENCHMARK(BM_PrimeCalculator)->Apply([](auto *bench) { sizes(bench, {50, 500, 2000}); });
+BENCHMARK(BM_PrimeCalculator_profiler)->ArgNames({"n", "profile"})->Args({2000, 0})->Args({2000, 1});
+BENCHMARK(BM_PiCalculator)->Apply([](auto *bench) { sizes(bench, {1000, 100000, 1000000}); });
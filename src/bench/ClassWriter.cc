@@ -0,0 +1,157 @@
+#include "ClassWriter.h"
+
+#include <cstring>
+#include <stdexcept>
+
+namespace {
+    void put1(std::vector<uint8_t> &out, uint8_t value) {
+        out.push_back(value);
+    }
+
+    void put2(std::vector<uint8_t> &out, uint16_t value) {
+        out.push_back(static_cast<uint8_t>(value >> 8));
+        out.push_back(static_cast<uint8_t>(value));
+    }
+
+    void put4(std::vector<uint8_t> &out, uint32_t value) {
+        put2(out, static_cast<uint16_t>(value >> 16));
+        put2(out, static_cast<uint16_t>(value));
+    }
+}
+
+bench::CodeBuilder &bench::CodeBuilder::op(uint8_t opcode) {
+    code.push_back(opcode);
+    return *this;
+}
+
+bench::CodeBuilder &bench::CodeBuilder::u1(uint8_t value) {
+    put1(code, value);
+    return *this;
+}
+
+bench::CodeBuilder &bench::CodeBuilder::u2(uint16_t value) {
+    put2(code, value);
+    return *this;
+}
+
+size_t bench::CodeBuilder::label() {
+    labels.push_back(-1);
+    return labels.size() - 1;
+}
+
+bench::CodeBuilder &bench::CodeBuilder::bind(size_t label) {
+    labels[label] = static_cast<int64_t>(code.size());
+    return *this;
+}
+
+bench::CodeBuilder &bench::CodeBuilder::branch(uint8_t opcode, size_t label) {
+    fixups.emplace_back(code.size(), label);
+    code.push_back(opcode);
+    put2(code, 0);
+    return *this;
+}
+
+std::vector<uint8_t> bench::CodeBuilder::build() const {
+    auto result = code;
+    for (auto &&[position, label]: fixups) {
+        if (labels[label] < 0) throw std::logic_error("unbound label");
+        auto offset = static_cast<uint16_t>(labels[label] - static_cast<int64_t>(position));
+        result[position + 1] = static_cast<uint8_t>(offset >> 8);
+        result[position + 2] = static_cast<uint8_t>(offset);
+    }
+    return result;
+}
+
+bench::ClassWriter::ClassWriter(std::string name) : name(std::move(name)) {
+}
+
+uint16_t bench::ClassWriter::add(const std::string &key, std::vector<uint8_t> entry, uint16_t slots) {
+    auto iter = indexes.find(key);
+    if (iter != indexes.end()) return iter->second;
+    auto index = pool_count;
+    pool.insert(pool.end(), entry.begin(), entry.end());
+    pool_count += slots;
+    indexes[key] = index;
+    return index;
+}
+
+uint16_t bench::ClassWriter::utf8(std::string_view value) {
+    std::vector<uint8_t> entry{1};
+    put2(entry, static_cast<uint16_t>(value.size()));
+    entry.insert(entry.end(), value.begin(), value.end());
+    return add("U" + std::string(value), std::move(entry));
+}
+
+uint16_t bench::ClassWriter::classRef(std::string_view class_name) {
+    std::vector<uint8_t> entry{7};
+    put2(entry, utf8(class_name));
+    return add("C" + std::string(class_name), std::move(entry));
+}
+
+uint16_t bench::ClassWriter::methodRef(std::string_view class_name, std::string_view method_name,
+                                       std::string_view descriptor) {
+    std::vector<uint8_t> name_and_type{12};
+    put2(name_and_type, utf8(method_name));
+    put2(name_and_type, utf8(descriptor));
+    auto nat = add("N" + std::string(method_name) + std::string(descriptor), std::move(name_and_type));
+    std::vector<uint8_t> entry{10};
+    put2(entry, classRef(class_name));
+    put2(entry, nat);
+    return add("M" + std::string(class_name) + "." + std::string(method_name) + std::string(descriptor),
+               std::move(entry));
+}
+
+uint16_t bench::ClassWriter::integer(int32_t value) {
+    std::vector<uint8_t> entry{3};
+    put4(entry, static_cast<uint32_t>(value));
+    return add("I" + std::to_string(value), std::move(entry));
+}
+
+uint16_t bench::ClassWriter::double_(double value) {
+    uint64_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    std::vector<uint8_t> entry{6};
+    put4(entry, static_cast<uint32_t>(bits >> 32));
+    put4(entry, static_cast<uint32_t>(bits));
+    return add("D" + std::to_string(bits), std::move(entry), 2);
+}
+
+void bench::ClassWriter::method(std::string_view method_name, std::string_view descriptor, uint16_t max_stack,
+                                uint16_t max_locals, const std::vector<uint8_t> &code) {
+    put2(methods, 0x0009);
+    put2(methods, utf8(method_name));
+    put2(methods, utf8(descriptor));
+    put2(methods, 1);
+    put2(methods, utf8("Code"));
+    put4(methods, static_cast<uint32_t>(12 + code.size()));
+    put2(methods, max_stack);
+    put2(methods, max_locals);
+    put4(methods, static_cast<uint32_t>(code.size()));
+    methods.insert(methods.end(), code.begin(), code.end());
+    put2(methods, 0);
+    put2(methods, 0);
+    ++method_count;
+}
+
+std::vector<uint8_t> bench::ClassWriter::bytes() const {
+    // 类名与父类需要在输出常量池之前加入
+    auto self = const_cast<ClassWriter *>(this);
+    auto this_class = self->classRef(name);
+    auto super_class = self->classRef("java/lang/Object");
+
+    std::vector<uint8_t> out;
+    put4(out, 0xCAFEBABE);
+    put2(out, 0);
+    put2(out, 52);
+    put2(out, pool_count);
+    out.insert(out.end(), pool.begin(), pool.end());
+    put2(out, 0x0021);
+    put2(out, this_class);
+    put2(out, super_class);
+    put2(out, 0);
+    put2(out, 0);
+    put2(out, method_count);
+    out.insert(out.end(), methods.begin(), methods.end());
+    put2(out, 0);
+    return out;
+}
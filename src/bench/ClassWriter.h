@@ -0,0 +1,69 @@
+#pragma once
+
+#include <cstdint>
+#include <map>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace bench {
+    /// 字节码构造器，支持前向跳转标签
+    class CodeBuilder {
+    public:
+        CodeBuilder &op(uint8_t opcode);
+
+        CodeBuilder &u1(uint8_t value);
+
+        CodeBuilder &u2(uint16_t value);
+
+        /// 创建尚未绑定位置的标签
+        size_t label();
+
+        /// 将标签绑定到当前位置
+        CodeBuilder &bind(size_t label);
+
+        /// 带 16 位偏移的跳转指令
+        CodeBuilder &branch(uint8_t opcode, size_t label);
+
+        /// 回填所有跳转偏移并返回字节码
+        [[nodiscard]] std::vector<uint8_t> build() const;
+
+    private:
+        std::vector<uint8_t> code;
+        std::vector<int64_t> labels;
+        /// 跳转指令位置与目标标签
+        std::vector<std::pair<size_t, size_t> > fixups;
+    };
+
+    /// 生成仅包含静态方法的类文件，用于基准测试中构造合成类
+    class ClassWriter {
+    public:
+        explicit ClassWriter(std::string name);
+
+        uint16_t utf8(std::string_view value);
+
+        uint16_t classRef(std::string_view name);
+
+        uint16_t methodRef(std::string_view class_name, std::string_view name, std::string_view descriptor);
+
+        uint16_t integer(int32_t value);
+
+        uint16_t double_(double value);
+
+        /// 添加 public static 方法
+        void method(std::string_view name, std::string_view descriptor, uint16_t max_stack, uint16_t max_locals,
+                    const std::vector<uint8_t> &code);
+
+        [[nodiscard]] std::vector<uint8_t> bytes() const;
+
+    private:
+        uint16_t add(const std::string &key, std::vector<uint8_t> entry, uint16_t slots = 1);
+
+        std::string name;
+        std::vector<uint8_t> pool;
+        uint16_t pool_count{1};
+        std::map<std::string, uint16_t> indexes;
+        std::vector<uint8_t> methods;
+        uint16_t method_count{};
+    };
+}
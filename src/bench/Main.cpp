@@ -0,0 +1,24 @@
+#include <benchmark/benchmark.h>
+#include <sese/Init.h>
+
+#include <cstring>
+#include <vector>
+
+int main(int argc, char **argv) {
+    sese::initCore(argc, argv);
+    // 默认以 JSON 输出便于不同版本之间对比，可通过 --benchmark_format 覆盖
+    std::vector<char *> args(argv, argv + argc);
+    auto has_format = false;
+    for (auto &&arg: args) {
+        if (std::strncmp(arg, "--benchmark_format", 18) == 0) has_format = true;
+    }
+    static char json_format[] = "--benchmark_format=json";
+    if (!has_format) args.push_back(json_format);
+    auto count = static_cast<int>(args.size());
+    args.push_back(nullptr);
+    benchmark::Initialize(&count, args.data());
+    if (benchmark::ReportUnrecognizedArguments(count, args.data())) return 1;
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+    return 0;
+}
@@ -11,6 +11,9 @@ namespace jvm {
         final_ = 0x0010,
         volatile_ = 0x0040,
         transient = 0x0080,
+        native_ = 0x0100,
+        interface_ = 0x0200,
+        abstract_ = 0x0400,
         synthetic = 0x1000,
         enum_ = 0x40000,
         module_ = 0x8000,
@@ -45,6 +48,18 @@ namespace jvm {
             return transient & access_flags;
         }
 
+        [[nodiscard]] bool isNative() const {
+            return native_ & access_flags;
+        }
+
+        [[nodiscard]] bool isInterface() const {
+            return interface_ & access_flags;
+        }
+
+        [[nodiscard]] bool isAbstract() const {
+            return abstract_ & access_flags;
+        }
+
         [[nodiscard]] bool isSynthetic() const {
             return synthetic & access_flags;
         }
@@ -8,8 +8,9 @@ inline void printLine() {
     SESE_INFO("================================");
 }
 
-jvm::Class::Class(sese::io::InputStream *input_stream) {
-    parse(input_stream);
+jvm::Class::Class(std::shared_ptr<const ClassBuffer> buffer) : buffer(std::move(buffer)) {
+    ByteReader reader(this->buffer->data(), this->buffer->size());
+    parse(reader);
 }
 
 void jvm::Class::printFields() const {
@@ -29,7 +30,7 @@ void jvm::Class::printFields() const {
         }
         builder.append(field.type.toString());
         builder.append(' ');
-        builder.append(field.name);
+        builder.append(std::string(field.name));
         SESE_INFO("%s", builder.toString().c_str());
         builder.clear();
         printAttributes(field.attribute_infos);
@@ -41,7 +42,7 @@ void jvm::Class::printMethods() const {
     SESE_INFO("%s's Method:", getThisName().c_str());
     sese::text::StringBuilder builder;
     for (auto &&[_,method]: method_infos) {
-        auto name = method.name == "<init>" ? getThisName() : method.name;
+        auto name = method.name == "<init>" ? getThisName() : std::string(method.name);
         if (method.isPublic()) {
             builder.append("public ");
         } else if (method.isPrivate()) {
@@ -86,11 +87,11 @@ void jvm::Class::printMethods() const {
 void jvm::Class::printAttributes() const {
     printLine();
     SESE_INFO("%s's Attributes:", getThisName().c_str());
-    SESE_INFO("SourceFile %s", source_file.c_str());
+    SESE_INFO("SourceFile %.*s", static_cast<int>(source_file.size()), source_file.data());
 }
 
 void jvm::Class::printAttributes(const std::vector<AttributeInfo> &attribute_infos) {
     for (auto &&attr: attribute_infos) {
-        SESE_INFO("unparsed %s", attr.name.c_str());
+        SESE_INFO("unparsed %.*s", static_cast<int>(attr.name.size()), attr.name.data());
     }
 }
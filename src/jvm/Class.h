@@ -2,10 +2,14 @@
 
 #include <map>
 #include <jvm/AccessFlags.h>
+#include <jvm/ClassBuffer.h>
+#include <jvm/Instruction.h>
+#include <jvm/Slot.h>
 #include <jvm/Type.h>
 
-#include <sese/io/InputStream.h>
-
+#include <atomic>
+#include <string_view>
+#include <thread>
 #include <vector>
 
 namespace jvm {
@@ -34,151 +38,44 @@ namespace jvm {
             package_info = 20
         };
 
+        /// 紧凑的常量池项，所有项连续存放，Utf8 内容直接引用类文件缓冲区
         struct ConstantInfo {
-            virtual ~ConstantInfo() = default;
-
             uint8_t tag{};
+            /// Class/String/MethodType/Module/Package 的名称下标，
+            /// FieldRef/MethodRef/InterfaceMethodRef 的 class_info 下标，
+            /// NameAndType 的 name 下标，MethodHandle 的 reference_kind，
+            /// InvokeDynamic 的 bootstrap_method_attr 下标
+            uint16_t index1{};
+            /// FieldRef/MethodRef/InterfaceMethodRef/InvokeDynamic 的 name_and_type 下标，
+            /// NameAndType 的 descriptor 下标，MethodHandle 的 reference_index
+            uint16_t index2{};
+
+            union {
+                int32_t i;
+                float f;
+                int64_t l;
+                double d;
+
+                /// Utf8 内容在类文件缓冲区中的位置
+                struct {
+                    uint32_t offset;
+                    uint32_t length;
+                } utf8;
+            } value{};
         };
 
-        struct ConstantInfo_Utf8 final : ConstantInfo {
-            ConstantInfo_Utf8() {
-                tag = utf8_info;
-            }
-
-            std::string bytes;
-        };
-
-        struct ConstantInfo_Integer final : ConstantInfo {
-            ConstantInfo_Integer() {
-                tag = integer_info;
-            }
-
-            int32_t bytes{};
-        };
-
-        struct ConstantInfo_Float final : ConstantInfo {
-            ConstantInfo_Float() {
-                tag = float_info;
-            }
-
-            float bytes{};
-        };
-
-        struct ConstantInfo_Long final : ConstantInfo {
-            ConstantInfo_Long() {
-                tag = long_info;
-            }
-
-            int64_t bytes{};
-        };
-
-        struct ConstantInfo_Double final : ConstantInfo {
-            ConstantInfo_Double() {
-                tag = double_info;
-            }
-
-            double bytes{};
-        };
-
-        struct ConstantInfo_Class final : ConstantInfo {
-            ConstantInfo_Class() {
-                tag = class_info;
-            }
-
-            uint16_t index{};
-        };
-
-        struct ConstantInfo_String final : ConstantInfo {
-            ConstantInfo_String() {
-                tag = string_info;
-            }
-
-            uint16_t index{};
-        };
-
-        struct ConstantInfo_FieldRef final : ConstantInfo {
-            ConstantInfo_FieldRef() {
-                tag = field_ref_info;
-            }
-
-            uint16_t class_info_index{};
-            uint16_t name_and_type_index{};
-        };
-
-        struct ConstantInfo_MethodRef final : ConstantInfo {
-            ConstantInfo_MethodRef() {
-                tag = method_ref_info;
-            }
-
-            uint16_t class_info_index{};
-            uint16_t name_and_type_index{};
-        };
-
-        struct ConstantInfo_InterfaceMethodRef final : ConstantInfo {
-            ConstantInfo_InterfaceMethodRef() {
-                tag = interface_method_ref_info;
-            }
-
-            uint16_t class_info_index{};
-            uint16_t name_and_type_index{};
-        };
-
-        struct ConstantInfo_NameAndType final : ConstantInfo {
-            ConstantInfo_NameAndType() {
-                tag = name_and_type_info;
-            }
-
-            uint16_t name_index{};
-            uint16_t descriptor_index{};
-        };
-
-        struct ConstantInfo_MethodHandle final : ConstantInfo {
-            ConstantInfo_MethodHandle() {
-                tag = method_handle_info;
-            }
-
-            uint8_t reference_kind{};
-            uint16_t reference_index{};
-        };
-
-        struct ConstantInfo_MethodType final : ConstantInfo {
-            ConstantInfo_MethodType() {
-                tag = method_type_info;
-            }
-
-            uint16_t descriptor_index{};
-        };
-
-        struct ConstantInfo_InvokeDynamic final : ConstantInfo {
-            ConstantInfo_InvokeDynamic() {
-                tag = invoke_dynamic_info;
-            }
-
-            uint16_t bootstrap_method_attr_index{};
-            uint16_t name_and_type_index{};
-        };
-
-        struct ConstantInfo_Module final : ConstantInfo {
-            ConstantInfo_Module() {
-                tag = module_info;
-            }
-
-            uint16_t name_index{};
-        };
-
-        struct ConstantInfo_Package final : ConstantInfo {
-            ConstantInfo_Package() {
-                tag = package_info;
-            }
-
-            uint16_t name_index{};
+        /// 字段、方法以及接口方法引用
+        struct MemberRef {
+            std::string_view class_name;
+            std::string_view name;
+            std::string_view descriptor;
         };
 
         struct AttributeInfo {
             // uint16_t name_index{};
-            std::string name{};
+            std::string_view name{};
             // uint32_t length{};
-            std::vector<uint8_t> info{};
+            std::string_view info{};
         };
 
         struct ExceptionInfo {
@@ -188,47 +85,175 @@ namespace jvm {
             uint16_t type{};
         };
 
+        /// 预解码后的异常处理器，范围与入口均为指令下标
+        struct HandlerInfo {
+            /// 受保护的指令范围 [from, to)
+            int32_t from{};
+            int32_t to{};
+            int32_t target{};
+            /// 捕获类型的常量池下标，为 0 时捕获所有异常
+            uint16_t catch_type{};
+            /// 捕获类型解析得到的类，首次匹配时查找，类尚未注册时保持为空
+            Class *catch_class{};
+        };
+
         struct LineNumberInfo {
             uint16_t start_pc;
             uint16_t line_number;
         };
 
+        struct MethodInfo;
+
+        /// 虚方法表与接口方法表的表项，即选择得到的实现方法及其所在的类
+        struct VirtualEntry {
+            Class *class_{};
+            MethodInfo *method{};
+        };
+
+        /// invokevirtual/invokeinterface 调用点的内联缓存，按照出现顺序记录接收者的类与选择得到的实现方法
+        /// @note 表项只追加不修改，先写入表项再发布 size，查找时无需加锁
+        struct InlineCache {
+            /// 最多记录的接收者类型数量，超过后调用点成为超多态
+            static constexpr uint32_t capacity = 4;
+
+            /// 查找接收者的类对应的实现方法，未记录时返回 nullptr
+            [[nodiscard]] const VirtualEntry *find(const Class *receiver) const {
+                auto count = size.load(std::memory_order_acquire);
+                for (uint32_t i = 0; i < count; ++i) {
+                    if (receivers[i] == receiver) return &targets[i];
+                }
+                return nullptr;
+            }
+
+            const Class *receivers[capacity]{};
+            VirtualEntry targets[capacity]{};
+            /// 已记录的接收者类型数量，为 1 时调用点为单态，大于 1 时为多态
+            std::atomic<uint32_t> size{};
+            /// 出现过超过 capacity 种接收者类型，之后未命中时直接查表而不再记录
+            std::atomic<bool> megamorphic{};
+        };
+
         struct CodeInfo {
             uint16_t max_stack;
             uint16_t max_locals;
-            std::vector<uint8_t> code;
+            std::string_view code;
             std::vector<ExceptionInfo> exception_infos;
             std::vector<LineNumberInfo> line_infos;
             std::vector<AttributeInfo> attribute_infos;
+            /// 链接阶段由 code 预解码得到的指令流
+            std::vector<Instruction> instructions;
+            /// tableswitch 与 lookupswitch 的跳转表，指令的 c 为其在此处的起始下标
+            std::vector<int32_t> switch_tables;
+            /// 链接阶段由 exception_infos 转换得到的异常处理器，保持异常表中的顺序
+            std::vector<HandlerInfo> handlers;
+            /// invokevirtual 与 invokeinterface 的内联缓存，指令的 c 为其在此处的下标
+            std::vector<InlineCache> inline_caches;
+            /// 链接阶段类型推导的结果，与 instructions 按下标对应
+            TypeMap type_map;
+            /// JIT 编译后的入口，参数为局部变量表与开始执行的指令下标，
+            /// 返回值低 16 位为接下来需要解释执行的指令下标，高 16 位为此时的操作数栈深度
+            using NativeCode = uint32_t (*)(Slot *locals, uint32_t entry);
+            /// 未编译时为空
+            NativeCode native{};
         };
 
         struct FieldInfo : AccessFlags {
             // uint16_t name_index{};
-            std::string name{};
+            std::string_view name{};
             // uint16_t descriptor_index{};
-            // std::string descriptor{};
+            std::string_view descriptor{};
             TypeInfo type;
+            /// 实例字段相对于对象起始位置的偏移，由 Runtime 在计算实例布局时填充；
+            /// 静态字段为其在类的静态存储中的下标，链接时填充
+            uint32_t offset{};
             // uint16_t attributes_count{};
             std::vector<AttributeInfo> attribute_infos{};
         };
 
         struct MethodInfo : AccessFlags {
-            std::string name{};
-            std::string descriptor{};
+            std::string_view name{};
+            std::string_view descriptor{};
             TypeInfo return_type;
             std::vector<TypeInfo> args_type;
+            /// 参数所占用的 Slot 数量，long 与 double 各占两个
+            uint16_t args_slots{};
+            /// 在所属类虚方法表中的下标，计算布局时填充；静态方法、私有方法与构造方法为 -1
+            int32_t table_index{-1};
             std::vector<AttributeInfo> attribute_infos{};
             std::unique_ptr<CodeInfo> code_info;
             std::vector<ExceptionInfo> exception_infos;
         };
 
-        explicit Class(sese::io::InputStream *input_stream);
+        /// 运行时解析后的常量池项，由 Runtime 在首次执行引用该项的指令时填充
+        /// @note 其余成员写入完成后才设置 resolved，之后不再修改，读取 resolved 为 true 后即可直接使用
+        struct ResolvedEntry {
+            std::atomic<bool> resolved{};
+            /// 方法引用所在的类，或者 new 指令创建的类
+            Class *class_{};
+            /// 方法引用解析得到的方法
+            MethodInfo *method{};
+            /// ldc 系列指令加载的常量值
+            Slot value{};
+            /// 字段引用解析得到的实例字段偏移
+            uint32_t offset{};
+            /// 静态字段引用解析得到的字段地址，对应的 class_ 为声明该字段的类
+            uint8_t *address{};
+        };
+
+        /// 类的初始化状态，类在首次主动使用时执行 <clinit>
+        enum InitState : uint8_t {
+            uninitialized,
+            /// 正在执行 <clinit>，期间执行初始化的线程对该类的访问不再触发初始化，其他线程等待初始化结束
+            initializing,
+            initialized,
+            /// <clinit> 抛出了异常，之后的初始化请求均失败
+            erroneous
+        };
+
+        /// 直接从缓冲区解析类文件，Class 持有缓冲区的生命周期
+        /// @exception sese::Exception 类文件格式错误
+        explicit Class(std::shared_ptr<const ClassBuffer> buffer);
 
         [[nodiscard]] std::string getThisName() const;
 
         [[nodiscard]] std::string getSuperName() const;
 
-        [[nodiscard]] const std::string &getSourceName() const { return source_file; }
+        [[nodiscard]] std::string_view getSourceName() const { return source_file; }
+
+        /// 实例对象的大小，包括对象头，尚未计算布局时为 0
+        [[nodiscard]] uint32_t getInstanceSize() const { return instance_size; }
+
+        /// 是否已经执行完 <clinit>
+        [[nodiscard]] bool isInitialized() const { return init_state == initialized; }
+
+        /// 实例中所有引用字段的偏移，包括继承自父类的字段，供垃圾收集器遍历
+        [[nodiscard]] const std::vector<uint32_t> &getReferenceOffsets() const { return reference_offsets; }
+
+        /// 获取常量池项
+        /// @param index 常量池下标
+        /// @param tag 期望的常量类型
+        /// @exception sese::Exception 下标越界或者类型不匹配
+        [[nodiscard]] const ConstantInfo &getConstant(uint16_t index, Constant tag) const;
+
+        /// 按照名称与描述符查找方法，例如 "main([Ljava/lang/String;)V"
+        /// @return 不存在时返回 nullptr
+        [[nodiscard]] const MethodInfo *getMethod(const std::string &name_and_descriptor) const;
+
+        /// 获取任意类型的常量池项
+        /// @param index 常量池下标
+        /// @exception sese::Exception 下标越界
+        [[nodiscard]] const ConstantInfo &getConstant(uint16_t index) const;
+
+        /// @exception sese::Exception 下标越界或者类型不匹配
+        [[nodiscard]] std::string_view getUtf8(uint16_t index) const;
+
+        /// 获取 Class 常量所指向的类名
+        /// @exception sese::Exception 下标越界或者类型不匹配
+        [[nodiscard]] std::string_view getClassName(uint16_t index) const;
+
+        /// 获取 FieldRef/MethodRef/InterfaceMethodRef 常量所指向的成员
+        /// @exception sese::Exception 下标越界或者类型不匹配
+        [[nodiscard]] MemberRef getMemberRef(uint16_t index) const;
 
         void printFields() const;
 
@@ -239,28 +264,28 @@ namespace jvm {
         static void printAttributes(const std::vector<AttributeInfo> &attribute_infos);
 
     private:
-        void parse(sese::io::InputStream *input_stream);
+        void parse(ByteReader &reader);
 
-        void parseMagicNumber(sese::io::InputStream *input_stream);
+        void parseMagicNumber(ByteReader &reader);
 
-        void parseVersion(sese::io::InputStream *input_stream);
+        void parseVersion(ByteReader &reader);
 
-        void parseConstantPool(sese::io::InputStream *input_stream);
+        void parseConstantPool(ByteReader &reader);
 
-        void parseClass(sese::io::InputStream *input_stream);
+        void parseClass(ByteReader &reader);
 
-        void parseFields(sese::io::InputStream *input_stream);
+        void parseFields(ByteReader &reader);
 
-        void parseMethods(sese::io::InputStream *input_stream);
+        void parseMethods(ByteReader &reader);
 
-        void parseAttributes(sese::io::InputStream *input_stream);
+        void parseAttributes(ByteReader &reader);
 
-        void parseAttributeCode(sese::io::InputStream *input_stream, CodeInfo *code_info) const;
+        void parseAttributeCode(ByteReader &reader, CodeInfo *code_info) const;
 
+        std::shared_ptr<const ClassBuffer> buffer;
         uint32_t magic{};
         uint16_t minor{}, major{};
-        std::vector<std::unique_ptr<ConstantInfo> > constant_infos;
-        uint16_t access_flags{};
+        std::vector<ConstantInfo> constant_infos;
         uint16_t this_class{};
         uint16_t super_class{};
         std::vector<uint16_t> interfaces{};
@@ -268,6 +293,29 @@ namespace jvm {
         std::map<std::string, MethodInfo> method_infos{};
         std::vector<AttributeInfo> attribute_infos{};
         std::vector<ExceptionInfo> exception_infos{};
-        std::string source_file{};
+        std::string_view source_file{};
+        /// 与 constant_infos 一一对应的解析缓存，链接时分配
+        std::unique_ptr<ResolvedEntry[]> resolved_entries{};
+        /// 父类，计算布局时填充，父类为 java/lang/Object 时为空
+        Class *super{};
+        /// 直接实现的接口，接口则为其直接继承的父接口，计算布局时由 interfaces 解析得到，未注册的接口被忽略
+        std::vector<Class *> super_interfaces{};
+        /// 虚方法表，父类的表项位于前部，重写的方法沿用被重写方法的下标，计算布局时构建；
+        /// 接口的虚方法表依次为其声明的实例方法
+        std::vector<VirtualEntry> vtable{};
+        /// 实现的每个接口，包括父类与父接口实现的接口，对应的接口方法表，表项与接口的虚方法表一一对应
+        std::vector<std::pair<Class *, std::vector<VirtualEntry> > > itables{};
+        /// 实例字段的结束位置，包括对象头，子类的字段从此处开始排列，尚未计算布局时为 0
+        uint32_t fields_end{};
+        /// 按 8 字节对齐后的实例对象大小
+        uint32_t instance_size{};
+        std::vector<uint32_t> reference_offsets{};
+        /// 静态字段存储，每个静态字段占用一个 Slot，链接时分配，地址在类的生命周期内保持不变
+        std::unique_ptr<Slot[]> statics{};
+        /// 存放引用的静态字段下标，供垃圾收集器作为根集合枚举
+        std::vector<uint32_t> static_references{};
+        std::atomic<InitState> init_state{uninitialized};
+        /// 正在执行 <clinit> 的线程
+        std::thread::id init_thread{};
     };
 }
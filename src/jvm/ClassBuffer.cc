@@ -0,0 +1,86 @@
+#include "ClassBuffer.h"
+
+#include <sese/util/Exception.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#ifdef _WIN32
+
+jvm::MappedClassBuffer::MappedClassBuffer(const std::string &path) {
+    file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL,
+                       nullptr);
+    if (file == INVALID_HANDLE_VALUE) throw sese::Exception("failed open class file");
+    LARGE_INTEGER file_size;
+    if (!GetFileSizeEx(file, &file_size) || file_size.QuadPart == 0) {
+        CloseHandle(file);
+        throw sese::Exception("failed to map class file");
+    }
+    mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (mapping == nullptr) {
+        CloseHandle(file);
+        throw sese::Exception("failed to map class file");
+    }
+    auto view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    if (view == nullptr) {
+        CloseHandle(mapping);
+        CloseHandle(file);
+        throw sese::Exception("failed to map class file");
+    }
+    begin = static_cast<const uint8_t *>(view);
+    length = static_cast<size_t>(file_size.QuadPart);
+}
+
+jvm::MappedClassBuffer::~MappedClassBuffer() {
+    UnmapViewOfFile(begin);
+    CloseHandle(mapping);
+    CloseHandle(file);
+}
+
+#else
+
+jvm::MappedClassBuffer::MappedClassBuffer(const std::string &path) {
+    auto fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) throw sese::Exception("failed open class file");
+    struct stat status{};
+    if (fstat(fd, &status) != 0 || status.st_size == 0) {
+        close(fd);
+        throw sese::Exception("failed to map class file");
+    }
+    auto size = static_cast<size_t>(status.st_size);
+    auto view = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    // 映射建立后文件描述符即可关闭
+    close(fd);
+    if (view == MAP_FAILED) throw sese::Exception("failed to map class file");
+    begin = static_cast<const uint8_t *>(view);
+    length = size;
+}
+
+jvm::MappedClassBuffer::~MappedClassBuffer() {
+    munmap(const_cast<uint8_t *>(begin), length);
+}
+
+#endif
+
+jvm::OwnedClassBuffer::OwnedClassBuffer(std::vector<uint8_t> bytes) : storage(std::move(bytes)) {
+    begin = storage.data();
+    length = storage.size();
+}
+
+jvm::BorrowedClassBuffer::BorrowedClassBuffer(const void *data, size_t size) {
+    begin = static_cast<const uint8_t *>(data);
+    length = size;
+}
+
+const uint8_t *jvm::ByteReader::take(size_t length) {
+    if (length > remaining()) throw sese::Exception("truncated class file");
+    auto result = pos;
+    pos += length;
+    return result;
+}
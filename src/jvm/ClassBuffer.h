@@ -0,0 +1,106 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace jvm {
+    /// 类文件内容的只读缓冲区
+    /// @note Class 中的名称、描述符、字节码与属性均以视图形式指向该缓冲区，
+    /// 因此缓冲区需要与 Class 拥有相同的生命周期
+    class ClassBuffer {
+    public:
+        virtual ~ClassBuffer() = default;
+
+        [[nodiscard]] const uint8_t *data() const { return begin; }
+
+        [[nodiscard]] size_t size() const { return length; }
+
+    protected:
+        const uint8_t *begin{};
+        size_t length{};
+    };
+
+    /// 以只读方式映射整个文件
+    class MappedClassBuffer final : public ClassBuffer {
+    public:
+        /// @param path 文件路径
+        /// @exception sese::Exception 文件无法打开或者映射
+        explicit MappedClassBuffer(const std::string &path);
+
+        ~MappedClassBuffer() override;
+
+        MappedClassBuffer(const MappedClassBuffer &) = delete;
+
+        MappedClassBuffer &operator=(const MappedClassBuffer &) = delete;
+
+    private:
+#ifdef _WIN32
+        void *file{};
+        void *mapping{};
+#endif
+    };
+
+    /// 持有字节内容的缓冲区，用于无法映射的输入流
+    class OwnedClassBuffer final : public ClassBuffer {
+    public:
+        explicit OwnedClassBuffer(std::vector<uint8_t> bytes);
+
+    private:
+        std::vector<uint8_t> storage;
+    };
+
+    /// 直接引用调用者内存的缓冲区，不持有内存的生命周期
+    class BorrowedClassBuffer final : public ClassBuffer {
+    public:
+        BorrowedClassBuffer(const void *data, size_t size);
+    };
+
+    /// 带边界检查的大端字节读取游标
+    class ByteReader {
+    public:
+        ByteReader(const uint8_t *begin, size_t length) : pos(begin), end(begin + length) {}
+
+        /// @exception sese::Exception 剩余字节不足
+        uint8_t u1() {
+            return *take(1);
+        }
+
+        /// @exception sese::Exception 剩余字节不足
+        uint16_t u2() {
+            auto p = take(2);
+            return static_cast<uint16_t>(p[0] << 8 | p[1]);
+        }
+
+        /// @exception sese::Exception 剩余字节不足
+        uint32_t u4() {
+            auto p = take(4);
+            return static_cast<uint32_t>(p[0]) << 24 | static_cast<uint32_t>(p[1]) << 16 |
+                   static_cast<uint32_t>(p[2]) << 8 | p[3];
+        }
+
+        /// @exception sese::Exception 剩余字节不足
+        uint64_t u8() {
+            auto high = static_cast<uint64_t>(u4());
+            return high << 32 | u4();
+        }
+
+        /// 取出 length 个字节的视图，不发生拷贝
+        /// @exception sese::Exception 剩余字节不足
+        std::string_view bytes(size_t length) {
+            return {reinterpret_cast<const char *>(take(length)), length};
+        }
+
+        [[nodiscard]] const uint8_t *position() const { return pos; }
+
+        [[nodiscard]] size_t remaining() const { return static_cast<size_t>(end - pos); }
+
+    private:
+        const uint8_t *take(size_t length);
+
+        const uint8_t *pos;
+        const uint8_t *end;
+    };
+}
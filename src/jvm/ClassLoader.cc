@@ -1,14 +1,21 @@
 #include "ClassLoader.h"
 
-#include <sese/io/File.h>
 #include <sese/util/Exception.h>
 
 std::shared_ptr<jvm::Class> jvm::ClassLoader::loadFromFile(const std::string &path) {
-    auto file = sese::io::File::create(path, sese::io::File::B_READ);
-    if (!file) throw sese::Exception("failed open class file");
-    return std::make_shared<Class>(file.get());
+    return std::make_shared<Class>(std::make_shared<MappedClassBuffer>(path));
 }
 
 std::shared_ptr<jvm::Class> jvm::ClassLoader::loadFromStream(sese::io::InputStream *input_stream) {
-    return std::make_shared<Class>(input_stream);
+    std::vector<uint8_t> bytes;
+    uint8_t chunk[4096];
+    int64_t length;
+    while ((length = input_stream->read(chunk, sizeof(chunk))) > 0) {
+        bytes.insert(bytes.end(), chunk, chunk + length);
+    }
+    return std::make_shared<Class>(std::make_shared<OwnedClassBuffer>(std::move(bytes)));
+}
+
+std::shared_ptr<jvm::Class> jvm::ClassLoader::loadFromMemory(const void *data, size_t size) {
+    return std::make_shared<Class>(std::make_shared<BorrowedClassBuffer>(data, size));
 }
@@ -2,10 +2,12 @@
 
 #include <jvm/Class.h>
 
+#include <sese/io/InputStream.h>
+
 namespace jvm {
     class ClassLoader {
     public:
-        /// 尝试从文件种加载 class
+        /// 尝试从文件种加载 class，文件以只读方式映射到内存，解析过程不拷贝内容
         /// @param path class 文件路径
         /// @exception sese::Exception
         /// @return class 对象
@@ -16,5 +18,13 @@ namespace jvm {
         /// @exception sese::Exception
         /// @return class 对象
         static std::shared_ptr<Class> loadFromStream(sese::io::InputStream *input_stream);
+
+        /// 尝试从内存中加载 class
+        /// @param data class 文件内容
+        /// @param size 内容字节数
+        /// @exception sese::Exception
+        /// @return class 对象
+        /// @note 不会拷贝内容，调用者需要保证内存的生命周期长于 class 对象
+        static std::shared_ptr<Class> loadFromMemory(const void *data, size_t size);
     };
 }
\ No newline at end of file
@@ -4,17 +4,50 @@
 #include <sese/util/Exception.h>
 
 std::string jvm::Class::getThisName() const {
-    auto class_ptr = &constant_infos[this_class];
-    auto class_info = dynamic_cast<ConstantInfo_Class *>(class_ptr->get());
-    auto name_ptr = &constant_infos[class_info->index];
-    auto name_info = dynamic_cast<ConstantInfo_Utf8 *>(name_ptr->get());
-    return name_info->bytes;
+    return std::string(getClassName(this_class));
 }
 
 std::string jvm::Class::getSuperName() const {
-    auto class_ptr = &constant_infos[super_class];
-    auto class_info = dynamic_cast<ConstantInfo_Class *>(class_ptr->get());
-    auto name_ptr = &constant_infos[class_info->index];
-    auto name_info = dynamic_cast<ConstantInfo_Utf8 *>(name_ptr->get());
-    return name_info->bytes;
+    return std::string(getClassName(super_class));
+}
+
+const jvm::Class::MethodInfo *jvm::Class::getMethod(const std::string &name_and_descriptor) const {
+    auto iter = method_infos.find(name_and_descriptor);
+    return iter == method_infos.end() ? nullptr : &iter->second;
+}
+
+const jvm::Class::ConstantInfo &jvm::Class::getConstant(uint16_t index, Constant tag) const {
+    auto &&constant = getConstant(index);
+    if (constant.tag != tag) {
+        throw sese::Exception("unexpected constant pool tag");
+    }
+    return constant;
+}
+
+const jvm::Class::ConstantInfo &jvm::Class::getConstant(uint16_t index) const {
+    if (index == 0 || index >= constant_infos.size()) {
+        throw sese::Exception("constant pool index out of range");
+    }
+    return constant_infos[index];
+}
+
+std::string_view jvm::Class::getUtf8(uint16_t index) const {
+    auto &&utf8 = getConstant(index, utf8_info).value.utf8;
+    return {reinterpret_cast<const char *>(buffer->data()) + utf8.offset, utf8.length};
+}
+
+std::string_view jvm::Class::getClassName(uint16_t index) const {
+    return getUtf8(getConstant(index, class_info).index1);
+}
+
+jvm::Class::MemberRef jvm::Class::getMemberRef(uint16_t index) const {
+    if (index == 0 || index >= constant_infos.size()) {
+        throw sese::Exception("constant pool index out of range");
+    }
+    auto &&ref = constant_infos[index];
+    if (ref.tag != field_ref_info && ref.tag != method_ref_info && ref.tag != interface_method_ref_info) {
+        throw sese::Exception("unexpected constant pool tag");
+    }
+    auto &&name_and_type = getConstant(ref.index2, name_and_type_info);
+    return {getClassName(ref.index1), getUtf8(name_and_type.index1), getUtf8(name_and_type.index2)};
 }
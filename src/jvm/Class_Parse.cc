@@ -1,439 +1,241 @@
 #include "Class.h"
 
 #include <sese/Log.h>
-#include <sese/text/StringBuilder.h>
-#include <sese/util/Endian.h>
 #include <sese/util/Exception.h>
 
+#include <cstring>
+
 #undef SESE_DEBUG
 #define SESE_DEBUG(...)
 
-inline std::string getUtf8(const std::vector<std::unique_ptr<jvm::Class::ConstantInfo> > &constants, uint16_t index) {
-    auto string_ptr = &constants[index];
-    auto string_info = dynamic_cast<jvm::Class::ConstantInfo_Utf8 *>(string_ptr->get());
-    return string_info->bytes;
-}
-
-void jvm::Class::parse(sese::io::InputStream *input_stream) {
-    parseMagicNumber(input_stream);
-    parseVersion(input_stream);
-    parseConstantPool(input_stream);
-    parseClass(input_stream);
-    parseFields(input_stream);
-    parseMethods(input_stream);
-    parseAttributes(input_stream);
+void jvm::Class::parse(ByteReader &reader) {
+    parseMagicNumber(reader);
+    parseVersion(reader);
+    parseConstantPool(reader);
+    parseClass(reader);
+    parseFields(reader);
+    parseMethods(reader);
+    parseAttributes(reader);
 }
 
-#define IF_READ(m) if (sizeof(m) != input_stream->read(&m, sizeof(m)))
-#define ASSERT_READ(m) IF_READ(m) throw sese::Exception("failed to parse " #m);
-
-void jvm::Class::parseMagicNumber(sese::io::InputStream *input_stream) {
-    ASSERT_READ(magic)
-    magic = ToBigEndian32(magic);
+void jvm::Class::parseMagicNumber(ByteReader &reader) {
+    magic = reader.u4();
+    if (magic != 0xCAFEBABE) throw sese::Exception("failed to parse magic");
     SESE_DEBUG("magic number 0x%x", magic);
 }
 
-void jvm::Class::parseVersion(sese::io::InputStream *input_stream) {
-    ASSERT_READ(minor)
-    minor = FromBigEndian16(minor);
+void jvm::Class::parseVersion(ByteReader &reader) {
+    minor = reader.u2();
     SESE_DEBUG("minor version %d", minor);
-    ASSERT_READ(major)
-    major = FromBigEndian16(major);
+    major = reader.u2();
     SESE_DEBUG("major version %d", major);
 }
 
-void jvm::Class::parseConstantPool(sese::io::InputStream *input_stream) {
-    uint16_t constant_pool_count;
-    ASSERT_READ(constant_pool_count)
-    constant_pool_count = FromBigEndian16(constant_pool_count);
+void jvm::Class::parseConstantPool(ByteReader &reader) {
+    auto constant_pool_count = reader.u2();
     SESE_DEBUG("constant pool count %d", constant_pool_count);
     constant_infos.reserve(constant_pool_count);
 
-    constant_infos.emplace_back(std::make_unique<ConstantInfo>());
+    // 下标 0 以及 long/double 之后的下标不可用，以 tag 为 0 的空项占位
+    constant_infos.emplace_back();
     for (int i = 1; i < constant_pool_count; i++) {
-        int8_t tag;
-        ASSERT_READ(tag)
+        ConstantInfo item;
+        item.tag = reader.u1();
+        auto tag = item.tag;
         if (tag == utf8_info) {
-            int16_t length;
-            char bytes[UINT16_MAX]{};
-            ASSERT_READ(length)
-            length = FromBigEndian16(length);
-            if (length != input_stream->read(bytes, length)) {
-                throw sese::Exception("failed to parse bytes");
-            }
-            auto item = std::make_unique<ConstantInfo_Utf8>();
-            item->tag = tag;
-            item->bytes = std::string(bytes, length);
-            constant_infos.emplace_back(std::move(item));
-        } else if (tag == integer_info) {
-            int32_t bytes;
-            ASSERT_READ(bytes)
-            bytes = FromBigEndian32(bytes);
-            auto item = std::make_unique<ConstantInfo_Integer>();
-            item->bytes = bytes;
-            constant_infos.emplace_back(std::move(item));
-        } else if (tag == float_info) {
-            int32_t bytes;
-            ASSERT_READ(bytes)
-            bytes = FromBigEndian32(bytes);
-            auto item = std::make_unique<ConstantInfo_Float>();
-            memcpy(&item->bytes, &bytes, sizeof(bytes));
-            constant_infos.emplace_back(std::move(item));
-        } else if (tag == long_info) {
-            int64_t bytes;
-            ASSERT_READ(bytes)
-            bytes = FromBigEndian64(bytes);
-            auto item = std::make_unique<ConstantInfo_Long>();
-            item->bytes = bytes;
-            constant_infos.emplace_back(std::move(item));
-
-            constant_infos.emplace_back(std::make_unique<ConstantInfo>());
-            ++i;
-        } else if (tag == double_info) {
-            int64_t bytes;
-            ASSERT_READ(bytes)
-            bytes = FromBigEndian64(bytes);
-            auto item = std::make_unique<ConstantInfo_Double>();
-            memcpy(&item->bytes, &bytes, sizeof(bytes));
-            constant_infos.emplace_back(std::move(item));
-
-            constant_infos.emplace_back(std::make_unique<ConstantInfo>());
-            ++i;
-        } else if (tag == class_info) {
-            int16_t index;
-            ASSERT_READ(index)
-            index = FromBigEndian16(index);
-            auto item = std::make_unique<ConstantInfo_Class>();
-            item->index = index;
-            constant_infos.emplace_back(std::move(item));
-        } else if (tag == string_info) {
-            int16_t index;
-            ASSERT_READ(index)
-            index = FromBigEndian16(index);
-            auto item = std::make_unique<ConstantInfo_String>();
-            item->index = index;
-            constant_infos.emplace_back(std::move(item));
-        } else if (tag == field_ref_info) {
-            int16_t index1, index2;
-            ASSERT_READ(index1)
-            index1 = FromBigEndian16(index1);
-            ASSERT_READ(index2)
-            index2 = FromBigEndian16(index2);
-            auto item = std::make_unique<ConstantInfo_FieldRef>();
-            item->class_info_index = index1;
-            item->name_and_type_index = index2;
-            constant_infos.emplace_back(std::move(item));
-        } else if (tag == method_ref_info) {
-            int16_t index1, index2;
-            ASSERT_READ(index1)
-            index1 = FromBigEndian16(index1);
-            ASSERT_READ(index2)
-            index2 = FromBigEndian16(index2);
-            auto item = std::make_unique<ConstantInfo_MethodRef>();
-            item->class_info_index = index1;
-            item->name_and_type_index = index2;
-            constant_infos.emplace_back(std::move(item));
-        } else if (tag == interface_method_ref_info) {
-            int16_t index1, index2;
-            ASSERT_READ(index1)
-            index1 = FromBigEndian16(index1);
-            ASSERT_READ(index2)
-            index2 = FromBigEndian16(index2);
-            auto item = std::make_unique<ConstantInfo_InterfaceMethodRef>();
-            item->class_info_index = index1;
-            item->name_and_type_index = index2;
-            constant_infos.emplace_back(std::move(item));
-        } else if (tag == name_and_type_info) {
-            int16_t index1, index2;
-            ASSERT_READ(index1)
-            index1 = FromBigEndian16(index1);
-            ASSERT_READ(index2)
-            index2 = FromBigEndian16(index2);
-            auto item = std::make_unique<ConstantInfo_NameAndType>();
-            item->name_index = index1;
-            item->descriptor_index = index2;
-            constant_infos.emplace_back(std::move(item));
+            auto length = reader.u2();
+            auto bytes = reader.bytes(length);
+            item.value.utf8.offset = static_cast<uint32_t>(
+                reinterpret_cast<const uint8_t *>(bytes.data()) - buffer->data());
+            item.value.utf8.length = length;
+        } else if (tag == integer_info || tag == float_info) {
+            auto bytes = reader.u4();
+            memcpy(&item.value, &bytes, sizeof(bytes));
+        } else if (tag == long_info || tag == double_info) {
+            auto bytes = reader.u8();
+            memcpy(&item.value, &bytes, sizeof(bytes));
+        } else if (tag == class_info || tag == string_info || tag == method_type_info ||
+                   tag == module_info || tag == package_info) {
+            item.index1 = reader.u2();
+        } else if (tag == field_ref_info || tag == method_ref_info || tag == interface_method_ref_info ||
+                   tag == name_and_type_info || tag == invoke_dynamic_info) {
+            item.index1 = reader.u2();
+            item.index2 = reader.u2();
         } else if (tag == method_handle_info) {
-            int8_t kind;
-            int16_t index;
-            ASSERT_READ(kind)
-            ASSERT_READ(index)
-            index = FromBigEndian16(index);
-            auto item = std::make_unique<ConstantInfo_MethodHandle>();
-            item->reference_kind = kind;
-            item->reference_index = index;
-            constant_infos.emplace_back(std::move(item));
-        } else if (tag == method_type_info) {
-            int16_t index;
-            ASSERT_READ(index)
-            index = FromBigEndian16(index);
-            auto item = std::make_unique<ConstantInfo_MethodType>();
-            item->descriptor_index = index;
-            constant_infos.emplace_back(std::move(item));
-        } else if (tag == invoke_dynamic_info) {
-            int16_t index1, index2;
-            ASSERT_READ(index1)
-            index1 = FromBigEndian16(index1);
-            ASSERT_READ(index2)
-            index2 = FromBigEndian16(index2);
-            auto item = std::make_unique<ConstantInfo_InvokeDynamic>();
-            item->bootstrap_method_attr_index = index1;
-            item->name_and_type_index = index2;
-            constant_infos.emplace_back(std::move(item));
-        } else if (tag == module_info) {
-            int16_t index;
-            ASSERT_READ(index)
-            index = FromBigEndian16(index);
-            auto item = std::make_unique<ConstantInfo_Module>();
-            item->name_index = index;
-            constant_infos.emplace_back(std::move(item));
-        } else if (tag == package_info) {
-            int16_t index;
-            ASSERT_READ(index)
-            index = FromBigEndian16(index);
-            auto item = std::make_unique<ConstantInfo_Package>();
-            item->name_index = index;
-            constant_infos.emplace_back(std::move(item));
+            item.index1 = reader.u1();
+            item.index2 = reader.u2();
         } else {
             throw sese::Exception("unknown tag type");
         }
+        constant_infos.push_back(item);
+        if (tag == long_info || tag == double_info) {
+            constant_infos.emplace_back();
+            ++i;
+        }
     }
 }
 
-void jvm::Class::parseClass(sese::io::InputStream *input_stream) {
-    ASSERT_READ(access_flags)
-    access_flags = FromBigEndian16(access_flags);
+void jvm::Class::parseClass(ByteReader &reader) {
+    access_flags = reader.u2();
     SESE_DEBUG("access flags 0x%x", access_flags);
 
-    ASSERT_READ(this_class)
-    this_class = FromBigEndian16(this_class);
+    this_class = reader.u2();
     SESE_DEBUG("this class %d", this_class);
 
-    ASSERT_READ(super_class)
-    super_class = FromBigEndian16(super_class);
+    super_class = reader.u2();
     SESE_DEBUG("super class %d", super_class);
 
-    uint16_t interface_count;
-    ASSERT_READ(interface_count)
-    interface_count = FromBigEndian16(interface_count);
+    auto interface_count = reader.u2();
     SESE_DEBUG("interface count %d", interface_count);
 
     interfaces.reserve(interface_count);
     for (int i = 0; i < interface_count; i++) {
-        uint16_t iface;
-        ASSERT_READ(iface)
-        iface = FromBigEndian16(iface);
+        auto iface = reader.u2();
         SESE_DEBUG("interface %d", iface);
         interfaces.push_back(iface);
     }
 }
 
-void jvm::Class::parseFields(sese::io::InputStream *input_stream) {
-    int16_t fields_count;
-    ASSERT_READ(fields_count)
-    fields_count = FromBigEndian16(fields_count);
+void jvm::Class::parseFields(ByteReader &reader) {
+    auto fields_count = reader.u2();
     SESE_DEBUG("fields count %d", fields_count);
 
     field_infos.reserve(fields_count);
     for (int i = 0; i < fields_count; ++i) {
         FieldInfo field_info;
-        uint16_t name_index, descriptor_index, attributes_count;
-        ASSERT_READ(field_info.access_flags)
-        field_info.access_flags = FromBigEndian16(field_info.access_flags);
-        ASSERT_READ(name_index)
-        name_index = FromBigEndian16(name_index);
-        field_info.name = getUtf8(constant_infos, name_index);
-        ASSERT_READ(descriptor_index)
-        descriptor_index = FromBigEndian16(descriptor_index);
-        auto descriptor = getUtf8(constant_infos, descriptor_index);
-        field_info.type.parse(descriptor);
-        ASSERT_READ(attributes_count)
-        attributes_count = FromBigEndian16(attributes_count);
+        field_info.access_flags = reader.u2();
+        field_info.name = getUtf8(reader.u2());
+        field_info.descriptor = getUtf8(reader.u2());
+        field_info.type.parse(std::string(field_info.descriptor));
+        auto attributes_count = reader.u2();
         field_info.attribute_infos.reserve(attributes_count);
-        for (int j = 0; i < attributes_count; j++) {
+        for (int j = 0; j < attributes_count; j++) {
             AttributeInfo attribute_info;
-            uint32_t length;
-            ASSERT_READ(name_index)
-            name_index = FromBigEndian16(name_index);
-            attribute_info.name = getUtf8(constant_infos, name_index);
-            ASSERT_READ(length)
-            length = FromBigEndian32(length);
-            attribute_info.info.reserve(length);
-            attribute_info.info.reserve(length);
-            if (length != input_stream->read(attribute_info.info.data(), length)) {
-                throw sese::Exception("failed to parse attribute_info.info");
-            }
+            attribute_info.name = getUtf8(reader.u2());
+            attribute_info.info = reader.bytes(reader.u4());
             field_info.attribute_infos.push_back(attribute_info);
         }
         field_infos.push_back(std::move(field_info));
     }
 }
 
-void jvm::Class::parseMethods(sese::io::InputStream *input_stream) {
-    uint16_t methods_count;
-    ASSERT_READ(methods_count)
-    methods_count = FromBigEndian16(methods_count);
+/// 解析方法描述符中的参数与返回值类型
+/// @exception sese::Exception 描述符格式错误
+static void parseMethodDescriptor(std::string_view descriptor, jvm::Class::MethodInfo &method_info) {
+    if (descriptor.empty() || descriptor[0] != '(') throw sese::Exception("illegal method descriptor");
+    size_t l = 1;
+    auto next_type = [&]() -> std::string_view {
+        auto begin = l;
+        while (l < descriptor.size() && descriptor[l] == '[') ++l;
+        if (l >= descriptor.size()) throw sese::Exception("illegal method descriptor");
+        if (descriptor[l] == 'L') {
+            auto end = descriptor.find(';', l);
+            if (end == std::string_view::npos) throw sese::Exception("illegal method descriptor");
+            l = end;
+        }
+        ++l;
+        return descriptor.substr(begin, l - begin);
+    };
+    while (l < descriptor.size() && descriptor[l] != ')') {
+        jvm::TypeInfo type_info;
+        type_info.parse(std::string(next_type()));
+        method_info.args_slots += !type_info.is_array &&
+                                  (type_info.type == jvm::long_ || type_info.type == jvm::double_) ? 2 : 1;
+        method_info.args_type.emplace_back(std::move(type_info));
+    }
+    if (l >= descriptor.size()) throw sese::Exception("illegal method descriptor");
+    ++l;
+    method_info.return_type.parse(std::string(next_type()));
+}
+
+void jvm::Class::parseMethods(ByteReader &reader) {
+    auto methods_count = reader.u2();
     SESE_DEBUG("methods count %d", methods_count);
 
     for (int i = 0; i < methods_count; ++i) {
         MethodInfo method_info;
-        uint16_t name_index, descriptor_index, attributes_count;
-        ASSERT_READ(method_info.access_flags)
-        method_info.access_flags = FromBigEndian16(method_info.access_flags);
-        ASSERT_READ(name_index)
-        name_index = FromBigEndian16(name_index);
-        method_info.name = getUtf8(constant_infos, name_index);
-        ASSERT_READ(descriptor_index)
-        descriptor_index = FromBigEndian16(descriptor_index);
-        auto descriptor = getUtf8(constant_infos, descriptor_index);
-        method_info.descriptor = descriptor;
-        descriptor = descriptor.substr(1, descriptor.length() - 1);
-        auto pos1 = descriptor.find('(');
-        auto pos2 = descriptor.find(')');
-        auto params = descriptor.substr(pos1 + 1, pos2 - pos1 - 1);
-        auto return_ = descriptor.substr(pos2 + 1);
-        for (int l = 0; l < params.size();) {
-            TypeInfo type_info;
-            auto prefix = params.find_first_not_of('[');
-            if (prefix == std::string::npos) prefix = 0;
-            if (params[l + prefix] == 'L') {
-                auto end = params.find_first_of(';');
-                auto param = params.substr(l, end + 1);
-                type_info.parse(param);
-                l += static_cast<int>(end) + 1;
-            } else {
-                type_info.parse(params.substr(l, 1));
-                l += 1;
-            }
-            method_info.args_type.emplace_back(std::move(type_info));
-        }
-        method_info.return_type.parse(return_);
-        ASSERT_READ(attributes_count)
-        attributes_count = FromBigEndian16(attributes_count);
+        method_info.access_flags = reader.u2();
+        method_info.name = getUtf8(reader.u2());
+        method_info.descriptor = getUtf8(reader.u2());
+        parseMethodDescriptor(method_info.descriptor, method_info);
+        auto attributes_count = reader.u2();
         method_info.attribute_infos.reserve(attributes_count);
         for (int j = 0; j < attributes_count; ++j) {
             AttributeInfo attribute_info;
-            uint32_t length;
-            ASSERT_READ(name_index)
-            name_index = FromBigEndian16(name_index);
-            attribute_info.name = getUtf8(constant_infos, name_index);
-            ASSERT_READ(length)
-            length = FromBigEndian32(length);
+            attribute_info.name = getUtf8(reader.u2());
+            attribute_info.info = reader.bytes(reader.u4());
+            ByteReader attribute_reader(reinterpret_cast<const uint8_t *>(attribute_info.info.data()),
+                                        attribute_info.info.size());
             if (attribute_info.name == "Code") {
                 method_info.code_info = std::make_unique<CodeInfo>();
-                parseAttributeCode(input_stream, method_info.code_info.get());
+                parseAttributeCode(attribute_reader, method_info.code_info.get());
             } else if (attribute_info.name == "Exceptions") {
-                uint16_t exceptions_count;
-                ASSERT_READ(exceptions_count)
-                exceptions_count = FromBigEndian16(exceptions_count);
+                auto exceptions_count = attribute_reader.u2();
                 for (int k = 0; k < exceptions_count; ++k) {
                     ExceptionInfo exception_info;
-                    ASSERT_READ(exception_info.type)
-                    exception_info.type = FromBigEndian16(exception_info.type);
+                    exception_info.type = attribute_reader.u2();
                     method_info.exception_infos.emplace_back(exception_info);
                 }
             } else {
-                attribute_info.info.reserve(length);
-                attribute_info.info.resize(length);
-                if (length != input_stream->read(attribute_info.info.data(), length)) {
-                    throw sese::Exception("failed to parse attribute_info.info");
-                }
                 method_info.attribute_infos.push_back(attribute_info);
             }
         }
-        method_infos[method_info.name + method_info.descriptor] = std::move(method_info);
+        auto id = std::string(method_info.name);
+        id += method_info.descriptor;
+        method_infos[id] = std::move(method_info);
     }
 }
 
-void jvm::Class::parseAttributes(sese::io::InputStream *input_stream) {
-    uint16_t attributes_count;
-    ASSERT_READ(attributes_count)
-    attributes_count = FromBigEndian16(attributes_count);
+void jvm::Class::parseAttributes(ByteReader &reader) {
+    auto attributes_count = reader.u2();
     SESE_DEBUG("attributes count %d", attributes_count);
     attribute_infos.reserve(attributes_count);
     for (int j = 0; j < attributes_count; ++j) {
         AttributeInfo attribute_info;
-        uint16_t name_index;
-        uint32_t length;
-        ASSERT_READ(name_index)
-        ASSERT_READ(length)
-        length = FromBigEndian32(length);
-        name_index = FromBigEndian16(name_index);
-        attribute_info.name = getUtf8(constant_infos, name_index);
+        attribute_info.name = getUtf8(reader.u2());
+        attribute_info.info = reader.bytes(reader.u4());
         if (attribute_info.name == "SourceFile") {
-            ASSERT_READ(name_index)
-            name_index = FromBigEndian16(name_index);
-            source_file = getUtf8(constant_infos, name_index);
+            ByteReader attribute_reader(reinterpret_cast<const uint8_t *>(attribute_info.info.data()),
+                                        attribute_info.info.size());
+            source_file = getUtf8(attribute_reader.u2());
         } else {
-            attribute_info.info.reserve(length);
-            attribute_info.info.resize(length);
-            if (length != input_stream->read(attribute_info.info.data(), length)) {
-                throw sese::Exception("failed to parse attribute_info.info");
-            }
             attribute_infos.push_back(attribute_info);
         }
     }
 }
 
-void jvm::Class::parseAttributeCode(sese::io::InputStream *input_stream, CodeInfo *code_info) const {
-    uint32_t code_length;
-    uint16_t exceptions_count;
-    uint16_t attributes_count;
-    ASSERT_READ(code_info->max_stack)
-    code_info->max_stack = FromBigEndian16(code_info->max_stack);
-    ASSERT_READ(code_info->max_locals)
-    code_info->max_locals = FromBigEndian16(code_info->max_locals);
-    ASSERT_READ(code_length)
-    code_length = FromBigEndian32(code_length);
-    code_info->code.reserve(code_length);
-    code_info->code.resize(code_length);
-    if (code_length != input_stream->read(code_info->code.data(), code_length)) {
-        throw sese::Exception("failed to read code");
-    }
-    ASSERT_READ(exceptions_count)
-    exceptions_count = FromBigEndian16(exceptions_count);
+void jvm::Class::parseAttributeCode(ByteReader &reader, CodeInfo *code_info) const {
+    code_info->max_stack = reader.u2();
+    code_info->max_locals = reader.u2();
+    code_info->code = reader.bytes(reader.u4());
+    auto exceptions_count = reader.u2();
+    code_info->exception_infos.reserve(exceptions_count);
     for (int k = 0; k < exceptions_count; ++k) {
         ExceptionInfo exception_info;
-        ASSERT_READ(exception_info.from)
-        exception_info.from = FromBigEndian16(exception_info.from);
-        ASSERT_READ(exception_info.to)
-        exception_info.to = FromBigEndian16(exception_info.to);
-        ASSERT_READ(exception_info.target)
-        exception_info.target = FromBigEndian16(exception_info.target);
-        ASSERT_READ(exception_info.type)
-        exception_info.type = FromBigEndian16(exception_info.type);
+        exception_info.from = reader.u2();
+        exception_info.to = reader.u2();
+        exception_info.target = reader.u2();
+        exception_info.type = reader.u2();
         code_info->exception_infos.emplace_back(exception_info);
     }
-    ASSERT_READ(attributes_count)
-    attributes_count = FromBigEndian16(attributes_count);
+    auto attributes_count = reader.u2();
     for (int j = 0; j < attributes_count; ++j) {
         AttributeInfo attribute_info;
-        uint16_t name_index;
-        uint32_t length;
-        ASSERT_READ(name_index)
-        name_index = FromBigEndian16(name_index);
-        attribute_info.name = getUtf8(constant_infos, name_index);
-        ASSERT_READ(length)
-        length = FromBigEndian32(length);
+        attribute_info.name = getUtf8(reader.u2());
+        attribute_info.info = reader.bytes(reader.u4());
         if (attribute_info.name == "LineNumberTable") {
-            uint16_t line_number_info_count;
-            ASSERT_READ(line_number_info_count)
-            line_number_info_count = FromBigEndian16(line_number_info_count);
+            ByteReader attribute_reader(reinterpret_cast<const uint8_t *>(attribute_info.info.data()),
+                                        attribute_info.info.size());
+            auto line_number_info_count = attribute_reader.u2();
+            code_info->line_infos.reserve(line_number_info_count);
             for (int k = 0; k < line_number_info_count; ++k) {
                 LineNumberInfo line_number_info{};
-                ASSERT_READ(line_number_info.start_pc)
-                line_number_info.start_pc = FromBigEndian16(line_number_info.start_pc);
-                ASSERT_READ(line_number_info.line_number)
-                line_number_info.line_number = FromBigEndian16(line_number_info.line_number);
+                line_number_info.start_pc = attribute_reader.u2();
+                line_number_info.line_number = attribute_reader.u2();
                 code_info->line_infos.emplace_back(line_number_info);
             }
         } else {
-            attribute_info.info.reserve(length);
-            attribute_info.info.resize(length);
-            if (length != input_stream->read(attribute_info.info.data(), length)) {
-                throw sese::Exception("failed to parse attribute");
-            }
-            code_info->attribute_infos.emplace_back(std::move(attribute_info));
+            code_info->attribute_infos.emplace_back(attribute_info);
         }
     }
 }
@@ -0,0 +1,18 @@
+#include "Frame.h"
+
+jvm::FrameStack::FrameStack(size_t slot_capacity, size_t frame_capacity)
+    // Slot 与 Frame 均可平凡默认构造，new[] 不写入任何内容，未触及的页面不会占用物理内存；
+    // 只有哨兵帧需要初始化
+    : slots(new Slot[slot_capacity]),
+      frames(new Frame[frame_capacity + 1]) {
+    slots_end = slots.get() + slot_capacity;
+    frames_end = frames.get() + frame_capacity + 1;
+    top = frames.get();
+    *top = Frame{nullptr, nullptr, nullptr, nullptr, slots.get()};
+}
+
+jvm::FrameStack &jvm::FrameStack::current() {
+    // 8 MiB Slot 区域，约可容纳十万级的递归深度
+    thread_local FrameStack stack(1 << 20, 1 << 17);
+    return stack;
+}
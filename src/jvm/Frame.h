@@ -0,0 +1,95 @@
+#pragma once
+
+#include <jvm/Class.h>
+#include <jvm/Slot.h>
+
+#include <sese/util/Exception.h>
+
+#include <memory>
+#include <type_traits>
+#include <vector>
+
+namespace jvm {
+    /// 解释器栈帧记录
+    /// @note 局部变量表与操作数栈位于 FrameStack 的连续 Slot 区域中，
+    /// 调用者操作数栈顶部的参数直接作为被调用者局部变量表的起始部分；
+    /// 字段没有默认值，由 FrameStack::push 在压入时逐一写入
+    struct Frame {
+        Class *class_;
+        Class::MethodInfo *method;
+        /// 发起调用时所在的指令，返回后从下一条指令继续执行
+        const Instruction *ip;
+        /// 局部变量表起始位置
+        Slot *locals;
+        /// 发起调用时保存的操作数栈栈顶，参数已经出栈
+        Slot *sp;
+    };
+
+    static_assert(std::is_trivially_default_constructible_v<Frame>,
+                  "FrameStack relies on new Frame[] leaving the records untouched");
+
+    /// 线程私有的栈帧区域，Slot 与帧记录均预先分配，调用与返回不涉及内存分配
+    class FrameStack {
+    public:
+        /// @param slot_capacity Slot 区域容量
+        /// @param frame_capacity 最大调用深度
+        FrameStack(size_t slot_capacity, size_t frame_capacity);
+
+        FrameStack(const FrameStack &) = delete;
+
+        FrameStack &operator=(const FrameStack &) = delete;
+
+        /// 获取当前线程的栈帧区域，首次访问时创建
+        static FrameStack &current();
+
+        /// 压入新的栈帧
+        /// @param locals 局部变量表起始位置，参数已经按顺序位于此处
+        /// @exception sese::Exception 调用深度或者 Slot 区域耗尽
+        Frame *push(Class *class_, Class::MethodInfo *method, Slot *locals) {
+            auto &&code = method->code_info;
+            if (!code) throw sese::Exception("java/lang/AbstractMethodError: method has no code");
+            if (top + 1 == frames_end || locals + code->max_locals + code->max_stack > slots_end) {
+                throw sese::Exception("java/lang/StackOverflowError");
+            }
+            auto frame = ++top;
+            frame->class_ = class_;
+            frame->method = method;
+            frame->ip = nullptr;
+            frame->locals = locals;
+            frame->sp = locals + code->max_locals;
+            return frame;
+        }
+
+        /// 弹出栈顶帧
+        /// @return 新的栈顶帧
+        Frame *pop() {
+            return --top;
+        }
+
+        /// 恢复栈顶，用于异常离开解释器时丢弃残留的栈帧
+        void unwind(Frame *frame) {
+            top = frame;
+        }
+
+        /// 当前栈顶帧，没有任何栈帧时返回哨兵帧
+        [[nodiscard]] Frame *peek() const { return top; }
+
+        /// 哨兵帧，从栈顶帧向下遍历至此为止
+        [[nodiscard]] const Frame *sentinel() const { return frames.get(); }
+
+        /// 第一个空闲的 Slot，新的入口帧从此处开始存放参数
+        [[nodiscard]] Slot *freeSlots() const { return top->sp; }
+
+        /// 解释器在连续多次分配之间临时持有的引用，与栈帧中的引用一同作为根集合枚举
+        [[nodiscard]] std::vector<void *> &handles() { return pinned; }
+
+    private:
+        std::unique_ptr<Slot[]> slots;
+        std::unique_ptr<Frame[]> frames;
+        Slot *slots_end;
+        Frame *frames_end;
+        /// frames[0] 为哨兵帧，其 sp 指向 Slot 区域起始位置
+        Frame *top;
+        std::vector<void *> pinned;
+    };
+}
@@ -0,0 +1,155 @@
+#include "Heap.h"
+
+#include <sese/util/Exception.h>
+
+#include <atomic>
+#include <string>
+
+namespace {
+    /// 空闲块的大小记录在对象头中，超过此大小的空闲块拆分存放
+    constexpr size_t max_block = 1u << 30;
+
+    /// 堆编号，所有堆共用，保证分配缓冲区不会误认其他堆或者收集之前的编号
+    uint64_t nextId() {
+        static std::atomic<uint64_t> next{1};
+        return next++;
+    }
+
+    size_t alignDown(size_t value, size_t alignment) {
+        return value / alignment * alignment;
+    }
+}
+
+jvm::Heap::Heap(size_t nursery, size_t old, RootScanner roots, Safepoint &safepoint)
+    : id(nextId()), roots(std::move(roots)), safepoint(safepoint) {
+    auto survivor = alignDown(nursery / 10, card_size);
+    auto eden_size = alignDown(nursery, card_size) - 2 * survivor;
+    old = alignDown(old, card_size);
+    if (eden_size < tlab_size || survivor == 0 || old == 0) {
+        throw sese::Exception("heap is too small");
+    }
+    // 不做初始化，未触及的页面不会占用物理内存
+    memory.reset(new uint8_t[eden_size + 2 * survivor + old]);
+    auto address = memory.get();
+    eden = {address, address + eden_size, address};
+    address += eden_size;
+    for (auto &&space: survivors) {
+        space = {address, address + survivor, address};
+        address += survivor;
+    }
+    old_begin = address;
+    old_end = address + old;
+    cards.assign(old / card_size, 0);
+    block_starts.assign(old / card_size, -1);
+    addFree(old_begin, old);
+}
+
+jvm::Object *jvm::Heap::allocateSlow(Class *class_, uint32_t size) {
+    auto guard = lock();
+    auto &&tlab = local();
+    uint8_t *address;
+    if (size > static_cast<size_t>(eden.end - eden.begin) / 2) {
+        // 超过 eden 一半的对象直接在老年代分配
+        address = allocateOld(size);
+        if (address == nullptr) {
+            collectLocked(true);
+            address = allocateOld(size);
+        }
+        if (address == nullptr) throw sese::Exception("java/lang/OutOfMemoryError: Java heap space");
+        statistics.bytes_promoted += size;
+    } else if (size > tlab_size / 4) {
+        // 超过缓冲区四分之一的对象单独分配，避免丢弃过多的缓冲区剩余空间
+        address = eden.take(size);
+        if (address == nullptr) {
+            collectLocked(false);
+            address = eden.take(size);
+        }
+    } else {
+        address = eden.take(tlab_size);
+        if (address == nullptr) {
+            collectLocked(false);
+            address = eden.take(tlab_size);
+        }
+        tlab.heap = id;
+        tlab.top = address + size;
+        tlab.end = address + tlab_size;
+    }
+    auto object = reinterpret_cast<Object *>(address);
+    initialize(object, class_, size);
+    return object;
+}
+
+jvm::Array *jvm::Heap::allocateArray(Array::Element element, int32_t length) {
+    if (length < 0) throw sese::Exception("java/lang/NegativeArraySizeException: " + std::to_string(length));
+    auto bytes = static_cast<uint64_t>(length) * Array::elementSize(element) + sizeof(Array);
+    if (bytes > max_block) throw sese::Exception("java/lang/OutOfMemoryError: Requested array size exceeds VM limit");
+    auto array = static_cast<Array *>(allocate(nullptr, static_cast<uint32_t>((bytes + 7) / 8 * 8)));
+    array->flags = Object::array;
+    array->length = length;
+    array->element = element;
+    return array;
+}
+
+std::unique_lock<std::mutex> jvm::Heap::lock() {
+    std::unique_lock<std::mutex> guard(mutex, std::defer_lock);
+    // 持有锁的线程可能正在等待所有线程到达安全点，当前线程离开阻塞区域时收集已经结束
+    Safepoint::Blocking blocking(safepoint);
+    guard.lock();
+    return guard;
+}
+
+void jvm::Heap::retireTlabs() {
+    id = nextId();
+}
+
+uint8_t *jvm::Heap::allocateOld(uint32_t &size) {
+    auto iter = free_blocks.lower_bound(size);
+    if (iter == free_blocks.end()) return nullptr;
+    auto [block, address] = *iter;
+    free_blocks.erase(iter);
+    old_free -= block;
+    // 剩余部分不足以容纳对象头时并入当前对象
+    if (block - size >= sizeof(Object)) {
+        addFree(address + size, block - size);
+    } else {
+        size = static_cast<uint32_t>(block);
+    }
+    return address;
+}
+
+void jvm::Heap::addFree(uint8_t *address, size_t size) {
+    while (size) {
+        auto block = size > max_block ? max_block : size;
+        auto header = reinterpret_cast<Object *>(address);
+        header->class_ = nullptr;
+        header->size = static_cast<uint32_t>(block);
+        header->flags = Object::free;
+        free_blocks.emplace(block, address);
+        old_free += block;
+        recordBlock(address);
+        address += block;
+        size -= block;
+    }
+}
+
+void jvm::Heap::recordBlock(const uint8_t *address) {
+    auto offset = static_cast<size_t>(address - old_begin);
+    auto &&start = block_starts[offset / card_size];
+    auto in_card = static_cast<int16_t>(offset % card_size);
+    if (start < 0 || in_card < start) start = in_card;
+}
+
+jvm::GcStats jvm::Heap::stats() const {
+    std::lock_guard<std::mutex> guard(mutex);
+    return statistics;
+}
+
+size_t jvm::Heap::youngUsed() const {
+    std::lock_guard<std::mutex> guard(mutex);
+    return (eden.top - eden.begin) + (survivors[from].top - survivors[from].begin);
+}
+
+size_t jvm::Heap::oldUsed() const {
+    std::lock_guard<std::mutex> guard(mutex);
+    return (old_end - old_begin) - old_free;
+}
@@ -0,0 +1,206 @@
+#pragma once
+
+#include <jvm/Object.h>
+#include <jvm/Safepoint.h>
+
+#include <cstddef>
+#include <cstring>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace jvm {
+    /// 垃圾收集的统计信息
+    struct GcStats {
+        /// 新生代收集次数
+        uint64_t minor_collections{};
+        /// 老年代收集次数，每次老年代收集之后紧跟一次新生代收集
+        uint64_t major_collections{};
+        /// 累计暂停时间，单位为纳秒
+        uint64_t total_pause_ns{};
+        /// 单次最长暂停时间，单位为纳秒
+        uint64_t max_pause_ns{};
+        /// 最近一次暂停时间，单位为纳秒
+        uint64_t last_pause_ns{};
+        /// 复制到 survivor 区的累计字节数
+        uint64_t bytes_survived{};
+        /// 晋升到老年代的累计字节数，包括直接在老年代分配的大对象
+        uint64_t bytes_promoted{};
+        /// 老年代收集释放的累计字节数
+        uint64_t bytes_reclaimed{};
+    };
+
+    /// 分代托管堆
+    /// @note 新生代由 eden 与两个 survivor 区组成，各线程从 eden 中划分私有的分配缓冲区（TLAB），
+    /// 缓冲区内的分配只需移动指针；eden 耗尽时按照 Cheney 算法将存活对象复制到空闲的 survivor 区，
+    /// 存活次数达到晋升年龄或者 survivor 区已满时复制到老年代。
+    /// 老年代使用空闲链表分配，空间不足时先进行标记-清除；
+    /// 老年代对象写入引用字段时通过写屏障标记卡表，新生代收集只需扫描脏卡而无需遍历整个老年代。
+    /// 收集前通过 Safepoint 暂停所有正在执行字节码的线程，等待堆的锁的线程视为已到达安全点
+    class Heap {
+    public:
+        /// 每个分配缓冲区的大小
+        static constexpr size_t tlab_size = 64 * 1024;
+        /// 卡表中每张卡覆盖的字节数
+        static constexpr size_t card_size = 512;
+        /// 晋升年龄
+        static constexpr uint32_t tenuring_age = 2;
+
+        /// 根集合的枚举方式，对每个存放引用的位置调用 visit，收集后其中的引用会被更新为对象的新地址
+        using RootScanner = std::function<void(const std::function<void(void *&)> &visit)>;
+
+        /// @param nursery 新生代大小，其中 eden 占 80%，两个 survivor 区各占 10%
+        /// @param old 老年代大小
+        /// @param safepoint 收集前用于暂停其他线程，需要在堆的整个生命周期内保持有效
+        /// @note 未触及的部分不会占用物理内存
+        Heap(size_t nursery, size_t old, RootScanner roots, Safepoint &safepoint);
+
+        Heap(const Heap &) = delete;
+
+        Heap &operator=(const Heap &) = delete;
+
+        /// 分配对象并将字段清零，可能触发垃圾收集，调用前根集合需要处于可枚举的状态
+        /// @param size 对象大小，包括对象头，需要按 8 字节对齐
+        /// @exception sese::Exception 收集后空间依然不足时抛出 java/lang/OutOfMemoryError
+        Object *allocate(Class *class_, uint32_t size) {
+            auto &&tlab = local();
+            if (tlab.heap != id || static_cast<size_t>(tlab.end - tlab.top) < size) {
+                return allocateSlow(class_, size);
+            }
+            auto object = reinterpret_cast<Object *>(tlab.top);
+            tlab.top += size;
+            initialize(object, class_, size);
+            return object;
+        }
+
+        /// 分配数组并将元素清零，可能触发垃圾收集，调用前根集合需要处于可枚举的状态
+        /// @exception sese::Exception 长度为负数时抛出 java/lang/NegativeArraySizeException，
+        /// 空间不足时抛出 java/lang/OutOfMemoryError
+        Array *allocateArray(Array::Element element, int32_t length);
+
+        /// 写屏障，在 object 的引用字段或者引用数组的元素被写入之后调用
+        void writeBarrier(const void *object) {
+            auto address = static_cast<const uint8_t *>(object);
+            if (address >= old_begin && address < old_end) {
+                cards[(address - old_begin) / card_size] = 1;
+            }
+        }
+
+        /// 立即进行一次新生代收集
+        void collect();
+
+        /// 立即进行一次老年代收集以及随后的新生代收集
+        void collectFully();
+
+        [[nodiscard]] GcStats stats() const;
+
+        /// 新生代中已使用的字节数，包括已划分但尚未用完的分配缓冲区
+        [[nodiscard]] size_t youngUsed() const;
+
+        /// 老年代中已使用的字节数
+        [[nodiscard]] size_t oldUsed() const;
+
+    private:
+        /// 线程私有的分配缓冲区，编号与堆的当前编号不一致时视为已耗尽
+        struct Tlab {
+            uint64_t heap{};
+            uint8_t *top{};
+            uint8_t *end{};
+        };
+
+        /// 连续的地址区间，top 之前为已使用部分
+        struct Space {
+            uint8_t *begin{};
+            uint8_t *end{};
+            uint8_t *top{};
+
+            [[nodiscard]] bool contains(const void *address) const {
+                return address >= begin && address < end;
+            }
+
+            uint8_t *take(size_t size) {
+                if (static_cast<size_t>(end - top) < size) return nullptr;
+                auto address = top;
+                top += size;
+                return address;
+            }
+        };
+
+        static Tlab &local() {
+            thread_local Tlab tlab;
+            return tlab;
+        }
+
+        static void initialize(Object *object, Class *class_, uint32_t size) {
+            memset(object, 0, size);
+            object->class_ = class_;
+            object->size = size;
+        }
+
+        /// 缓冲区耗尽时划分新的缓冲区，大对象直接在 eden 或者老年代中分配，必要时进行收集
+        Object *allocateSlow(Class *class_, uint32_t size);
+
+        /// 重新编号，使所有线程的分配缓冲区失效
+        void retireTlabs();
+
+        [[nodiscard]] bool inYoung(const void *address) const {
+            return address >= eden.begin && address < old_begin;
+        }
+
+        /// 从老年代的空闲链表中按照最佳适配分配，空间不足时返回 nullptr
+        /// @param size 请求的大小，剩余部分不足以成为空闲块时并入分配的块，此时更新为实际大小
+        uint8_t *allocateOld(uint32_t &size);
+
+        /// 将 [address, address + size) 作为空闲块加入空闲链表
+        void addFree(uint8_t *address, size_t size);
+
+        /// 记录从 address 开始的块，用于从脏卡定位其中的对象
+        void recordBlock(const uint8_t *address);
+
+        /// 对象中引用字段或者引用数组元素的遍历
+        template<typename Visit>
+        static void forEachReference(Object *object, Visit &&visit);
+
+        void minor();
+
+        void major();
+
+        /// 复制新生代对象，返回新的地址，其他引用原样返回
+        void *evacuate(void *ref);
+
+        /// 更新老年代对象中的引用，仍然指向新生代时标记其所在的卡
+        void scanOld(Object *object);
+
+        /// 获取堆的锁，等待期间当前线程视为已到达安全点，其他线程可以在此期间完成收集
+        std::unique_lock<std::mutex> lock();
+
+        /// 已持有锁时暂停所有线程进行收集并记录暂停时间，暂停时间包括等待其他线程到达安全点的时间
+        /// @param full 是否在新生代收集之前进行老年代收集
+        void collectLocked(bool full);
+
+        /// 堆的当前编号，每次收集后更新，用于使分配缓冲区失效
+        uint64_t id{};
+        RootScanner roots;
+        Safepoint &safepoint;
+        std::unique_ptr<uint8_t[]> memory;
+        Space eden;
+        Space survivors[2];
+        /// 当前存放存活对象的 survivor 区下标
+        int from{0};
+        uint8_t *old_begin{};
+        uint8_t *old_end{};
+        /// 老年代的空闲块，按照大小索引，用于最佳适配
+        std::multimap<size_t, uint8_t *> free_blocks;
+        size_t old_free{};
+        /// 每张卡一个字节，非零表示卡中有对象的引用字段被写入过
+        std::vector<uint8_t> cards;
+        /// 每张卡中第一个块相对于卡起始位置的偏移，没有块从卡中开始时为 -1
+        std::vector<int16_t> block_starts;
+        /// 新生代收集期间晋升到老年代、尚未扫描的对象
+        std::vector<Object *> promoted;
+        GcStats statistics;
+        mutable std::mutex mutex;
+    };
+}
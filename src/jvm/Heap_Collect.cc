@@ -0,0 +1,183 @@
+#include "Class.h"
+#include "Heap.h"
+
+#include <sese/util/Exception.h>
+
+#include <algorithm>
+#include <chrono>
+
+template<typename Visit>
+void jvm::Heap::forEachReference(Object *object, Visit &&visit) {
+    if (object->flags & Object::array) {
+        auto array = static_cast<Array *>(object);
+        if (array->element != Array::t_reference) return;
+        auto elements = reinterpret_cast<void **>(array->data());
+        for (int32_t i = 0; i < array->length; ++i) {
+            visit(elements[i]);
+        }
+        return;
+    }
+    auto base = reinterpret_cast<uint8_t *>(object);
+    for (auto &&offset: object->class_->getReferenceOffsets()) {
+        visit(*reinterpret_cast<void **>(base + offset));
+    }
+}
+
+void jvm::Heap::collect() {
+    auto guard = lock();
+    collectLocked(false);
+}
+
+void jvm::Heap::collectFully() {
+    auto guard = lock();
+    collectLocked(true);
+}
+
+void jvm::Heap::collectLocked(bool full) {
+    auto start = std::chrono::steady_clock::now();
+    safepoint.stopTheWorld([this, full] {
+        if (full) {
+            major();
+        }
+        minor();
+    });
+    auto pause = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - start).count());
+    statistics.last_pause_ns = pause;
+    statistics.total_pause_ns += pause;
+    statistics.max_pause_ns = std::max(statistics.max_pause_ns, pause);
+}
+
+void jvm::Heap::minor() {
+    // 最坏情况下所有新生代对象都需要晋升，老年代空间不足时先回收老年代
+    auto young_used = static_cast<size_t>(eden.top - eden.begin) +
+                      static_cast<size_t>(survivors[from].top - survivors[from].begin);
+    if (old_free < young_used) {
+        major();
+    }
+    ++statistics.minor_collections;
+    auto &&to = survivors[1 - from];
+    to.top = to.begin;
+    promoted.clear();
+
+    roots([this](void *&ref) { ref = evacuate(ref); });
+
+    // 脏卡中记录了可能指向新生代的老年代对象，卡上的对象头之后依次排列，直至越过卡的末尾
+    for (size_t card = 0; card < cards.size(); ++card) {
+        if (!cards[card] || block_starts[card] < 0) continue;
+        cards[card] = 0;
+        auto card_begin = old_begin + card * card_size;
+        for (auto address = card_begin + block_starts[card]; address < card_begin + card_size;) {
+            auto object = reinterpret_cast<Object *>(address);
+            if (!(object->flags & Object::free)) scanOld(object);
+            address += object->size;
+        }
+    }
+
+    // 广度优先扫描复制到 survivor 区以及晋升的对象，直至没有新的对象被复制
+    auto scan = to.begin;
+    size_t promoted_scan = 0;
+    while (scan < to.top || promoted_scan < promoted.size()) {
+        while (scan < to.top) {
+            auto object = reinterpret_cast<Object *>(scan);
+            forEachReference(object, [this](void *&ref) { ref = evacuate(ref); });
+            scan += object->size;
+        }
+        while (promoted_scan < promoted.size()) {
+            scanOld(promoted[promoted_scan++]);
+        }
+    }
+
+    statistics.bytes_survived += static_cast<uint64_t>(to.top - to.begin);
+    eden.top = eden.begin;
+    survivors[from].top = survivors[from].begin;
+    from = 1 - from;
+    promoted.clear();
+    retireTlabs();
+}
+
+void *jvm::Heap::evacuate(void *ref) {
+    if (ref == nullptr || !inYoung(ref)) return ref;
+    auto object = static_cast<Object *>(ref);
+    if (object->flags & Object::forwarded) return object->class_;
+    auto age = std::min((object->flags & Object::age_mask) + 1, Object::age_mask);
+    auto size = object->size;
+    auto &&to = survivors[1 - from];
+    uint8_t *address = nullptr;
+    auto tenured = false;
+    if (age < tenuring_age) {
+        address = to.take(size);
+    }
+    if (address == nullptr) {
+        address = allocateOld(size);
+        tenured = address != nullptr;
+    }
+    if (address == nullptr) {
+        // 老年代已满时尽量留在新生代
+        address = to.take(size);
+    }
+    if (address == nullptr) throw sese::Exception("java/lang/OutOfMemoryError: Java heap space");
+    memcpy(address, object, object->size);
+    auto copy = reinterpret_cast<Object *>(address);
+    copy->size = size;
+    copy->flags = (object->flags & Object::array) | age;
+    if (tenured) {
+        statistics.bytes_promoted += size;
+        promoted.push_back(copy);
+    }
+    object->class_ = reinterpret_cast<Class *>(copy);
+    object->flags |= Object::forwarded;
+    return copy;
+}
+
+void jvm::Heap::scanOld(Object *object) {
+    auto young = false;
+    forEachReference(object, [&](void *&ref) {
+        ref = evacuate(ref);
+        young |= inYoung(ref);
+    });
+    if (young) writeBarrier(object);
+}
+
+void jvm::Heap::major() {
+    ++statistics.major_collections;
+    // 标记阶段同时穿过新生代对象，新生代中的标记位在随后的复制中清除
+    std::vector<Object *> pending;
+    auto mark = [&](void *ref) {
+        auto object = static_cast<Object *>(ref);
+        if (object == nullptr || (object->flags & Object::marked)) return;
+        object->flags |= Object::marked;
+        pending.push_back(object);
+    };
+    roots([&](void *&ref) { mark(ref); });
+    while (!pending.empty()) {
+        auto object = pending.back();
+        pending.pop_back();
+        forEachReference(object, [&](void *&ref) { mark(ref); });
+    }
+
+    // 清除阶段按地址顺序遍历老年代，合并相邻的死亡对象与空闲块，并重建空闲链表与块起始位置
+    free_blocks.clear();
+    old_free = 0;
+    std::fill(block_starts.begin(), block_starts.end(), -1);
+    uint8_t *free_begin = nullptr;
+    for (auto address = old_begin; address < old_end;) {
+        auto object = reinterpret_cast<Object *>(address);
+        auto size = object->size;
+        if (!(object->flags & Object::free) && (object->flags & Object::marked)) {
+            object->flags &= ~Object::marked;
+            if (free_begin) {
+                addFree(free_begin, address - free_begin);
+                free_begin = nullptr;
+            }
+            recordBlock(address);
+        } else {
+            if (!(object->flags & Object::free)) statistics.bytes_reclaimed += size;
+            if (free_begin == nullptr) free_begin = address;
+        }
+        address += size;
+    }
+    if (free_begin) {
+        addFree(free_begin, old_end - free_begin);
+    }
+}
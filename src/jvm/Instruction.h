@@ -0,0 +1,189 @@
+#pragma once
+
+#include <jvm/Opcode.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+namespace jvm {
+    /// 解释器内部使用的扩展指令，编号位于字节码之后
+    enum InternalOpcode : uint16_t {
+        /// 执行越过方法末尾，合法的字节码不会到达此处
+        end_of_code = 0x100,
+
+        // 以下为加载期融合的超级指令，替换序列的首条指令，序列中其余指令保持原样，
+        // 因此跳转至序列中间的指令以及 pc 映射均不受影响
+
+        /// iload iload if_icmp<cond>，a、b 为两个局部变量下标，c 为跳转目标
+        iload_iload_if_icmpeq,
+        iload_iload_if_icmpne,
+        iload_iload_if_icmplt,
+        iload_iload_if_icmpge,
+        iload_iload_if_icmpgt,
+        iload_iload_if_icmple,
+        /// iload irem if<cond>，a 为除数所在的局部变量下标，c 为跳转目标
+        iload_irem_ifeq,
+        iload_irem_ifne,
+        /// iinc goto，a、b 同 iinc，c 为跳转目标
+        iinc_goto,
+        /// dload d<op> dstore，a 为加载的局部变量下标，c 为写回的局部变量下标
+        dload_dadd_dstore,
+        dload_dsub_dstore,
+
+        // 以下为链接期替换 invokestatic 的内建函数，a 仍为方法引用的常量池下标，
+        // 栈效果与原方法调用一致
+
+        /// Integer.bitCount、Long.bitCount
+        ipopcnt,
+        lpopcnt,
+        /// Integer.numberOfLeadingZeros、Long.numberOfLeadingZeros
+        iclz,
+        lclz,
+        /// Integer.numberOfTrailingZeros、Long.numberOfTrailingZeros
+        ictz,
+        lctz,
+        /// Integer.rotateLeft、Integer.rotateRight、Long.rotateLeft、Long.rotateRight
+        irotl,
+        irotr,
+        lrotl,
+        lrotr,
+        /// Integer.reverseBytes、Long.reverseBytes
+        ibswap,
+        lbswap,
+        /// System.arraycopy
+        arraycopy,
+        /// Arrays.fill，b 为填充值占用的 Slot 数量
+        arrayfill,
+        /// 指定 fromIndex、toIndex 的 Arrays.fill，b 同上
+        arrayfill_range,
+        /// 调用已注册的本地方法，b 为 Runtime 本地方法表中的下标
+        invokenative,
+
+        // 以下为链接期按照字段描述符特化的 getfield/putfield，a 仍为字段引用的常量池下标，
+        // 字段偏移在首次执行时解析并写入常量池缓存
+
+        /// byte 与 boolean
+        getfield_byte,
+        getfield_char,
+        getfield_short,
+        /// int 与 float
+        getfield_int,
+        /// long 与 double
+        getfield_long,
+        /// 对象与数组
+        getfield_ref,
+        putfield_boolean,
+        putfield_byte,
+        /// char 与 short
+        putfield_short,
+        putfield_int,
+        putfield_long,
+        putfield_ref,
+
+        // 以下为替换 getstatic/putstatic 的特化指令，a 仍为字段引用的常量池下标，b、c 存放静态字段的地址。
+        // 访问本类字段的指令在链接期替换，其余在首次执行且字段所属类完成初始化后替换，因此执行时无需再检查初始化状态
+
+        getstatic_byte,
+        getstatic_char,
+        getstatic_short,
+        getstatic_int,
+        getstatic_long,
+        getstatic_ref,
+        putstatic_boolean,
+        putstatic_byte,
+        putstatic_short,
+        putstatic_int,
+        putstatic_long,
+        putstatic_ref,
+
+        /// 内部指令总数，用于确定派发表大小
+        instruction_count
+    };
+
+    /// 预解码后的指令
+    /// @note 操作数已转换为本机字节序，跳转目标已转换为指令下标
+    struct Instruction {
+        /// computed goto 模式下处理例程的地址，switch 模式下为空
+        const void *handler{};
+        /// 字节码或者 InternalOpcode
+        uint16_t opcode{};
+        /// 对应的原始字节码位置，用于行号与异常表映射
+        uint16_t pc{};
+        int32_t a{};
+        int32_t b{};
+        int32_t c{};
+    };
+
+    static_assert(sizeof(Instruction) == 24, "Instruction should stay compact");
+    static_assert(offsetof(Instruction, c) == offsetof(Instruction, b) + sizeof(int32_t),
+                  "b and c should be able to hold an address");
+
+    /// 读取特化的静态字段指令中 b、c 存放的字段地址
+    inline uint8_t *staticAddress(const Instruction &insn) {
+        uint8_t *address;
+        memcpy(&address, reinterpret_cast<const char *>(&insn) + offsetof(Instruction, b), sizeof(address));
+        return address;
+    }
+
+    /// 将静态字段的地址写入指令的 b、c
+    inline void setStaticAddress(Instruction &insn, uint8_t *address) {
+        memcpy(reinterpret_cast<char *>(&insn) + offsetof(Instruction, b), &address, sizeof(address));
+    }
+
+    // 特化的静态字段指令在执行期间原地替换，其他线程可能同时经由同一条指令派发：
+    // 字段地址先于 handler 与 opcode 写入，后两者以 release 发布、以 acquire 读取，
+    // 读取到特化后的 handler 或 opcode 的线程必然能够看到字段地址。x86 上 acquire 读取仍是普通的 mov
+
+    /// 读取指令的处理例程，用于 computed goto 派发
+    inline const void *loadHandler(const Instruction &insn) {
+        return __atomic_load_n(&insn.handler, __ATOMIC_ACQUIRE);
+    }
+
+    /// 读取指令的 opcode，用于 switch 派发以及频率统计
+    inline uint16_t loadOpcode(const Instruction &insn) {
+        return __atomic_load_n(&insn.opcode, __ATOMIC_ACQUIRE);
+    }
+
+    /// 发布替换后的指令，操作数需要在此之前写入
+    /// @param handler switch 模式下为空，此时保持原值
+    inline void publishInstruction(Instruction &insn, uint16_t opcode, const void *handler) {
+        if (handler) __atomic_store_n(&insn.handler, handler, __ATOMIC_RELEASE);
+        __atomic_store_n(&insn.opcode, opcode, __ATOMIC_RELEASE);
+    }
+
+    // tableswitch：a 为默认跳转目标，b 为最小的键，c 处依次为表项数量与各个键对应的跳转目标；
+    // lookupswitch：a 为默认跳转目标，c 处依次为表项数量、升序排列的键与对应的跳转目标。
+    // 键足够密集的 lookupswitch 在预解码时转换为 tableswitch，空缺的键跳转至默认目标
+
+    /// 在 lookupswitch 的跳转表中查找 key，循环次数只取决于表项数量，循环体内没有分支
+    /// @return 跳转目标，键不存在时返回 default_target
+    inline int32_t lookupSwitch(const int32_t *table, int32_t key, int32_t default_target) {
+        auto count = table[0];
+        auto keys = table + 1;
+        if (count == 0) return default_target;
+        auto low = keys;
+        for (auto n = count; n > 1; n -= n / 2) {
+            low = low[n / 2] <= key ? low + n / 2 : low;
+        }
+        return *low == key ? keys[count + (low - keys)] : default_target;
+    }
+
+    /// 超级指令替换前的首条指令的通用形式，其余指令原样返回
+    constexpr uint16_t baseOpcode(uint16_t opcode) {
+        if (opcode >= iload_iload_if_icmpeq && opcode <= iload_irem_ifne) return iload;
+        if (opcode == iinc_goto) return iinc;
+        if (opcode == dload_dadd_dstore || opcode == dload_dsub_dstore) return dload;
+        return opcode;
+    }
+
+    /// 指令对应的原始字节码，用于频率统计，内建函数计为 invokestatic
+    constexpr uint8_t bytecodeOf(uint16_t opcode) {
+        if (opcode >= ipopcnt && opcode <= invokenative) return invokestatic;
+        if (opcode >= getfield_byte && opcode <= getfield_ref) return getfield;
+        if (opcode >= putfield_boolean && opcode <= putfield_ref) return putfield;
+        if (opcode >= getstatic_byte && opcode <= getstatic_ref) return getstatic;
+        if (opcode >= putstatic_boolean && opcode <= putstatic_ref) return putstatic;
+        return static_cast<uint8_t>(baseOpcode(opcode));
+    }
+}
@@ -0,0 +1,1001 @@
+#include "Jit.h"
+
+#ifdef JVM_JIT_SUPPORTED
+
+#include "Object.h"
+#include "Opcode.h"
+
+#include <cstring>
+#include <mutex>
+
+#include <cpuid.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+namespace {
+    using namespace jvm;
+
+    /// 可执行代码缓存，预留一段地址空间，按页分配，写入后切换为只读可执行
+    class CodeCache {
+    public:
+        static void *install(const std::vector<uint8_t> &code) {
+            static CodeCache cache;
+            return cache.allocate(code);
+        }
+
+    private:
+        static constexpr size_t capacity = 64 * 1024 * 1024;
+
+        CodeCache() {
+            page = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+            auto region = mmap(nullptr, capacity, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+            if (region != MAP_FAILED) {
+                begin = static_cast<uint8_t *>(region);
+                end = begin + capacity;
+                top = begin;
+            }
+        }
+
+        void *allocate(const std::vector<uint8_t> &code) {
+            std::lock_guard<std::mutex> guard(mutex);
+            // 每个方法独占整页，写入时不会影响其他正在执行的代码
+            auto size = (code.size() + page - 1) / page * page;
+            if (begin == nullptr || static_cast<size_t>(end - top) < size) return nullptr;
+            auto address = top;
+            if (mprotect(address, size, PROT_READ | PROT_WRITE) != 0) return nullptr;
+            memcpy(address, code.data(), code.size());
+            if (mprotect(address, size, PROT_READ | PROT_EXEC) != 0) return nullptr;
+            __builtin___clear_cache(reinterpret_cast<char *>(address), reinterpret_cast<char *>(address + code.size()));
+            top += size;
+            return address;
+        }
+
+        std::mutex mutex;
+        size_t page{};
+        uint8_t *begin{};
+        uint8_t *end{};
+        uint8_t *top{};
+    };
+
+    enum Register : uint8_t {
+        rax = 0,
+        rcx = 1,
+        rdx = 2,
+        rsi = 6,
+        rdi = 7,
+        xmm0 = 0,
+    };
+
+    enum Condition : uint8_t {
+        cc_b = 0x2,
+        cc_ae = 0x3,
+        cc_e = 0x4,
+        cc_ne = 0x5,
+        cc_a = 0x7,
+        cc_p = 0xA,
+        cc_l = 0xC,
+        cc_ge = 0xD,
+        cc_le = 0xE,
+        cc_g = 0xF,
+    };
+
+    /// Array 中 length 与 element 相对于对象起始位置的偏移
+    constexpr uint8_t array_length = sizeof(Object);
+    constexpr uint8_t array_element = sizeof(Object) + sizeof(int32_t);
+
+    /// 最简单的 x86-64 指令编码器，除数组元素与静态字段外内存操作数固定为 [rdi + disp32]，rdi 始终指向局部变量表
+    class Assembler {
+    public:
+        std::vector<uint8_t> code;
+
+        [[nodiscard]] size_t size() const { return code.size(); }
+
+        void emit(std::initializer_list<uint8_t> bytes) {
+            code.insert(code.end(), bytes);
+        }
+
+        void emit32(uint32_t value) {
+            for (int i = 0; i < 4; ++i) code.push_back(static_cast<uint8_t>(value >> (8 * i)));
+        }
+
+        void emit64(uint64_t value) {
+            for (int i = 0; i < 8; ++i) code.push_back(static_cast<uint8_t>(value >> (8 * i)));
+        }
+
+        void patch32(size_t position, int32_t value) {
+            for (int i = 0; i < 4; ++i) code[position + i] = static_cast<uint8_t>(static_cast<uint32_t>(value) >> (8 * i));
+        }
+
+        /// opcode reg, [rdi + disp]
+        void mem(std::initializer_list<uint8_t> opcode, uint8_t reg, int32_t disp) {
+            emit(opcode);
+            code.push_back(static_cast<uint8_t>(0x80 | (reg & 7) << 3 | 7));
+            emit32(static_cast<uint32_t>(disp));
+        }
+
+        /// opcode reg, [rax + rcx * (1 << scale) + sizeof(Array)]，用于访问数组元素
+        void element(std::initializer_list<uint8_t> opcode, uint8_t reg, uint8_t scale) {
+            emit(opcode);
+            code.push_back(static_cast<uint8_t>(0x40 | (reg & 7) << 3 | 4));
+            code.push_back(static_cast<uint8_t>(scale << 6 | rcx << 3 | rax));
+            code.push_back(static_cast<uint8_t>(sizeof(Array)));
+        }
+
+        /// jcc rel32，返回待回填的位置
+        size_t jcc(Condition condition) {
+            emit({0x0F, static_cast<uint8_t>(0x80 | condition)});
+            emit32(0);
+            return size() - 4;
+        }
+
+        /// jmp rel32，返回待回填的位置
+        size_t jmp() {
+            emit({0xE9});
+            emit32(0);
+            return size() - 4;
+        }
+
+        /// 将 rel32 指向当前位置
+        void bind(size_t position) {
+            patch32(position, static_cast<int32_t>(size() - (position + 4)));
+        }
+
+        void movImm32(uint8_t reg, uint32_t value) {
+            code.push_back(static_cast<uint8_t>(0xB8 + reg));
+            emit32(value);
+        }
+
+        void movImm64(uint8_t reg, uint64_t value) {
+            emit({0x48, static_cast<uint8_t>(0xB8 + reg)});
+            emit64(value);
+        }
+
+        /// mov eax, result; ret
+        void bail(uint32_t result) {
+            movImm32(rax, result);
+            emit({0xC3});
+        }
+    };
+
+    /// 位运算内建函数依赖的 CPU 特性，缺失时包含对应内建函数的方法不编译
+    struct CpuFeatures {
+        bool popcnt{};
+        bool lzcnt{};
+        bool bmi1{};
+
+        CpuFeatures() {
+            unsigned int eax, ebx, ecx, edx;
+            if (__get_cpuid(1, &eax, &ebx, &ecx, &edx)) popcnt = ecx & (1u << 23);
+            if (__get_cpuid(0x80000001, &eax, &ebx, &ecx, &edx)) lzcnt = ecx & (1u << 5);
+            if (__get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx)) bmi1 = ebx & (1u << 3);
+        }
+
+        static const CpuFeatures &get() {
+            static const CpuFeatures features;
+            return features;
+        }
+    };
+
+    bool in(uint16_t opcode, uint16_t first, uint16_t last) {
+        return opcode >= first && opcode <= last;
+    }
+
+    /// 指令是否可以编译，栈深度由链接阶段的类型推导给出
+    bool compilable(const Class &class_, const Instruction &insn, const std::vector<NativeMethod> &natives) {
+        auto opcode = baseOpcode(insn.opcode);
+        if (opcode == invokenative) return natives[insn.b].nothrow;
+        if (opcode == ldc || opcode == ldc_w) {
+            auto tag = class_.getConstant(insn.a).tag;
+            return tag == Class::integer_info || tag == Class::float_info;
+        }
+        if (opcode == frem || opcode == drem) return false;
+        auto &&cpu = CpuFeatures::get();
+        if (opcode == ipopcnt || opcode == lpopcnt) return cpu.popcnt;
+        if (opcode == iclz || opcode == lclz) return cpu.lzcnt;
+        if (opcode == ictz || opcode == lctz) return cpu.bmi1;
+        return in(opcode, nop, ldc2_w) || in(opcode, iload, aload) || in(opcode, iload_0, aload_3) ||
+               in(opcode, istore, astore) || in(opcode, istore_0, astore_3) || in(opcode, jvm::pop, if_acmpne) ||
+               opcode == goto_ || in(opcode, ireturn, return_) || opcode == invokevirtual || opcode == invokestatic ||
+               opcode == invokeinterface || opcode == ifnull ||
+               opcode == ifnonnull || opcode == end_of_code || in(opcode, irotl, lbswap) ||
+               in(opcode, iaload, saload) || (in(opcode, iastore, sastore) && opcode != aastore) ||
+               opcode == arraylength || opcode == tableswitch || opcode == lookupswitch || opcode == athrow ||
+               in(opcode, getstatic_byte, putstatic_ref);
+    }
+
+    /// 单个方法的代码生成
+    class Compiler {
+    public:
+        Compiler(const Class &class_, const Class::CodeInfo &code_info, const std::vector<NativeMethod> &natives,
+                 const std::atomic<bool> *safepoint)
+            : class_(class_), code_info(code_info), natives(natives), depths(code_info.type_map.depths),
+              safepoint(safepoint) {
+        }
+
+        std::vector<uint8_t> compile() {
+            auto &&instructions = code_info.instructions;
+            labels.assign(instructions.size(), 0);
+
+            // 入口：mov esi, esi; lea rax, [rip + table]; movsxd rcx, [rax + rsi * 4]; add rax, rcx; jmp rax
+            as.emit({0x89, 0xF6});
+            as.emit({0x48, 0x8D, 0x05});
+            as.emit32(0);
+            auto table_fixup = as.size() - 4;
+            as.emit({0x48, 0x63, 0x0C, 0xB0});
+            as.emit({0x48, 0x01, 0xC8});
+            as.emit({0xFF, 0xE0});
+
+            // 向后跳转的目标即为循环头部，在此检查安全点请求
+            std::vector<bool> loop_headers(instructions.size());
+            for (size_t i = 0; i < instructions.size(); ++i) {
+                auto opcode = baseOpcode(instructions[i].opcode);
+                auto target = instructions[i].a;
+                if ((in(opcode, ifeq, if_acmpne) || opcode == goto_ || opcode == ifnull || opcode == ifnonnull) &&
+                    target <= static_cast<int32_t>(i)) {
+                    loop_headers[target] = true;
+                }
+            }
+
+            for (size_t i = 0; i < instructions.size(); ++i) {
+                labels[i] = as.size();
+                if (depths[i] >= 0) {
+                    if (safepoint && loop_headers[i]) {
+                        // mov rax, flag; cmp byte [rax], 0; jne slow
+                        as.movImm64(rax, reinterpret_cast<uint64_t>(safepoint));
+                        as.emit({0x80, 0x38, 0x00});
+                        slowPath(as.jcc(cc_ne), i);
+                    }
+                    translate(i);
+                }
+            }
+
+            // 退回解释器的慢速路径
+            for (auto &&[position, index]: slow_paths) {
+                as.bind(position);
+                as.bail(result(index));
+            }
+
+            // 不可达的指令不应被进入
+            auto trap = as.size();
+            as.emit({0x0F, 0x0B});
+            for (size_t i = 0; i < instructions.size(); ++i) {
+                if (depths[i] < 0) labels[i] = trap;
+            }
+
+            for (auto &&[position, index]: branches) {
+                as.patch32(position, static_cast<int32_t>(labels[index] - (position + 4)));
+            }
+
+            // 跳转表，表项为目标相对于表起始位置的偏移
+            while (as.size() % 4) as.emit({0xCC});
+            auto table = as.size();
+            as.patch32(table_fixup, static_cast<int32_t>(table - (table_fixup + 4)));
+            for (auto &&label: labels) {
+                as.emit32(static_cast<uint32_t>(static_cast<int32_t>(label - table)));
+            }
+            return std::move(as.code);
+        }
+
+    private:
+        [[nodiscard]] uint32_t result(size_t index) const {
+            return static_cast<uint32_t>(depths[index]) << 16 | static_cast<uint32_t>(index);
+        }
+
+        [[nodiscard]] static int32_t local(int32_t index) {
+            return index * 8;
+        }
+
+        /// 操作数栈中第 position 个 Slot 的偏移
+        [[nodiscard]] int32_t stack(int32_t position) const {
+            return (code_info.max_locals + position) * 8;
+        }
+
+        void branch(size_t position, int32_t target) {
+            branches.emplace_back(position, static_cast<size_t>(target));
+        }
+
+        /// 跳转至 eax 指定的指令：mov esi, eax; jmp entry，由入口处的跳转表分派
+        void dispatchEax() {
+            as.emit({0x89, 0xC6});
+            auto position = as.jmp();
+            as.patch32(position, -static_cast<int32_t>(position + 4));
+        }
+
+        void slowPath(size_t position, size_t index) {
+            slow_paths.emplace_back(position, index);
+        }
+
+        void store32(int32_t disp, uint32_t value) {
+            as.mem({0xC7}, 0, disp);
+            as.emit32(value);
+        }
+
+        void store64(int32_t disp, uint64_t value) {
+            as.movImm64(rax, value);
+            as.mem({0x48, 0x89}, rax, disp);
+        }
+
+        void copy32(int32_t to, int32_t from) {
+            as.mem({0x8B}, rax, from);
+            as.mem({0x89}, rax, to);
+        }
+
+        void copy64(int32_t to, int32_t from) {
+            as.mem({0x48, 0x8B}, rax, from);
+            as.mem({0x48, 0x89}, rax, to);
+        }
+
+        /// 比较结果写入 disp，nan 为浮点数无序时的结果
+        void compareResult(int32_t disp, Condition greater, int32_t nan, bool floating) {
+            std::vector<size_t> done;
+            if (floating) {
+                as.movImm32(rax, static_cast<uint32_t>(nan));
+                done.push_back(as.jcc(cc_p));
+            }
+            as.movImm32(rax, 0);
+            done.push_back(as.jcc(cc_e));
+            as.movImm32(rax, 1);
+            done.push_back(as.jcc(greater));
+            as.movImm32(rax, static_cast<uint32_t>(-1));
+            for (auto &&position: done) as.bind(position);
+            as.mem({0x89}, rax, disp);
+        }
+
+        /// idiv、irem、ldiv、lrem，除数为 0 时退回解释器抛出异常，除数为 -1 时单独处理以避免溢出异常
+        void divide(size_t index, int32_t dividend, int32_t divisor, bool wide, bool remainder) {
+            if (wide) {
+                as.mem({0x48, 0x8B}, rcx, divisor);
+                as.emit({0x48, 0x85, 0xC9});
+            } else {
+                as.mem({0x8B}, rcx, divisor);
+                as.emit({0x85, 0xC9});
+            }
+            slowPath(as.jcc(cc_e), index);
+            if (wide) {
+                as.mem({0x48, 0x8B}, rax, dividend);
+                as.emit({0x48, 0x83, 0xF9, 0xFF});
+            } else {
+                as.mem({0x8B}, rax, dividend);
+                as.emit({0x83, 0xF9, 0xFF});
+            }
+            auto normal = as.jcc(cc_ne);
+            if (remainder) {
+                as.emit({0x31, 0xD2});
+            } else if (wide) {
+                as.emit({0x48, 0xF7, 0xD8});
+            } else {
+                as.emit({0xF7, 0xD8});
+            }
+            auto done = as.jmp();
+            as.bind(normal);
+            if (wide) {
+                as.emit({0x48, 0x99, 0x48, 0xF7, 0xF9});
+            } else {
+                as.emit({0x99, 0xF7, 0xF9});
+            }
+            as.bind(done);
+            auto reg = remainder ? rdx : rax;
+            if (wide) {
+                as.mem({0x48, 0x89}, reg, dividend);
+            } else {
+                as.mem({0x89}, reg, dividend);
+            }
+        }
+
+        /// 数组引用读入 rax，下标读入 rcx，数组为 null 或者下标越界时退回解释器抛出异常
+        void checkElement(size_t index, int32_t array, int32_t subscript) {
+            as.mem({0x48, 0x8B}, rax, array);
+            as.emit({0x48, 0x85, 0xC0});
+            slowPath(as.jcc(cc_e), index);
+            as.mem({0x48, 0x63}, rcx, subscript);
+            // cmp ecx, [rax + length]，按无符号数比较，负数同样越界
+            as.emit({0x3B, 0x48, array_length});
+            slowPath(as.jcc(cc_ae), index);
+        }
+
+        /// 复制栈顶 size 个 Slot 并插入到其下方 skip 个 Slot 之下
+        void duplicate(int32_t depth, int32_t size, int32_t skip) {
+            for (int32_t i = 0; i < size; ++i) copy64(stack(depth + i), stack(depth + i - size));
+            for (int32_t i = -1; i >= -skip; --i) copy64(stack(depth + i), stack(depth + i - size));
+            for (int32_t i = 0; i < size; ++i) copy64(stack(depth + i - skip - size), stack(depth + i));
+        }
+
+        /// f2i、f2l、d2i、d2l，结果为 integer indefinite 时可能是 NaN 或者溢出，退回解释器按照 Java 语义处理
+        void truncate(size_t index, int32_t disp, bool from_double, bool wide) {
+            auto prefix = static_cast<uint8_t>(from_double ? 0xF2 : 0xF3);
+            if (wide) {
+                as.mem({prefix, 0x48, 0x0F, 0x2C}, rax, disp);
+                as.movImm64(rcx, 0x8000000000000000);
+                as.emit({0x48, 0x39, 0xC8});
+            } else {
+                as.mem({prefix, 0x0F, 0x2C}, rax, disp);
+                as.emit({0x3D});
+                as.emit32(0x80000000);
+            }
+            slowPath(as.jcc(cc_e), index);
+            if (wide) {
+                as.mem({0x48, 0x89}, rax, disp);
+            } else {
+                as.mem({0x89}, rax, disp);
+            }
+        }
+
+        void translate(size_t index) {
+            auto &&insn = code_info.instructions[index];
+            auto opcode = baseOpcode(insn.opcode);
+            auto depth = depths[index];
+            // 栈顶向下的第 n 个 Slot
+            auto top = [&](int32_t n) { return stack(depth - n); };
+            static const uint8_t int_conditions[] = {cc_e, cc_ne, cc_l, cc_ge, cc_g, cc_le};
+
+            switch (opcode) {
+                case nop:
+                    break;
+                case aconst_null:
+                    as.mem({0x48, 0xC7}, 0, top(0));
+                    as.emit32(0);
+                    break;
+                case iconst_m1:
+                case iconst_0:
+                case iconst_1:
+                case iconst_2:
+                case iconst_3:
+                case iconst_4:
+                case iconst_5:
+                    store32(top(0), static_cast<uint32_t>(opcode - iconst_0));
+                    break;
+                case lconst_0:
+                case lconst_1:
+                    store64(top(0), static_cast<uint64_t>(opcode - lconst_0));
+                    break;
+                case fconst_0:
+                case fconst_1:
+                case fconst_2: {
+                    auto value = static_cast<float>(opcode - fconst_0);
+                    uint32_t bits;
+                    memcpy(&bits, &value, 4);
+                    store32(top(0), bits);
+                    break;
+                }
+                case dconst_0:
+                case dconst_1: {
+                    auto value = static_cast<double>(opcode - dconst_0);
+                    uint64_t bits;
+                    memcpy(&bits, &value, 8);
+                    store64(top(0), bits);
+                    break;
+                }
+                case bipush:
+                case sipush:
+                    store32(top(0), static_cast<uint32_t>(insn.a));
+                    break;
+                case ldc:
+                case ldc_w: {
+                    uint32_t bits;
+                    memcpy(&bits, &class_.getConstant(insn.a).value, 4);
+                    store32(top(0), bits);
+                    break;
+                }
+                case ldc2_w: {
+                    uint64_t bits;
+                    memcpy(&bits, &class_.getConstant(insn.a).value, 8);
+                    store64(top(0), bits);
+                    break;
+                }
+                case iload:
+                case fload:
+                case iload_0:
+                case iload_1:
+                case iload_2:
+                case iload_3:
+                case fload_0:
+                case fload_1:
+                case fload_2:
+                case fload_3:
+                    copy32(top(0), local(insn.a));
+                    break;
+                case lload:
+                case dload:
+                case lload_0:
+                case lload_1:
+                case lload_2:
+                case lload_3:
+                case dload_0:
+                case dload_1:
+                case dload_2:
+                case dload_3:
+                case aload:
+                case aload_0:
+                case aload_1:
+                case aload_2:
+                case aload_3:
+                    copy64(top(0), local(insn.a));
+                    break;
+                case istore:
+                case fstore:
+                case istore_0:
+                case istore_1:
+                case istore_2:
+                case istore_3:
+                case fstore_0:
+                case fstore_1:
+                case fstore_2:
+                case fstore_3:
+                    copy32(local(insn.a), top(1));
+                    break;
+                case lstore:
+                case dstore:
+                case lstore_0:
+                case lstore_1:
+                case lstore_2:
+                case lstore_3:
+                case dstore_0:
+                case dstore_1:
+                case dstore_2:
+                case dstore_3:
+                    copy64(local(insn.a), top(2));
+                    break;
+                case astore:
+                case astore_0:
+                case astore_1:
+                case astore_2:
+                case astore_3:
+                    copy64(local(insn.a), top(1));
+                    break;
+                case jvm::pop:
+                case pop2:
+                    break;
+                case jvm::dup:
+                    duplicate(depth, 1, 0);
+                    break;
+                case dup_x1:
+                    duplicate(depth, 1, 1);
+                    break;
+                case dup_x2:
+                    duplicate(depth, 1, 2);
+                    break;
+                case jvm::dup2:
+                    duplicate(depth, 2, 0);
+                    break;
+                case dup2_x1:
+                    duplicate(depth, 2, 1);
+                    break;
+                case dup2_x2:
+                    duplicate(depth, 2, 2);
+                    break;
+                case swap:
+                    as.mem({0x48, 0x8B}, rax, top(1));
+                    as.mem({0x48, 0x8B}, rcx, top(2));
+                    as.mem({0x48, 0x89}, rcx, top(1));
+                    as.mem({0x48, 0x89}, rax, top(2));
+                    break;
+                case iadd:
+                case isub:
+                case imul:
+                    as.mem({0x8B}, rax, top(2));
+                    if (opcode == iadd) as.mem({0x03}, rax, top(1));
+                    else if (opcode == isub) as.mem({0x2B}, rax, top(1));
+                    else as.mem({0x0F, 0xAF}, rax, top(1));
+                    as.mem({0x89}, rax, top(2));
+                    break;
+                case ladd:
+                case lsub:
+                case lmul:
+                    as.mem({0x48, 0x8B}, rax, top(4));
+                    if (opcode == ladd) as.mem({0x48, 0x03}, rax, top(2));
+                    else if (opcode == lsub) as.mem({0x48, 0x2B}, rax, top(2));
+                    else as.mem({0x48, 0x0F, 0xAF}, rax, top(2));
+                    as.mem({0x48, 0x89}, rax, top(4));
+                    break;
+                case fadd:
+                case fsub:
+                case fmul:
+                case fdiv: {
+                    static const uint8_t operations[] = {0x58, 0x5C, 0x59, 0x5E};
+                    as.mem({0xF3, 0x0F, 0x10}, xmm0, top(2));
+                    as.mem({0xF3, 0x0F, operations[(opcode - fadd) / 4]}, xmm0, top(1));
+                    as.mem({0xF3, 0x0F, 0x11}, xmm0, top(2));
+                    break;
+                }
+                case dadd:
+                case dsub:
+                case dmul:
+                case ddiv: {
+                    static const uint8_t operations[] = {0x58, 0x5C, 0x59, 0x5E};
+                    as.mem({0xF2, 0x0F, 0x10}, xmm0, top(4));
+                    as.mem({0xF2, 0x0F, operations[(opcode - dadd) / 4]}, xmm0, top(2));
+                    as.mem({0xF2, 0x0F, 0x11}, xmm0, top(4));
+                    break;
+                }
+                case idiv:
+                case irem:
+                    divide(index, top(2), top(1), false, opcode == irem);
+                    break;
+                case jvm::ldiv:
+                case lrem:
+                    divide(index, top(4), top(2), true, opcode == lrem);
+                    break;
+                case ineg:
+                    as.mem({0xF7}, 3, top(1));
+                    break;
+                case lneg:
+                    as.mem({0x48, 0xF7}, 3, top(2));
+                    break;
+                case fneg:
+                    // 翻转符号位
+                    as.mem({0x80}, 6, top(1) + 3);
+                    as.emit({0x80});
+                    break;
+                case dneg:
+                    as.mem({0x80}, 6, top(2) + 7);
+                    as.emit({0x80});
+                    break;
+                case ishl:
+                case ishr:
+                case iushr: {
+                    // shl、sar、shr，移位距离由 cl 给出，硬件同样只取低 5 位或低 6 位
+                    static const uint8_t extensions[] = {4, 7, 5};
+                    as.mem({0x8B}, rcx, top(1));
+                    as.mem({0xD3}, extensions[(opcode - ishl) / 2], top(2));
+                    break;
+                }
+                case lshl:
+                case lshr:
+                case lushr: {
+                    static const uint8_t extensions[] = {4, 7, 5};
+                    as.mem({0x8B}, rcx, top(1));
+                    as.mem({0x48, 0xD3}, extensions[(opcode - lshl) / 2], top(3));
+                    break;
+                }
+                case iand:
+                case ior:
+                case ixor: {
+                    static const uint8_t operations[] = {0x23, 0x0B, 0x33};
+                    as.mem({0x8B}, rax, top(1));
+                    as.mem({operations[(opcode - iand) / 2]}, rax, top(2));
+                    as.mem({0x89}, rax, top(2));
+                    break;
+                }
+                case land:
+                case lor:
+                case lxor: {
+                    static const uint8_t operations[] = {0x23, 0x0B, 0x33};
+                    as.mem({0x48, 0x8B}, rax, top(2));
+                    as.mem({0x48, operations[(opcode - land) / 2]}, rax, top(4));
+                    as.mem({0x48, 0x89}, rax, top(4));
+                    break;
+                }
+                case i2l:
+                    as.mem({0x48, 0x63}, rax, top(1));
+                    as.mem({0x48, 0x89}, rax, top(1));
+                    break;
+                case i2f:
+                    as.mem({0xF3, 0x0F, 0x2A}, xmm0, top(1));
+                    as.mem({0xF3, 0x0F, 0x11}, xmm0, top(1));
+                    break;
+                case i2d:
+                    as.mem({0xF2, 0x0F, 0x2A}, xmm0, top(1));
+                    as.mem({0xF2, 0x0F, 0x11}, xmm0, top(1));
+                    break;
+                case l2i:
+                    // 低 32 位即为结果，原地保留
+                    break;
+                case l2f:
+                    as.mem({0xF3, 0x48, 0x0F, 0x2A}, xmm0, top(2));
+                    as.mem({0xF3, 0x0F, 0x11}, xmm0, top(2));
+                    break;
+                case l2d:
+                    as.mem({0xF2, 0x48, 0x0F, 0x2A}, xmm0, top(2));
+                    as.mem({0xF2, 0x0F, 0x11}, xmm0, top(2));
+                    break;
+                case f2i:
+                    truncate(index, top(1), false, false);
+                    break;
+                case f2l:
+                    truncate(index, top(1), false, true);
+                    break;
+                case f2d:
+                    as.mem({0xF3, 0x0F, 0x5A}, xmm0, top(1));
+                    as.mem({0xF2, 0x0F, 0x11}, xmm0, top(1));
+                    break;
+                case d2i:
+                    truncate(index, top(2), true, false);
+                    break;
+                case d2l:
+                    truncate(index, top(2), true, true);
+                    break;
+                case d2f:
+                    as.mem({0xF2, 0x0F, 0x5A}, xmm0, top(2));
+                    as.mem({0xF3, 0x0F, 0x11}, xmm0, top(2));
+                    break;
+                case i2b:
+                case i2c:
+                case i2s: {
+                    static const uint8_t extensions[] = {0xBE, 0xB7, 0xBF};
+                    as.mem({0x0F, extensions[opcode - i2b]}, rax, top(1));
+                    as.mem({0x89}, rax, top(1));
+                    break;
+                }
+                case iinc:
+                    as.mem({0x81}, 0, local(insn.a));
+                    as.emit32(static_cast<uint32_t>(insn.b));
+                    break;
+                case lcmp:
+                    as.mem({0x48, 0x8B}, rax, top(4));
+                    as.mem({0x48, 0x3B}, rax, top(2));
+                    compareResult(top(4), cc_g, 0, false);
+                    break;
+                case fcmpl:
+                case fcmpg:
+                    as.mem({0xF3, 0x0F, 0x10}, xmm0, top(2));
+                    as.mem({0x0F, 0x2E}, xmm0, top(1));
+                    compareResult(top(2), cc_a, opcode == fcmpl ? -1 : 1, true);
+                    break;
+                case dcmpl:
+                case dcmpg:
+                    as.mem({0xF2, 0x0F, 0x10}, xmm0, top(4));
+                    as.mem({0x66, 0x0F, 0x2E}, xmm0, top(2));
+                    compareResult(top(4), cc_a, opcode == dcmpl ? -1 : 1, true);
+                    break;
+                case ifeq:
+                case ifne:
+                case iflt:
+                case ifge:
+                case ifgt:
+                case ifle:
+                    as.mem({0x83}, 7, top(1));
+                    as.emit({0x00});
+                    branch(as.jcc(static_cast<Condition>(int_conditions[opcode - ifeq])), insn.a);
+                    break;
+                case if_icmpeq:
+                case if_icmpne:
+                case if_icmplt:
+                case if_icmpge:
+                case if_icmpgt:
+                case if_icmple:
+                    as.mem({0x8B}, rax, top(2));
+                    as.mem({0x3B}, rax, top(1));
+                    branch(as.jcc(static_cast<Condition>(int_conditions[opcode - if_icmpeq])), insn.a);
+                    break;
+                case if_acmpeq:
+                case if_acmpne:
+                    as.mem({0x48, 0x8B}, rax, top(2));
+                    as.mem({0x48, 0x3B}, rax, top(1));
+                    branch(as.jcc(opcode == if_acmpeq ? cc_e : cc_ne), insn.a);
+                    break;
+                case ifnull:
+                case ifnonnull:
+                    as.mem({0x48, 0x83}, 7, top(1));
+                    as.emit({0x00});
+                    branch(as.jcc(opcode == ifnull ? cc_e : cc_ne), insn.a);
+                    break;
+                case goto_:
+                    branch(as.jmp(), insn.a);
+                    break;
+                case ipopcnt:
+                case iclz:
+                case ictz:
+                case lpopcnt:
+                case lclz:
+                case lctz: {
+                    // popcnt、lzcnt、tzcnt，对 0 的结果与 Java 一致，无需特殊处理
+                    static const uint8_t operations[] = {0xB8, 0xBD, 0xBC};
+                    auto wide = opcode == lpopcnt || opcode == lclz || opcode == lctz;
+                    auto operation = operations[(opcode - ipopcnt) / 2];
+                    if (wide) {
+                        as.mem({0xF3, 0x48, 0x0F, operation}, rax, top(2));
+                        as.mem({0x89}, rax, top(2));
+                    } else {
+                        as.mem({0xF3, 0x0F, operation}, rax, top(1));
+                        as.mem({0x89}, rax, top(1));
+                    }
+                    break;
+                }
+                case irotl:
+                case irotr:
+                    // rol、ror
+                    as.mem({0x8B}, rcx, top(1));
+                    as.mem({0xD3}, opcode == irotl ? 0 : 1, top(2));
+                    break;
+                case lrotl:
+                case lrotr:
+                    as.mem({0x8B}, rcx, top(1));
+                    as.mem({0x48, 0xD3}, opcode == lrotl ? 0 : 1, top(3));
+                    break;
+                case ibswap:
+                    as.mem({0x8B}, rax, top(1));
+                    as.emit({0x0F, 0xC8});
+                    as.mem({0x89}, rax, top(1));
+                    break;
+                case lbswap:
+                    as.mem({0x48, 0x8B}, rax, top(2));
+                    as.emit({0x48, 0x0F, 0xC8});
+                    as.mem({0x48, 0x89}, rax, top(2));
+                    break;
+                case invokenative: {
+                    // 入口处 rsp 按 16 字节对齐后偏移 8，保存 rdi 后恰好满足调用约定的对齐要求：
+                    // push rdi; lea rdi, [rdi + args]; mov rax, function; call rax; pop rdi
+                    auto &&method = natives[insn.b];
+                    as.emit({0x57});
+                    as.mem({0x48, 0x8D}, rdi, top(method.args_slots));
+                    as.movImm64(rax, reinterpret_cast<uint64_t>(method.function));
+                    as.emit({0xFF, 0xD0});
+                    as.emit({0x5F});
+                    break;
+                }
+                case tableswitch: {
+                    // mov eax, key; sub eax, low; cmp eax, count; jae default; mov rcx, targets; mov eax, [rcx + rax * 4]
+                    auto table = code_info.switch_tables.data() + insn.c;
+                    as.mem({0x8B}, rax, top(1));
+                    as.emit({0x2D});
+                    as.emit32(static_cast<uint32_t>(insn.b));
+                    as.emit({0x3D});
+                    as.emit32(static_cast<uint32_t>(table[0]));
+                    branch(as.jcc(cc_ae), insn.a);
+                    as.movImm64(rcx, reinterpret_cast<uint64_t>(table + 1));
+                    as.emit({0x8B, 0x04, 0x81});
+                    dispatchEax();
+                    break;
+                }
+                case lookupswitch:
+                    // push rdi; mov esi, key; mov rdi, table; mov edx, default; call lookupSwitch; pop rdi
+                    as.emit({0x57});
+                    as.mem({0x8B}, rsi, top(1));
+                    as.movImm64(rdi, reinterpret_cast<uint64_t>(code_info.switch_tables.data() + insn.c));
+                    as.movImm32(rdx, static_cast<uint32_t>(insn.a));
+                    as.movImm64(rax, reinterpret_cast<uint64_t>(&lookupSwitch));
+                    as.emit({0xFF, 0xD0});
+                    as.emit({0x5F});
+                    dispatchEax();
+                    break;
+                case arraylength:
+                    as.mem({0x48, 0x8B}, rax, top(1));
+                    as.emit({0x48, 0x85, 0xC0});
+                    slowPath(as.jcc(cc_e), index);
+                    as.emit({0x8B, 0x40, array_length});
+                    as.mem({0x89}, rax, top(1));
+                    break;
+                case iaload:
+                case faload:
+                    checkElement(index, top(2), top(1));
+                    as.element({0x8B}, rax, 2);
+                    as.mem({0x89}, rax, top(2));
+                    break;
+                case laload:
+                case daload:
+                case aaload:
+                    checkElement(index, top(2), top(1));
+                    as.element({0x48, 0x8B}, rax, 3);
+                    as.mem({0x48, 0x89}, rax, top(2));
+                    break;
+                case baload:
+                case caload:
+                case saload: {
+                    // movsx、movzx、movsx
+                    static const uint8_t operations[] = {0xBE, 0xB7, 0xBF};
+                    checkElement(index, top(2), top(1));
+                    as.element({0x0F, operations[opcode - baload]}, rax, opcode == baload ? 0 : 1);
+                    as.mem({0x89}, rax, top(2));
+                    break;
+                }
+                case iastore:
+                case fastore:
+                    checkElement(index, top(3), top(2));
+                    as.mem({0x8B}, rdx, top(1));
+                    as.element({0x89}, rdx, 2);
+                    break;
+                case lastore:
+                case dastore:
+                    checkElement(index, top(4), top(3));
+                    as.mem({0x48, 0x8B}, rdx, top(2));
+                    as.element({0x48, 0x89}, rdx, 3);
+                    break;
+                case bastore:
+                    checkElement(index, top(3), top(2));
+                    as.mem({0x8B}, rdx, top(1));
+                    // boolean 数组只保留最低位：cmp byte [rax + element], t_boolean; jne 1f; and edx, 1; 1:
+                    as.emit({0x80, 0x78, array_element, Array::t_boolean, 0x75, 0x03, 0x83, 0xE2, 0x01});
+                    as.element({0x88}, rdx, 0);
+                    break;
+                case castore:
+                case sastore:
+                    checkElement(index, top(3), top(2));
+                    as.mem({0x8B}, rdx, top(1));
+                    as.element({0x66, 0x89}, rdx, 1);
+                    break;
+                case getstatic_byte:
+                case getstatic_char:
+                case getstatic_short: {
+                    // movsx、movzx、movsx edx, [rax]
+                    static const uint8_t operations[] = {0xBE, 0xB7, 0xBF};
+                    as.movImm64(rax, reinterpret_cast<uint64_t>(staticAddress(insn)));
+                    as.emit({0x0F, operations[opcode - getstatic_byte], 0x10});
+                    as.mem({0x89}, rdx, top(0));
+                    break;
+                }
+                case getstatic_int:
+                    as.movImm64(rax, reinterpret_cast<uint64_t>(staticAddress(insn)));
+                    as.emit({0x8B, 0x10});
+                    as.mem({0x89}, rdx, top(0));
+                    break;
+                case getstatic_long:
+                case getstatic_ref:
+                    as.movImm64(rax, reinterpret_cast<uint64_t>(staticAddress(insn)));
+                    as.emit({0x48, 0x8B, 0x10});
+                    as.mem({0x48, 0x89}, rdx, top(0));
+                    break;
+                case putstatic_boolean:
+                case putstatic_byte:
+                    as.mem({0x8B}, rdx, top(1));
+                    // boolean 只保留最低位：and edx, 1
+                    if (opcode == putstatic_boolean) as.emit({0x83, 0xE2, 0x01});
+                    as.movImm64(rax, reinterpret_cast<uint64_t>(staticAddress(insn)));
+                    as.emit({0x88, 0x10});
+                    break;
+                case putstatic_short:
+                    as.mem({0x8B}, rdx, top(1));
+                    as.movImm64(rax, reinterpret_cast<uint64_t>(staticAddress(insn)));
+                    as.emit({0x66, 0x89, 0x10});
+                    break;
+                case putstatic_int:
+                    as.mem({0x8B}, rdx, top(1));
+                    as.movImm64(rax, reinterpret_cast<uint64_t>(staticAddress(insn)));
+                    as.emit({0x89, 0x10});
+                    break;
+                case putstatic_long:
+                case putstatic_ref:
+                    as.mem({0x48, 0x8B}, rdx, top(opcode == putstatic_long ? 2 : 1));
+                    as.movImm64(rax, reinterpret_cast<uint64_t>(staticAddress(insn)));
+                    as.emit({0x48, 0x89, 0x10});
+                    break;
+                default:
+                    // 方法调用、athrow、返回指令与 end_of_code 交由解释器执行，虚方法调用在解释器中经过内联缓存派发
+                    as.bail(result(index));
+                    break;
+            }
+        }
+
+        const Class &class_;
+        const Class::CodeInfo &code_info;
+        const std::vector<NativeMethod> &natives;
+        const std::vector<int32_t> &depths;
+        const std::atomic<bool> *safepoint;
+        Assembler as;
+        std::vector<size_t> labels;
+        /// rel32 位置与目标指令下标
+        std::vector<std::pair<size_t, size_t> > branches;
+        std::vector<std::pair<size_t, size_t> > slow_paths;
+    };
+}
+
+bool jvm::Jit::supported() {
+    return true;
+}
+
+bool jvm::Jit::compile(const Class &class_, Class::CodeInfo &code_info, const std::vector<NativeMethod> &natives,
+                       const std::atomic<bool> *safepoint) {
+    code_info.native = nullptr;
+    auto &&depths = code_info.type_map.depths;
+    for (size_t i = 0; i < code_info.instructions.size(); ++i) {
+        if (depths[i] >= 0 && !compilable(class_, code_info.instructions[i], natives)) return false;
+    }
+    auto code = Compiler(class_, code_info, natives, safepoint).compile();
+    auto address = CodeCache::install(code);
+    if (address == nullptr) return false;
+    code_info.native = reinterpret_cast<Class::CodeInfo::NativeCode>(address);
+    return true;
+}
+
+#else
+
+bool jvm::Jit::supported() {
+    return false;
+}
+
+bool jvm::Jit::compile(const Class &, Class::CodeInfo &code_info, const std::vector<NativeMethod> &,
+                       const std::atomic<bool> *) {
+    code_info.native = nullptr;
+    return false;
+}
+
+#endif
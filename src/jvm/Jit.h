@@ -0,0 +1,30 @@
+#pragma once
+
+#include <jvm/Class.h>
+#include <jvm/Native.h>
+
+#include <atomic>
+
+#if defined(__x86_64__) && defined(__linux__)
+#define JVM_JIT_SUPPORTED
+#endif
+
+namespace jvm {
+    /// 基线模板 JIT，将方法的预解码指令逐条翻译为 x86-64 机器码
+    /// @note 编译后的代码与解释器共用栈帧布局，操作数栈保存在帧内存中且每条指令处的栈深度在编译期确定，
+    /// 因此可以在任意指令边界进入或者退出编译后的代码。方法调用、返回以及需要抛出异常的路径
+    /// 均退回解释器执行；编译后的代码只会直接调用保证不抛出异常的本地方法，不会有 C++ 异常穿过。
+    /// 循环头部检查安全点请求，请求存在时退回解释器暂停
+    class Jit {
+    public:
+        /// 当前平台是否支持 JIT
+        static bool supported();
+
+        /// 尝试编译方法并写入 code_info.native
+        /// @note 依赖链接阶段类型推导得到的栈深度，需要在 Verifier::verify 之后调用
+        /// @param safepoint 安全点请求标志，需要在编译后的代码的整个生命周期内保持有效，为空时不检查
+        /// @return 方法包含暂不支持的指令或者代码缓存耗尽时返回 false，方法保持解释执行
+        static bool compile(const Class &class_, Class::CodeInfo &code_info, const std::vector<NativeMethod> &natives,
+                            const std::atomic<bool> *safepoint);
+    };
+}
@@ -0,0 +1,22 @@
+#pragma once
+
+#include <jvm/Slot.h>
+
+#include <cstdint>
+
+namespace jvm {
+    /// 以 C++ 函数实现的静态方法
+    /// @param args 参数按照从左到右的顺序依次存放，long/double 占用两个 Slot，返回值写入起始位置
+    using NativeFunction = void (*)(Slot *args);
+
+    /// 已注册的本地方法
+    struct NativeMethod {
+        NativeFunction function{};
+        /// 参数占用的 Slot 数量
+        uint16_t args_slots{};
+        /// 返回值占用的 Slot 数量，void 为 0
+        uint16_t return_slots{};
+        /// 保证不抛出异常，JIT 编译的代码只会直接调用这样的本地方法
+        bool nothrow{};
+    };
+}
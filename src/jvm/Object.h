@@ -0,0 +1,72 @@
+#pragma once
+
+#include <cstdint>
+
+namespace jvm {
+    class Class;
+
+    /// 堆中对象的对象头，实例字段紧随其后，按照链接时计算的偏移直接访问
+    /// @note 老年代中的空闲块同样以对象头开始，以 free 标志区分
+    struct Object {
+        /// 新生代对象的存活次数，达到晋升年龄后复制到老年代
+        static constexpr uint32_t age_mask = 0xF;
+        /// 已被复制，class_ 中保存的是新的地址
+        static constexpr uint32_t forwarded = 0x10;
+        /// 老年代标记阶段已访问
+        static constexpr uint32_t marked = 0x20;
+        /// 对象头之后为 Array 的其余部分，复制时保留
+        static constexpr uint32_t array = 0x40;
+        /// 老年代中的空闲块
+        static constexpr uint32_t free = 0x80;
+
+        Class *class_;
+        /// 对象占用的字节数，包括对象头，按 8 字节对齐
+        uint32_t size;
+        /// 垃圾收集器使用的标志位
+        uint32_t flags;
+    };
+
+    static_assert(sizeof(Object) == 16, "Object header should stay compact");
+
+    /// 数组的对象头，元素按照本机类型连续存放在其后，class_ 为空
+    /// @note 对象头大小为 8 的倍数，因此任意元素类型都是自然对齐的
+    struct Array : Object {
+        /// 元素类型，原始类型的取值与 newarray 指令的 atype 操作数一致
+        enum Element : uint8_t {
+            t_boolean = 4,
+            t_char = 5,
+            t_float = 6,
+            t_double = 7,
+            t_byte = 8,
+            t_short = 9,
+            t_int = 10,
+            t_long = 11,
+            /// 对象与数组
+            t_reference = 12
+        };
+
+        int32_t length;
+        Element element;
+
+        /// 每个元素占用的字节数，boolean 按一个字节存放
+        static constexpr uint32_t elementSize(Element element) {
+            switch (element) {
+                case t_boolean:
+                case t_byte:
+                    return 1;
+                case t_char:
+                case t_short:
+                    return 2;
+                case t_float:
+                case t_int:
+                    return 4;
+                default:
+                    return 8;
+            }
+        }
+
+        [[nodiscard]] uint8_t *data() { return reinterpret_cast<uint8_t *>(this + 1); }
+    };
+
+    static_assert(sizeof(Array) == 24, "Array header should keep elements 8-byte aligned");
+}
@@ -210,4 +210,7 @@ namespace jvm {
         impdep1 = 0xFE,
         impdep2 = 0xFF
     };
+
+    /// 获取字节码助记符，未定义的字节码返回 "unknown"
+    const char *opcodeName(uint8_t opcode);
 }
@@ -0,0 +1,166 @@
+#include "OpcodeProfile.h"
+#include "Opcode.h"
+
+#include <algorithm>
+#include <cinttypes>
+#include <cstdio>
+#include <tuple>
+
+namespace {
+    /// 写入 JSON 字符串，转义引号、反斜杠与控制字符
+    void writeString(sese::io::OutputStream *output, std::string_view value) {
+        std::string result = "\"";
+        for (auto ch: value) {
+            if (ch == '"' || ch == '\\') {
+                result.push_back('\\');
+                result.push_back(ch);
+            } else if (static_cast<unsigned char>(ch) < 0x20) {
+                char escaped[8];
+                std::snprintf(escaped, sizeof(escaped), "\\u%04x", ch);
+                result.append(escaped);
+            } else {
+                result.push_back(ch);
+            }
+        }
+        result.push_back('"');
+        output->write(result.data(), result.size());
+    }
+
+    void writeText(sese::io::OutputStream *output, std::string_view text) {
+        output->write(text.data(), text.size());
+    }
+
+    void writeCount(sese::io::OutputStream *output, uint64_t count) {
+        char buffer[32];
+        auto length = std::snprintf(buffer, sizeof(buffer), "%" PRIu64, count);
+        output->write(buffer, length);
+    }
+}
+
+jvm::OpcodeProfile::OpcodeProfile() : counts(256), pairs(256 * 256) {
+}
+
+std::vector<jvm::OpcodeProfile::Pair> jvm::OpcodeProfile::topPairs(size_t limit) const {
+    std::vector<Pair> result;
+    for (uint32_t i = 0; i < pairs.size(); ++i) {
+        if (pairs[i] == 0) continue;
+        result.push_back({static_cast<uint8_t>(i >> 8), static_cast<uint8_t>(i & 0xFF), pairs[i]});
+    }
+    std::sort(result.begin(), result.end(), [](const Pair &lhs, const Pair &rhs) {
+        return lhs.count > rhs.count;
+    });
+    if (result.size() > limit) result.resize(limit);
+    return result;
+}
+
+std::vector<jvm::OpcodeProfile::Triple> jvm::OpcodeProfile::topTriples(size_t limit) const {
+    std::vector<Triple> result;
+    result.reserve(triples.size());
+    for (auto &&[key, count]: triples) {
+        result.push_back({static_cast<uint8_t>(key >> 16), static_cast<uint8_t>(key >> 8 & 0xFF),
+                          static_cast<uint8_t>(key & 0xFF), count});
+    }
+    // 次数相同时按序列排序，保证输出稳定
+    std::sort(result.begin(), result.end(), [](const Triple &lhs, const Triple &rhs) {
+        if (lhs.count != rhs.count) return lhs.count > rhs.count;
+        return std::tie(lhs.first, lhs.second, lhs.third) < std::tie(rhs.first, rhs.second, rhs.third);
+    });
+    if (result.size() > limit) result.resize(limit);
+    return result;
+}
+
+std::vector<jvm::OpcodeProfile::Call> jvm::OpcodeProfile::calls() const {
+    std::map<std::string, uint64_t> targets;
+    for (auto &&[site, count]: call_sites) {
+        auto ref = site.first->getMemberRef(site.second);
+        targets[std::string(ref.class_name) + "." + std::string(ref.name) + std::string(ref.descriptor)] += count;
+    }
+    std::vector<Call> result;
+    result.reserve(targets.size());
+    for (auto &&[target, count]: targets) {
+        result.push_back({target, count});
+    }
+    std::stable_sort(result.begin(), result.end(), [](const Call &lhs, const Call &rhs) {
+        return lhs.count > rhs.count;
+    });
+    return result;
+}
+
+void jvm::OpcodeProfile::dump(sese::io::OutputStream *output, size_t limit) const {
+    char line[128];
+    for (auto &&pair: topPairs(limit)) {
+        auto length = std::snprintf(line, sizeof(line), "%" PRIu64 " %s %s\n",
+                                    pair.count, opcodeName(pair.first), opcodeName(pair.second));
+        output->write(line, length);
+    }
+}
+
+void jvm::OpcodeProfile::dumpJson(sese::io::OutputStream *output, size_t limit) const {
+    writeText(output, "{\n  \"bytecodes\": ");
+    writeCount(output, total);
+    char buffer[64];
+    auto length = std::snprintf(buffer, sizeof(buffer), ",\n  \"average_stack_depth\": %.3f", averageStackDepth());
+    output->write(buffer, length);
+
+    // 字节码按执行次数降序排列，未执行的省略
+    std::vector<uint8_t> opcodes;
+    for (uint32_t i = 0; i < counts.size(); ++i) {
+        if (counts[i]) opcodes.push_back(static_cast<uint8_t>(i));
+    }
+    std::stable_sort(opcodes.begin(), opcodes.end(), [this](uint8_t lhs, uint8_t rhs) {
+        return counts[lhs] > counts[rhs];
+    });
+    writeText(output, ",\n  \"opcodes\": {");
+    for (size_t i = 0; i < opcodes.size(); ++i) {
+        writeText(output, i ? ",\n    " : "\n    ");
+        writeString(output, opcodeName(opcodes[i]));
+        writeText(output, ": ");
+        writeCount(output, counts[opcodes[i]]);
+    }
+    writeText(output, opcodes.empty() ? "}" : "\n  }");
+
+    auto writeSequence = [output](std::initializer_list<uint8_t> sequence, uint64_t count, bool first) {
+        writeText(output, first ? "\n    {\"opcodes\": [" : ",\n    {\"opcodes\": [");
+        for (auto iter = sequence.begin(); iter != sequence.end(); ++iter) {
+            if (iter != sequence.begin()) writeText(output, ", ");
+            writeString(output, opcodeName(*iter));
+        }
+        writeText(output, "], \"count\": ");
+        writeCount(output, count);
+        writeText(output, "}");
+    };
+    auto pairs = topPairs(limit);
+    writeText(output, ",\n  \"bigrams\": [");
+    for (size_t i = 0; i < pairs.size(); ++i) {
+        writeSequence({pairs[i].first, pairs[i].second}, pairs[i].count, i == 0);
+    }
+    writeText(output, pairs.empty() ? "]" : "\n  ]");
+    auto triples = topTriples(limit);
+    writeText(output, ",\n  \"trigrams\": [");
+    for (size_t i = 0; i < triples.size(); ++i) {
+        writeSequence({triples[i].first, triples[i].second, triples[i].third}, triples[i].count, i == 0);
+    }
+    writeText(output, triples.empty() ? "]" : "\n  ]");
+
+    auto targets = calls();
+    writeText(output, ",\n  \"invokestatic\": [");
+    for (size_t i = 0; i < targets.size(); ++i) {
+        writeText(output, i ? ",\n    {\"target\": " : "\n    {\"target\": ");
+        writeString(output, targets[i].target);
+        writeText(output, ", \"count\": ");
+        writeCount(output, targets[i].count);
+        writeText(output, "}");
+    }
+    writeText(output, targets.empty() ? "]\n}\n" : "\n  ]\n}\n");
+}
+
+void jvm::OpcodeProfile::clear() {
+    std::fill(counts.begin(), counts.end(), 0);
+    std::fill(pairs.begin(), pairs.end(), 0);
+    triples.clear();
+    call_sites.clear();
+    previous = 0;
+    previous2 = 0;
+    total = 0;
+    depths = 0;
+}
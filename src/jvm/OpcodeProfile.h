@@ -0,0 +1,104 @@
+#pragma once
+
+#include <jvm/Class.h>
+
+#include <sese/io/OutputStream.h>
+
+#include <cstdint>
+#include <map>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace jvm {
+    /// 字节码执行频率统计，记录单条字节码、相邻两条与三条字节码的执行次数、执行时的操作数栈深度
+    /// 以及各个 invokestatic 调用目标的调用次数，用于评估与调整加载期融合的超级指令集合与特化
+    class OpcodeProfile {
+    public:
+        /// 相邻执行的字节码对
+        struct Pair {
+            uint8_t first;
+            uint8_t second;
+            uint64_t count;
+        };
+
+        /// 相邻执行的三条字节码
+        struct Triple {
+            uint8_t first;
+            uint8_t second;
+            uint8_t third;
+            uint64_t count;
+        };
+
+        /// invokestatic 的调用目标，包括替换为内建函数与本地方法的调用
+        struct Call {
+            /// "类名.方法名描述符"
+            std::string target;
+            uint64_t count;
+        };
+
+        OpcodeProfile();
+
+        /// 记录一次字节码执行，由解释器调用
+        /// @param depth 执行前操作数栈占用的 Slot 数量
+        void record(uint8_t opcode, uint32_t depth) {
+            ++counts[opcode];
+            ++pairs[previous << 8 | opcode];
+            if (total >= 2) ++triples[previous2 << 16 | previous << 8 | opcode];
+            previous2 = previous;
+            previous = opcode;
+            ++total;
+            depths += depth;
+        }
+
+        /// 记录一次 invokestatic，由解释器在 record 之后调用
+        /// @param caller 调用者所在的类
+        /// @param index 方法引用在 caller 常量池中的下标
+        void recordCall(const Class *caller, uint16_t index) { ++call_sites[{caller, index}]; }
+
+        [[nodiscard]] uint64_t count(uint8_t opcode) const { return counts[opcode]; }
+
+        [[nodiscard]] uint64_t pairCount(uint8_t first, uint8_t second) const { return pairs[first << 8 | second]; }
+
+        /// 执行的字节码总数
+        [[nodiscard]] uint64_t totalCount() const { return total; }
+
+        /// 每条字节码执行前操作数栈占用的平均 Slot 数量
+        [[nodiscard]] double averageStackDepth() const {
+            return total ? static_cast<double>(depths) / static_cast<double>(total) : 0;
+        }
+
+        /// 按执行次数降序获取最频繁的字节码对
+        /// @param limit 最多返回的数量
+        [[nodiscard]] std::vector<Pair> topPairs(size_t limit) const;
+
+        /// 按执行次数降序获取最频繁的三条字节码序列
+        [[nodiscard]] std::vector<Triple> topTriples(size_t limit) const;
+
+        /// 按调用次数降序获取 invokestatic 的调用目标，来自不同调用者的同一目标合并计数
+        [[nodiscard]] std::vector<Call> calls() const;
+
+        /// 以文本形式输出最频繁的字节码对，每行为 "次数 字节码 字节码"
+        void dump(sese::io::OutputStream *output, size_t limit) const;
+
+        /// 以 JSON 输出全部统计，字节码以助记符表示
+        /// @param limit 字节码对与三条序列最多输出的数量
+        void dumpJson(sese::io::OutputStream *output, size_t limit) const;
+
+        void clear();
+
+    private:
+        std::vector<uint64_t> counts;
+        std::vector<uint64_t> pairs;
+        /// 三条序列的组合过多，只记录出现过的
+        std::unordered_map<uint32_t, uint64_t> triples;
+        /// 以调用者与常量池下标区分调用点所引用的方法，输出时再合并为目标
+        std::map<std::pair<const Class *, uint16_t>, uint64_t> call_sites;
+        /// 第一条字节码之前视作 nop
+        uint32_t previous{};
+        uint32_t previous2{};
+        uint64_t total{};
+        /// 操作数栈深度之和
+        uint64_t depths{};
+    };
+}
@@ -0,0 +1,222 @@
+#include "Profiler.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cinttypes>
+#include <cstdio>
+#include <numeric>
+#include <string>
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#include <x86intrin.h>
+#endif
+
+namespace {
+    /// 读取时间戳计数器，不支持的平台上退化为单调时钟的纳秒数
+    uint64_t tick() {
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+        return __rdtsc();
+#else
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count());
+#endif
+    }
+
+    std::string frameName(const jvm::Class *class_, const jvm::Class::MethodInfo *method) {
+        return class_->getThisName() + "." + std::string(method->name);
+    }
+}
+
+jvm::Profiler::Profiler() {
+    clear();
+}
+
+jvm::Profiler::~Profiler() = default;
+
+void jvm::Profiler::charge() {
+    auto now = tick();
+    current->self_cycles += now - last;
+    last = now;
+}
+
+void jvm::Profiler::enter(const Class *class_, const Class::MethodInfo *method) {
+    charge();
+    Node *child = nullptr;
+    for (auto &&node: current->children) {
+        if (node->method == method) {
+            child = node;
+            break;
+        }
+    }
+    if (child == nullptr) {
+        auto &&counts = method_counts[method];
+        if (counts.empty()) {
+            counts.resize(method->code_info->instructions.size());
+        }
+        auto &&node = nodes.emplace_back(std::make_unique<Node>());
+        node->parent = current;
+        node->class_ = class_;
+        node->method = method;
+        node->counts = counts.data();
+        child = node.get();
+        current->children.push_back(child);
+    }
+    ++child->calls;
+    current = child;
+    ++current_depth;
+}
+
+void jvm::Profiler::exit() {
+    if (current == root) return;
+    charge();
+    current = current->parent;
+    --current_depth;
+}
+
+void jvm::Profiler::unwind(size_t depth) {
+    while (current_depth > depth) {
+        exit();
+    }
+}
+
+std::vector<jvm::Profiler::MethodProfile> jvm::Profiler::methods() const {
+    std::unordered_map<const Class::MethodInfo *, MethodProfile> profiles;
+    // 后序遍历计算每个节点包括子节点在内的耗时，路径上已经出现过的方法不再重复计入总耗时
+    std::unordered_map<const Node *, uint64_t> totals;
+    std::unordered_map<const Class::MethodInfo *, uint32_t> active;
+    std::vector<std::pair<const Node *, size_t> > stack{{root, 0}};
+    while (!stack.empty()) {
+        auto &&[node, next] = stack.back();
+        if (next == 0 && node != root) {
+            ++active[node->method];
+        }
+        if (next < node->children.size()) {
+            auto child = node->children[next++];
+            stack.emplace_back(child, 0);
+            continue;
+        }
+        auto total = node->self_cycles;
+        for (auto &&child: node->children) {
+            total += totals[child];
+        }
+        totals[node] = total;
+        if (node != root) {
+            auto &&profile = profiles[node->method];
+            profile.class_ = node->class_;
+            profile.method = node->method;
+            profile.invocations += node->calls;
+            profile.self_cycles += node->self_cycles;
+            if (--active[node->method] == 0) {
+                profile.total_cycles += total;
+            }
+        }
+        stack.pop_back();
+    }
+    std::vector<MethodProfile> result;
+    result.reserve(profiles.size());
+    for (auto &&[method, profile]: profiles) {
+        profile.counts = method_counts.at(method);
+        profile.bytecodes = std::accumulate(profile.counts.begin(), profile.counts.end(), uint64_t{});
+        result.push_back(std::move(profile));
+    }
+    std::sort(result.begin(), result.end(), [](const MethodProfile &lhs, const MethodProfile &rhs) {
+        return lhs.self_cycles > rhs.self_cycles;
+    });
+    return result;
+}
+
+std::vector<jvm::Profiler::LineProfile> jvm::Profiler::lines(const MethodProfile &profile) {
+    std::vector<LineProfile> result;
+    auto &&code = *profile.method->code_info;
+    if (code.line_infos.empty()) return result;
+    auto line_infos = code.line_infos;
+    std::sort(line_infos.begin(), line_infos.end(), [](auto &&lhs, auto &&rhs) {
+        return lhs.start_pc < rhs.start_pc;
+    });
+    for (size_t i = 0; i < profile.counts.size(); ++i) {
+        if (profile.counts[i] == 0) continue;
+        // 起始位置不超过该指令的最后一项即为其所在的行
+        auto pc = code.instructions[i].pc;
+        auto iter = std::upper_bound(line_infos.begin(), line_infos.end(), pc, [](uint16_t value, auto &&info) {
+            return value < info.start_pc;
+        });
+        if (iter == line_infos.begin()) continue;
+        auto line = std::prev(iter)->line_number;
+        auto found = std::find_if(result.begin(), result.end(), [line](auto &&item) { return item.line == line; });
+        if (found == result.end()) {
+            result.push_back({line, profile.counts[i]});
+        } else {
+            found->bytecodes += profile.counts[i];
+        }
+    }
+    std::sort(result.begin(), result.end(), [](auto &&lhs, auto &&rhs) { return lhs.line < rhs.line; });
+    return result;
+}
+
+void jvm::Profiler::dumpFolded(sese::io::OutputStream *output) const {
+    // 深度优先遍历，path 为当前节点的调用路径，lengths 记录每一层之前的长度用于回溯
+    std::string path;
+    std::vector<size_t> lengths;
+    std::vector<std::pair<const Node *, bool> > work;
+    for (auto iter = root->children.rbegin(); iter != root->children.rend(); ++iter) {
+        work.emplace_back(*iter, false);
+    }
+    while (!work.empty()) {
+        auto [node, visited] = work.back();
+        work.pop_back();
+        if (visited) {
+            path.resize(lengths.back());
+            lengths.pop_back();
+            continue;
+        }
+        lengths.push_back(path.size());
+        if (!path.empty()) path.push_back(';');
+        path.append(frameName(node->class_, node->method));
+        if (node->self_cycles) {
+            auto line = path + " " + std::to_string(node->self_cycles) + "\n";
+            output->write(line.data(), line.size());
+        }
+        work.emplace_back(node, true);
+        for (auto iter = node->children.rbegin(); iter != node->children.rend(); ++iter) {
+            work.emplace_back(*iter, false);
+        }
+    }
+}
+
+void jvm::Profiler::dumpTop(sese::io::OutputStream *output, size_t limit) const {
+    auto profiles = methods();
+    uint64_t total = 0;
+    for (auto &&profile: profiles) {
+        total += profile.self_cycles;
+    }
+    char line[512];
+    auto length = std::snprintf(line, sizeof(line), "%6s %12s %14s %14s %14s  %s\n",
+                                "self%", "calls", "bytecodes", "self", "total", "method");
+    output->write(line, length);
+    for (size_t i = 0; i < profiles.size() && i < limit; ++i) {
+        auto &&profile = profiles[i];
+        auto name = frameName(profile.class_, profile.method) + std::string(profile.method->descriptor);
+        auto hottest = lines(profile);
+        auto max = std::max_element(hottest.begin(), hottest.end(), [](auto &&lhs, auto &&rhs) {
+            return lhs.bytecodes < rhs.bytecodes;
+        });
+        if (max != hottest.end()) {
+            name += ":" + std::to_string(max->line);
+        }
+        length = std::snprintf(line, sizeof(line), "%5.1f%% %12" PRIu64 " %14" PRIu64 " %14" PRIu64 " %14" PRIu64 "  %s\n",
+                               total ? 100.0 * static_cast<double>(profile.self_cycles) / static_cast<double>(total) : 0.0,
+                               profile.invocations, profile.bytecodes, profile.self_cycles, profile.total_cycles,
+                               name.c_str());
+        output->write(line, std::min(static_cast<size_t>(length), sizeof(line) - 1));
+    }
+}
+
+void jvm::Profiler::clear() {
+    method_counts.clear();
+    nodes.clear();
+    nodes.emplace_back(std::make_unique<Node>());
+    root = nodes.back().get();
+    current = root;
+    current_depth = 0;
+    last = tick();
+}
@@ -0,0 +1,109 @@
+#pragma once
+
+#include <jvm/Class.h>
+
+#include <sese/io/OutputStream.h>
+
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+namespace jvm {
+    /// 字节码级别的性能剖析，按调用路径记录每个方法的调用次数、执行的字节码数量与耗时，
+    /// 并按指令记录执行次数，可以借助 LineNumberTable 映射回源代码行
+    /// @note 耗时在方法进入与退出时读取时间戳计数器，单位为 TSC 周期，不支持的平台上为纳秒；
+    /// 字节码在开启剖析的解释器实例中逐条计数，期间不进入 JIT 编译的代码。
+    /// 调用树中的节点在清空之前不会释放，与 OpcodeProfile 一样只应有一个线程执行
+    class Profiler {
+        struct Node;
+
+    public:
+        /// 单个方法的汇总
+        struct MethodProfile {
+            const Class *class_{};
+            const Class::MethodInfo *method{};
+            uint64_t invocations{};
+            /// 方法自身执行的字节码数量，不包括被调用的方法，即 counts 之和
+            uint64_t bytecodes{};
+            /// 方法自身的耗时，不包括被调用的方法
+            uint64_t self_cycles{};
+            /// 包括被调用方法在内的耗时，递归调用只计算最外层
+            uint64_t total_cycles{};
+            /// 按指令下标的执行次数，与 CodeInfo::instructions 对应
+            std::vector<uint64_t> counts;
+        };
+
+        /// 源代码行的执行次数
+        struct LineProfile {
+            uint16_t line;
+            uint64_t bytecodes;
+        };
+
+        Profiler();
+
+        ~Profiler();
+
+        Profiler(const Profiler &) = delete;
+
+        Profiler &operator=(const Profiler &) = delete;
+
+        /// 进入方法，由解释器在压入栈帧后调用
+        void enter(const Class *class_, const Class::MethodInfo *method);
+
+        /// 退出当前方法，由解释器在弹出栈帧前调用
+        void exit();
+
+        /// 当前方法按指令下标的执行次数，解释器在进入与退出方法后缓存，每次派发时直接累加
+        /// @return 不在任何方法中时为 nullptr
+        [[nodiscard]] uint64_t *counts() const { return current->counts; }
+
+        /// 当前调用路径的深度，C++ 异常穿过解释器时据此恢复
+        [[nodiscard]] size_t depth() const { return current_depth; }
+
+        /// 退出方法直至深度为 depth
+        void unwind(size_t depth);
+
+        /// 按自身耗时降序汇总各个方法
+        [[nodiscard]] std::vector<MethodProfile> methods() const;
+
+        /// 将方法的指令执行次数按照 LineNumberTable 汇总到源代码行，按行号升序排列
+        /// @return 方法没有行号信息时为空
+        [[nodiscard]] static std::vector<LineProfile> lines(const MethodProfile &profile);
+
+        /// 以 collapsed stack 格式输出各调用路径的自身耗时，每行为 "Class.method;Class.method 耗时"，
+        /// 可以直接交给 flamegraph.pl 等工具生成火焰图
+        void dumpFolded(sese::io::OutputStream *output) const;
+
+        /// 以文本表格输出自身耗时最高的方法，每个方法附带执行最多的源代码行
+        /// @param limit 最多输出的方法数量
+        void dumpTop(sese::io::OutputStream *output, size_t limit) const;
+
+        void clear();
+
+    private:
+        /// 调用树中的节点，同一个方法在不同的调用路径上对应不同的节点
+        struct Node {
+            Node *parent{};
+            const Class *class_{};
+            const Class::MethodInfo *method{};
+            /// 指向所属方法的 MethodProfile::counts，各个节点共用
+            uint64_t *counts{};
+            uint64_t calls{};
+            uint64_t self_cycles{};
+            std::vector<Node *> children;
+        };
+
+        /// 将上次读取时间戳以来的耗时计入当前节点
+        void charge();
+
+        /// 各个方法的指令执行次数
+        std::unordered_map<const Class::MethodInfo *, std::vector<uint64_t> > method_counts;
+        /// 所有节点，树以父子指针相连，节点统一在此释放，避免深度递归的调用路径在析构时递归
+        std::vector<std::unique_ptr<Node> > nodes;
+        Node *root;
+        Node *current;
+        size_t current_depth{};
+        uint64_t last{};
+    };
+}
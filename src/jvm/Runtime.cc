@@ -1,19 +1,104 @@
-#include "Opcode.h"
 #include "Runtime.h"
 
-#include <sese/Log.h>
-#include <sese/util/Endian.h>
 #include <sese/util/Exception.h>
 
-#include <cmath>
+#include <algorithm>
+#include <cstring>
+#include <exception>
+#include <functional>
+
+/// 字段在对象中占用的字节数，引用按指针大小计算
+static uint32_t fieldSize(const jvm::TypeInfo &type) {
+    if (type.is_array) return sizeof(void *);
+    switch (type.type) {
+        case jvm::byte:
+        case jvm::boolean:
+            return 1;
+        case jvm::char_:
+        case jvm::short_:
+            return 2;
+        case jvm::int_:
+        case jvm::float_:
+            return 4;
+        case jvm::long_:
+        case jvm::double_:
+            return 8;
+        default:
+            return sizeof(void *);
+    }
+}
+
+/// 按照字段描述符以字段的宽度写入 ConstantValue 属性给出的初值，字符串常量暂不支持
+static void storeConstant(const jvm::Class::ConstantInfo &constant, char type, uint8_t *address) {
+    auto store = [address](auto value) { memcpy(address, &value, sizeof(value)); };
+    switch (type) {
+        case 'Z':
+        case 'B':
+            if (constant.tag == jvm::Class::integer_info) store(static_cast<int8_t>(constant.value.i));
+            break;
+        case 'C':
+        case 'S':
+            if (constant.tag == jvm::Class::integer_info) store(static_cast<int16_t>(constant.value.i));
+            break;
+        case 'I':
+            if (constant.tag == jvm::Class::integer_info) store(constant.value.i);
+            break;
+        case 'F':
+            if (constant.tag == jvm::Class::float_info) store(constant.value.f);
+            break;
+        case 'J':
+            if (constant.tag == jvm::Class::long_info) store(constant.value.l);
+            break;
+        case 'D':
+            if (constant.tag == jvm::Class::double_info) store(constant.value.d);
+            break;
+        default:
+            break;
+    }
+}
+
+jvm::Runtime::Runtime() {
+    setHeapSize(default_nursery, default_old);
+    regBuiltinNatives();
+    regBuiltinThrowables();
+}
+
+void jvm::Runtime::setHeapSize(size_t nursery, size_t old) {
+    heap = std::make_unique<Heap>(nursery, old, [this](auto &&visit) { scanRoots(visit); }, safepoint);
+}
+
+void jvm::Runtime::scanRoots(const std::function<void(void *&)> &visit) const {
+    // 所有执行字节码的线程均已到达安全点，包括发起收集的当前线程
+    safepoint.forEachStack([&visit](FrameStack &stack) {
+        for (auto frame = stack.peek(); frame != stack.sentinel(); --frame) {
+            // 尚未执行任何指令的入口帧不会触发收集
+            if (frame->ip == nullptr) continue;
+            auto &&code = *frame->method->code_info;
+            auto types = code.type_map.at(frame->ip - code.instructions.data());
+            auto count = frame->sp - frame->locals;
+            for (decltype(count) i = 0; i < count; ++i) {
+                if (types[i] == VerificationType::reference) visit(frame->locals[i].ref);
+            }
+        }
+        for (auto &&ref: stack.handles()) {
+            visit(ref);
+        }
+    });
+    for (auto &&[_, class_]: classes) {
+        for (auto &&index: class_->static_references) {
+            visit(class_->statics[index].ref);
+        }
+    }
+}
 
 void jvm::Runtime::regClass(const std::shared_ptr<Class> &class_) {
+    link(*class_);
     classes[class_->getThisName()] = class_;
     if (main.class_ == nullptr) {
         auto iter = class_->method_infos.find(main_signature);
         if (iter != class_->method_infos.end()) {
-            main.class_ = class_;
-            main.method = iter;
+            main.class_ = class_.get();
+            main.method = &iter->second;
         }
     }
 }
@@ -22,731 +107,429 @@ bool jvm::Runtime::hasMain() const {
     return main.class_ != nullptr;
 }
 
-jvm::Runtime::MethodRefResult jvm::Runtime::getMethodRefResult(const std::shared_ptr<Class> &class_, uint16_t index) {
-    auto method_ref = dynamic_cast<Class::ConstantInfo_MethodRef *>(class_->constant_infos[
-        index].get());
-    auto name_and_type = dynamic_cast<Class::ConstantInfo_NameAndType *>(class_->constant_infos[
-        method_ref->name_and_type_index].get());
-    auto method_name = dynamic_cast<Class::ConstantInfo_Utf8 *>(class_->constant_infos[name_and_type
-        ->name_index].get())->bytes;
-    auto method_type = dynamic_cast<Class::ConstantInfo_Utf8 *>(class_->constant_infos[name_and_type
-        ->descriptor_index].get())->bytes;
-    auto class_info = dynamic_cast<Class::ConstantInfo_Class *>(class_->constant_infos[method_ref->
-        class_info_index].get());
-    auto class_name = dynamic_cast<Class::ConstantInfo_Utf8 *>(class_->constant_infos[class_info->
-        index].get())->bytes;
-    return {class_name, method_name + method_type};
+const jvm::Class::ResolvedEntry &jvm::Runtime::resolveMethod(Class &class_, uint16_t index) {
+    auto &&entry = class_.resolved_entries[index];
+    if (entry.resolved) {
+        return entry;
+    }
+    {
+        std::lock_guard<std::mutex> guard(link_mutex);
+        // 其他线程可能已经写入，写入后不再修改
+        if (entry.method == nullptr) {
+            auto ref = class_.getMemberRef(index);
+            auto class_name = std::string(ref.class_name);
+            auto iter = classes.find(class_name);
+            if (iter == classes.end()) {
+                throw sese::Exception("java/lang/NoClassDefFoundError: " + class_name);
+            }
+            auto method_id = std::string(ref.name) + std::string(ref.descriptor);
+            layout(*iter->second);
+            auto method = findMethod(*iter->second, method_id);
+            if (method.method == nullptr) {
+                throw sese::Exception("java/lang/NoSuchMethodError: " + class_name + "." + method_id);
+            }
+            if (!method.method->code_info && !method.method->isAbstract()) {
+                // 已注册的本地方法在链接时被替换为 invokenative，不会到达这里
+                throw sese::Exception("java/lang/UnsatisfiedLinkError: " + class_name + "." + method_id);
+            }
+            entry.class_ = method.class_;
+            entry.method = method.method;
+        }
+        if (!entry.method->isStatic()) {
+            entry.resolved = true;
+            return entry;
+        }
+    }
+    // <clinit> 在锁外执行，所属类正在由当前线程初始化时不设置 resolved，之后的调用再次检查
+    initialize(*entry.class_);
+    if (entry.class_->isInitialized()) {
+        entry.resolved = true;
+    }
+    return entry;
 }
 
-void jvm::Runtime::run() {
-    auto &&main_method = main.method->second;
-    auto &&code = main_method.code_info;
-    main.data.locals.resize(code->max_locals);
-    Info empty;
-    run(empty, main);
+const jvm::Class::ResolvedEntry &jvm::Runtime::resolveClass(Class &class_, uint16_t index) {
+    auto &&entry = class_.resolved_entries[index];
+    if (entry.resolved) {
+        return entry;
+    }
+    {
+        std::lock_guard<std::mutex> guard(link_mutex);
+        if (entry.class_ == nullptr) {
+            auto class_name = std::string(class_.getClassName(index));
+            auto iter = classes.find(class_name);
+            if (iter == classes.end()) {
+                throw sese::Exception("java/lang/NoClassDefFoundError: " + class_name);
+            }
+            entry.class_ = iter->second.get();
+        }
+    }
+    initialize(*entry.class_);
+    if (entry.class_->isInitialized()) {
+        entry.resolved = true;
+    }
+    return entry;
 }
 
-#pragma region 字节码逻辑实现
-
-#define lconst_N(i) \
-    case lconst_##i: { \
-        current.data.stacks.emplace(i); \
-        pc += 1; \
-        break; \
+const jvm::Class::ResolvedEntry &jvm::Runtime::resolveField(Class &class_, uint16_t index) {
+    auto &&entry = class_.resolved_entries[index];
+    if (entry.resolved) {
+        return entry;
     }
-
-#define iconst_N(i) \
-    case iconst_##i: { \
-        current.data.stacks.emplace(i); \
-        pc += 1; \
-        break; \
+    std::lock_guard<std::mutex> guard(link_mutex);
+    if (entry.resolved) {
+        return entry;
+    }
+    auto ref = class_.getMemberRef(index);
+    auto class_name = std::string(ref.class_name);
+    auto iter = classes.find(class_name);
+    if (iter == classes.end()) {
+        throw sese::Exception("java/lang/NoClassDefFoundError: " + class_name);
     }
+    layout(*iter->second);
+    // 字段可能继承自父类，父类已在计算布局时确认注册
+    for (auto owner = iter->second.get(); owner;) {
+        for (auto &&field: owner->field_infos) {
+            if (field.name != ref.name || field.descriptor != ref.descriptor) continue;
+            if (field.isStatic()) {
+                throw sese::Exception("java/lang/IncompatibleClassChangeError: " + class_name + "." +
+                                      std::string(ref.name) + " is static");
+            }
+            entry.offset = field.offset;
+            entry.resolved = true;
+            return entry;
+        }
+        auto super = classes.find(owner->getSuperName());
+        owner = super == classes.end() ? nullptr : super->second.get();
+    }
+    throw sese::Exception("java/lang/NoSuchFieldError: " + class_name + "." + std::string(ref.name));
+}
 
-#define fconst_N(i) \
-    case fconst_##i: { \
-        current.data.stacks.emplace(i##.0);; \
-        pc += 1; \
-        break; \
+const jvm::Class::ResolvedEntry &jvm::Runtime::resolveStaticField(Class &class_, uint16_t index) {
+    auto &&entry = class_.resolved_entries[index];
+    if (entry.resolved) {
+        return entry;
+    }
+    {
+        std::lock_guard<std::mutex> guard(link_mutex);
+        if (entry.class_ == nullptr) {
+            auto ref = class_.getMemberRef(index);
+            auto class_name = std::string(ref.class_name);
+            auto iter = classes.find(class_name);
+            if (iter == classes.end()) {
+                throw sese::Exception("java/lang/NoClassDefFoundError: " + class_name);
+            }
+            layout(*iter->second);
+            for (auto owner = iter->second.get(); owner && entry.class_ == nullptr; owner = owner->super) {
+                for (auto &&field: owner->field_infos) {
+                    if (field.name != ref.name || field.descriptor != ref.descriptor) continue;
+                    if (!field.isStatic()) {
+                        throw sese::Exception("java/lang/IncompatibleClassChangeError: " + class_name + "." +
+                                              std::string(ref.name) + " is not static");
+                    }
+                    entry.address = reinterpret_cast<uint8_t *>(&owner->statics[field.offset]);
+                    entry.class_ = owner;
+                    break;
+                }
+            }
+            if (entry.class_ == nullptr) {
+                throw sese::Exception("java/lang/NoSuchFieldError: " + class_name + "." + std::string(ref.name));
+            }
+        }
+    }
+    // 只初始化声明该字段的类，通过子类访问父类的静态字段不会初始化子类
+    initialize(*entry.class_);
+    if (entry.class_->isInitialized()) {
+        entry.resolved = true;
     }
+    return entry;
+}
 
-#define dconst_N(i) \
-    case dconst_##i: { \
-        current.data.stacks.emplace(i##.0);; \
-        pc += 1; \
-        break; \
+void jvm::Runtime::initialize(Class &class_) {
+    if (class_.isInitialized()) {
+        return;
+    }
+    std::unique_lock<std::mutex> lock(link_mutex);
+    for (;;) {
+        auto state = class_.init_state.load();
+        if (state == Class::initialized) {
+            return;
+        }
+        if (state == Class::erroneous) {
+            throw sese::Exception("java/lang/NoClassDefFoundError: Could not initialize class " + class_.getThisName());
+        }
+        if (state == Class::uninitialized) {
+            break;
+        }
+        if (class_.init_thread == std::this_thread::get_id()) {
+            return;
+        }
+        // 其他线程正在执行 <clinit>，等待期间视为已到达安全点；离开阻塞区域前释放锁，避免在持有锁时等待收集
+        {
+            Safepoint::Blocking blocking(safepoint);
+            init_condition.wait(lock);
+            lock.unlock();
+        }
+        lock.lock();
     }
+    layout(class_);
+    class_.init_state = Class::initializing;
+    class_.init_thread = std::this_thread::get_id();
+    lock.unlock();
 
-#define iload_N(i) \
-    case iload_##i: { \
-        current.data.stacks.emplace(current.data.locals[i].getInt()); \
-        pc += 1; \
-        break; \
+    auto finish = [this, &class_](Class::InitState state) {
+        std::lock_guard<std::mutex> guard(link_mutex);
+        class_.init_state = state;
+        class_.init_thread = {};
+        init_condition.notify_all();
+    };
+    try {
+        if (class_.super) {
+            initialize(*class_.super);
+        }
+        auto iter = class_.method_infos.find(clinit_signature);
+        if (iter != class_.method_infos.end() && iter->second.code_info) {
+            call(&class_, &iter->second, nullptr, 0);
+        }
+    } catch (const sese::Exception &e) {
+        finish(Class::erroneous);
+        std::string_view what(e.what());
+        auto thrown = classes.find(std::string(what.substr(0, what.find(": "))));
+        if (thrown != classes.end() && isSubclassOf(thrown->second.get(), classes.at("java/lang/Error").get())) {
+            throw;
+        }
+        throw sese::Exception("java/lang/ExceptionInInitializerError: " + std::string(what));
     }
+    finish(Class::initialized);
+}
 
-#define lload_N(i) \
-    case lload_##i: { \
-        current.data.stacks.emplace(current.data.locals[i].getInt()); \
-        pc += 1; \
-        break; \
+void jvm::Runtime::layoutStatics(Class &class_) {
+    uint32_t count = 0;
+    for (auto &&field: class_.field_infos) {
+        if (!field.isStatic()) continue;
+        field.offset = count++;
+        if (field.type.is_array || field.type.type == object) {
+            class_.static_references.push_back(field.offset);
+        }
+    }
+    class_.statics = std::make_unique<Slot[]>(count);
+    for (auto &&field: class_.field_infos) {
+        if (!field.isStatic()) continue;
+        for (auto &&attribute: field.attribute_infos) {
+            if (attribute.name == "ConstantValue" && attribute.info.size() == 2) {
+                auto index = static_cast<uint16_t>(static_cast<uint8_t>(attribute.info[0]) << 8 |
+                                                   static_cast<uint8_t>(attribute.info[1]));
+                storeConstant(class_.getConstant(index), field.descriptor[0],
+                              reinterpret_cast<uint8_t *>(&class_.statics[field.offset]));
+            }
+        }
     }
+}
 
-#define fload_N(i) \
-    case fload_##i: { \
-        current.data.stacks.emplace(current.data.locals[i].getDouble()); \
-        pc += 1; \
-        break; \
+void jvm::Runtime::layout(Class &class_) {
+    if (class_.instance_size) {
+        return;
+    }
+    uint32_t offset = sizeof(Object);
+    auto super_name = class_.getSuperName();
+    if (super_name != "java/lang/Object") {
+        auto iter = classes.find(super_name);
+        if (iter == classes.end()) {
+            throw sese::Exception("java/lang/NoClassDefFoundError: " + super_name);
+        }
+        layout(*iter->second);
+        class_.super = iter->second.get();
+        offset = iter->second->fields_end;
+        class_.reference_offsets = iter->second->reference_offsets;
+    }
+    // JDK 中的接口不会被注册，也没有需要派发的实现
+    for (auto &&index: class_.interfaces) {
+        auto iter = classes.find(std::string(class_.getClassName(index)));
+        if (iter == classes.end()) continue;
+        layout(*iter->second);
+        class_.super_interfaces.push_back(iter->second.get());
+    }
+    std::vector<Class::FieldInfo *> fields;
+    for (auto &&field: class_.field_infos) {
+        if (!field.isStatic()) fields.push_back(&field);
     }
+    std::stable_sort(fields.begin(), fields.end(), [](auto *a, auto *b) {
+        return fieldSize(a->type) > fieldSize(b->type);
+    });
+    for (auto &&field: fields) {
+        auto size = fieldSize(field->type);
+        offset = (offset + size - 1) / size * size;
+        field->offset = offset;
+        offset += size;
+        if (field->type.is_array || field->type.type == object) {
+            class_.reference_offsets.push_back(field->offset);
+        }
+    }
+    class_.fields_end = offset;
+    class_.instance_size = (offset + 7) / 8 * 8;
+    linkMethods(class_);
+}
 
-#define dload_N(i) \
-    case dload_##i: { \
-        current.data.stacks.emplace(current.data.locals[i].getDouble()); \
-        pc += 1; \
-        break; \
+const jvm::Class::ResolvedEntry &jvm::Runtime::resolveConstant(Class &class_, uint16_t index, bool wide) {
+    auto &&entry = class_.resolved_entries[index];
+    if (entry.resolved) {
+        return entry;
+    }
+    std::lock_guard<std::mutex> guard(link_mutex);
+    if (entry.resolved) {
+        return entry;
+    }
+    auto &&constant = class_.constant_infos[index];
+    if (!wide && constant.tag == Class::integer_info) {
+        entry.value.i = constant.value.i;
+    } else if (!wide && constant.tag == Class::float_info) {
+        entry.value.f = constant.value.f;
+    } else if (wide && constant.tag == Class::long_info) {
+        entry.value.l = constant.value.l;
+    } else if (wide && constant.tag == Class::double_info) {
+        entry.value.d = constant.value.d;
+    } else {
+        // todo 字符串暂时未处理
+        throw sese::Exception(wide ? "ldc2_w received arguments of an illegal type" : "ldc received arguments of an illegal type");
     }
+    entry.resolved = true;
+    return entry;
+}
 
-#define istore_N(i) \
-    case istore_##i: { \
-        current.data.locals[i] = sese::Value(current.data.stacks.top().getInt()); \
-        current.data.stacks.pop(); \
-        pc += 1; \
-        break; \
+void jvm::Runtime::run() {
+    // 不支持命令行参数，String[] args 为空数组；分配前进入作用域，收集时当前线程同样需要暂停
+    Safepoint::Scope scope(safepoint);
+    initialize(*main.class_);
+    Slot args{};
+    args.ref = heap->allocateArray(Array::t_reference, 0);
+    call(main.class_, main.method, &args, 1);
+}
+
+jvm::Slot jvm::Runtime::invokeStatic(const std::string &class_name, const std::string &name_and_descriptor,
+                                     const std::vector<Slot> &args) {
+    auto method = findStatic(class_name, name_and_descriptor);
+    if (args.size() != method.method->args_slots) {
+        throw sese::Exception("java/lang/IllegalArgumentException: wrong number of arguments");
     }
+    return call(method.class_, method.method, args.data(), args.size());
+}
 
-#define lstore_N(i) \
-    case lstore_##i: { \
-        current.data.locals[i] = sese::Value(current.data.stacks.top().getInt()); \
-        current.data.stacks.pop(); \
-        pc += 1; \
-        break; \
+jvm::StaticMethod jvm::Runtime::findStatic(const std::string &class_name, const std::string &name_and_descriptor) {
+    auto iter = classes.find(class_name);
+    if (iter == classes.end()) {
+        throw sese::Exception("java/lang/NoClassDefFoundError: " + class_name);
     }
+    auto method = iter->second->method_infos.find(name_and_descriptor);
+    if (method == iter->second->method_infos.end() || !method->second.isStatic()) {
+        throw sese::Exception("java/lang/NoSuchMethodError: " + class_name + "." + name_and_descriptor);
+    }
+    initialize(*iter->second);
+    StaticMethod handle;
+    handle.class_ = iter->second.get();
+    handle.method = &method->second;
+    return handle;
+}
 
-#define fstore_N(i) \
-    case fstore_##i: { \
-        current.data.locals[i] = sese::Value(current.data.stacks.top().getDouble()); \
-        current.data.stacks.pop(); \
-        pc += 1; \
-        break; \
+void jvm::Runtime::invokeBatch(const StaticMethod &method, const Slot *args, Slot *results, size_t count,
+                               size_t threads) {
+    if (!method.valid()) {
+        throw sese::Exception("java/lang/IllegalArgumentException: invalid method handle");
+    }
+    auto primitive = [](const TypeInfo &type) { return !type.is_array && type.type != object; };
+    auto &&info = *method.method;
+    if (!std::all_of(info.args_type.begin(), info.args_type.end(), primitive)) {
+        throw sese::Exception("java/lang/IllegalArgumentException: argument type mismatch");
+    }
+    if (!primitive(info.return_type)) {
+        throw sese::Exception("java/lang/IllegalArgumentException: result type mismatch");
+    }
+    std::atomic<bool> cancel{false};
+    threads = std::min(threads, count);
+    if (threads <= 1) {
+        runBatch(method, args, results, count, cancel);
+        return;
+    }
+    auto slots = method.method->args_slots;
+    auto chunk = (count + threads - 1) / threads;
+    std::exception_ptr error;
+    std::mutex error_mutex;
+    std::function<void(size_t)> work = [&](size_t index) {
+        auto begin = index * chunk;
+        auto end = std::min(begin + chunk, count);
+        try {
+            runBatch(method, args + begin * slots, results ? results + begin : nullptr, end - begin, cancel);
+        } catch (...) {
+            cancel = true;
+            std::lock_guard<std::mutex> guard(error_mutex);
+            if (!error) error = std::current_exception();
+        }
+    };
+    // 当前线程可能正处于执行字节码的作用域中，等待工作线程期间不能阻止其他线程发起的收集
+    {
+        Safepoint::Blocking blocking(safepoint);
+        workers.start((count + chunk - 1) / chunk - 1, work);
+    }
+    work(0);
+    {
+        Safepoint::Blocking blocking(safepoint);
+        workers.wait();
+    }
+    if (error) {
+        std::rethrow_exception(error);
     }
+}
 
-#define dstore_N(i) \
-    case dstore_##i: { \
-        current.data.locals[i] = sese::Value(current.data.stacks.top().getDouble()); \
-        current.data.stacks.pop(); \
-        pc += 1; \
-        break; \
+void jvm::Runtime::runBatch(const StaticMethod &method, const Slot *args, Slot *results, size_t count,
+                            const std::atomic<bool> &cancel) {
+    Safepoint::Scope scope(safepoint);
+    auto &&stack = FrameStack::current();
+    auto locals = stack.freeSlots();
+    auto slots = method.method->args_slots;
+    for (size_t i = 0; i < count && !cancel.load(std::memory_order_relaxed); ++i, args += slots) {
+        auto entry_frame = stack.push(method.class_, method.method, locals);
+        std::copy(args, args + slots, locals);
+        finish(entry_frame);
+        if (results) results[i] = locals[0];
     }
+}
 
-void jvm::Runtime::run(Info &prev, Info &current) {
-    // SESE_INFO("call %s.%s", current.class_->getThisName().c_str(), current.method->first.c_str());
-    auto &&code = current.method->second.code_info;
-    for (size_t pc = 0; pc < code->code.size();) {
-        auto op = static_cast<Opcode>(code->code[pc]);
-        switch (op) {
-            case nop: {
-                pc += 1;
-                break;
-            }
-            case aconst_null: {
-                current.data.stacks.emplace();
-                pc += 1;
-                break;
-            }
-            case iconst_m1: {
-                current.data.stacks.emplace(-1);
-                pc += 1;
-                break;
-            }
-            iconst_N(0)
-            iconst_N(1)
-            iconst_N(2)
-            iconst_N(3)
-            iconst_N(4)
-            iconst_N(5)
-            lconst_N(0)
-            lconst_N(1)
-            fconst_N(0)
-            fconst_N(1)
-            fconst_N(2)
-            dconst_N(0)
-            dconst_N(1)
-            case bipush: {
-                uint8_t byte = code->code[pc + 1];
-                current.data.stacks.emplace(byte);
-                pc += 2;
-                break;
-            }
-            case sipush: {
-                uint16_t bytes;
-                memcpy(&bytes, &code->code[pc + 1], 2);
-                bytes = FromBigEndian16(bytes);
-                current.data.stacks.emplace(bytes);
-                pc += 3;
-                break;
-            }
-            case ldc: {
-                uint8_t index = code->code[pc + 1];
-                auto i = current.class_->constant_infos[index]->tag;
-                if (i == Class::integer_info) {
-                    auto wrapper =
-                            dynamic_cast<Class::ConstantInfo_Integer *>(current.class_->constant_infos[index].get());
-                    current.data.stacks.emplace(wrapper->bytes);
-                } else if (i == Class::float_info) {
-                    auto wrapper =
-                            dynamic_cast<Class::ConstantInfo_Float *>(current.class_->constant_infos[index].get());
-                    current.data.stacks.emplace(wrapper->bytes);
-                } else if (i == Class::string_info) {
-                    // todo 字符串暂时未处理
-                    throw sese::Exception("ldc received arguments of an illegal type");
-                } else {
-                    throw sese::Exception("ldc received arguments of an illegal type");
-                }
-                pc += 2;
-                break;
-            }
-            case ldc_w: {
-                uint16_t index;
-                memcpy(&index, &code->code[pc + 1], 2);
-                index = FromBigEndian16(index);
-                auto i = current.class_->constant_infos[index]->tag;
-                if (i == Class::integer_info) {
-                    auto wrapper =
-                            dynamic_cast<Class::ConstantInfo_Integer *>(current.class_->constant_infos[index].get());
-                    current.data.stacks.emplace(wrapper->bytes);
-                } else if (i == Class::float_info) {
-                    auto wrapper =
-                            dynamic_cast<Class::ConstantInfo_Float *>(current.class_->constant_infos[index].get());
-                    current.data.stacks.emplace(wrapper->bytes);
-                } else if (i == Class::string_info) {
-                    // todo 字符串暂时未处理
-                    throw sese::Exception("ldc received arguments of an illegal type");
-                } else {
-                    throw sese::Exception("ldc received arguments of an illegal type");
-                }
-                pc += 3;
-                break;
-            }
-            case ldc2_w: {
-                uint16_t index;
-                memcpy(&index, &code->code[pc + 1], 2);
-                index = FromBigEndian16(index);
-                auto i = current.class_->constant_infos[index]->tag;
-                if (i == Class::long_info) {
-                    auto wrapper =
-                            dynamic_cast<Class::ConstantInfo_Long *>(current.class_->constant_infos[index].get());
-                    current.data.stacks.emplace(static_cast<int>(wrapper->bytes));
-                } else if (i == Class::double_info) {
-                    auto wrapper =
-                            dynamic_cast<Class::ConstantInfo_Double *>(current.class_->constant_infos[index].get());
-                    current.data.stacks.emplace(wrapper->bytes);
-                } else {
-                    throw sese::Exception("ldc_w received arguments of an illegal type");
-                }
-                pc += 3;
-                break;
-                break;
-            }
-            case iload: {
-                uint8_t index = code->code[pc + 1];
-                current.data.stacks.emplace(current.data.locals[index].getInt());
-                pc += 2;
-                break;
-            }
-            iload_N(0)
-            iload_N(1)
-            iload_N(2)
-            iload_N(3)
-            case lload: {
-                uint8_t index = code->code[pc + 1];
-                current.data.stacks.emplace(current.data.locals[index].getInt());
-                pc += 2;
-                break;
-            }
-            lload_N(0)
-            lload_N(1)
-            lload_N(2)
-            lload_N(3)
-            case fload: {
-                uint8_t index = code->code[pc + 1];
-                current.data.stacks.emplace(current.data.locals[index].getDouble());
-                pc += 2;
-                break;
-            }
-            fload_N(0)
-            fload_N(1)
-            fload_N(2)
-            fload_N(3)
-            case dload: {
-                uint8_t index = code->code[pc + 1];
-                current.data.stacks.emplace(current.data.locals[index].getDouble());
-                pc += 2;
-                break;
-            }
-            dload_N(0)
-            dload_N(1)
-            dload_N(2)
-            dload_N(3)
-            // todo aload
-            case istore: {
-                uint8_t index = code->code[pc + 1];
-                current.data.locals[index] = sese::Value(current.data.stacks.top().getInt());
-                current.data.stacks.pop();
-                pc += 2;
-                break;
-            }
-            istore_N(0)
-            istore_N(1)
-            istore_N(2)
-            istore_N(3)
-            case lstore: {
-                uint8_t index = code->code[pc + 1];
-                current.data.locals[index] = sese::Value(current.data.stacks.top().getInt());
-                current.data.stacks.pop();
-                pc += 2;
-                break;
-            }
-            lstore_N(0)
-            lstore_N(1)
-            lstore_N(2)
-            lstore_N(3)
-            case fstore: {
-                uint8_t index = code->code[pc + 1];
-                current.data.locals[index] = sese::Value(current.data.stacks.top().getDouble());
-                current.data.stacks.pop();
-                pc += 2;
-                break;
-            }
-            fstore_N(0)
-            fstore_N(1)
-            fstore_N(2)
-            fstore_N(3)
-            case dstore: {
-                uint8_t index = code->code[pc + 1];
-                current.data.locals[index] = sese::Value(current.data.stacks.top().getDouble());
-                current.data.stacks.pop();
-                pc += 2;
-                break;
-            }
-            dstore_N(0)
-            dstore_N(1)
-            dstore_N(2)
-            dstore_N(3)
-            // todo astore
-            // todo stack 相关指令暂时未实现，因为没有区分 int/long 和 float/double 类型
-            case ladd:
-            case iadd: {
-                auto i = current.data.stacks.top().getInt();
-                current.data.stacks.pop();
-                i += current.data.stacks.top().getInt();
-                current.data.stacks.pop();
-                current.data.stacks.emplace(i);
-                pc += 1;
-                break;
-            }
-            case dadd:
-            case fadd: {
-                auto i = current.data.stacks.top().getDouble();
-                current.data.stacks.pop();
-                i += current.data.stacks.top().getDouble();
-                current.data.stacks.pop();
-                current.data.stacks.emplace(i);
-                pc += 1;
-                break;
-            }
-            case lsub:
-            case isub: {
-                auto value2 = current.data.stacks.top().getInt();
-                current.data.stacks.pop();
-                auto value1 = current.data.stacks.top().getInt();
-                current.data.stacks.pop();
-                current.data.stacks.emplace(value1 - value2);
-                pc += 1;
-                break;
-            }
-            case dsub:
-            case fsub: {
-                auto value2 = current.data.stacks.top().getDouble();
-                current.data.stacks.pop();
-                auto value1 = current.data.stacks.top().getDouble();
-                current.data.stacks.pop();
-                current.data.stacks.emplace(value1 - value2);
-                pc += 1;
-                break;
-            }
-            case lmul:
-            case imul: {
-                auto i = current.data.stacks.top().getInt();
-                current.data.stacks.pop();
-                i *= current.data.stacks.top().getInt();
-                current.data.stacks.pop();
-                current.data.stacks.emplace(i);
-                pc += 1;
-                break;
-            }
-            case dmul:
-            case fmul: {
-                auto i = current.data.stacks.top().getDouble();
-                current.data.stacks.pop();
-                i *= current.data.stacks.top().getDouble();
-                current.data.stacks.pop();
-                current.data.stacks.emplace(i);
-                pc += 1;
-                break;
-            }
-            case ldiv:
-            case idiv: {
-                auto value2 = current.data.stacks.top().getInt();
-                current.data.stacks.pop();
-                auto value1 = current.data.stacks.top().getInt();
-                current.data.stacks.pop();
-                current.data.stacks.emplace(value1 / value2);
-                pc += 1;
-                break;
-            }
-            case ddiv:
-            case fdiv: {
-                auto value2 = current.data.stacks.top().getDouble();
-                current.data.stacks.pop();
-                auto value1 = current.data.stacks.top().getDouble();
-                current.data.stacks.pop();
-                current.data.stacks.emplace(value1 / value2);
-                pc += 1;
-                break;
-            }
-            case lrem:
-            case irem: {
-                auto value2 = current.data.stacks.top().getInt();
-                current.data.stacks.pop();
-                auto value1 = current.data.stacks.top().getInt();
-                current.data.stacks.pop();
-                auto result = value1 % value2;
-                current.data.stacks.emplace(result);
-                pc += 1;
-                break;
-            }
-            case drem:
-            case frem: {
-                auto value2 = current.data.stacks.top().getDouble();
-                current.data.stacks.pop();
-                auto value1 = current.data.stacks.top().getDouble();
-                current.data.stacks.pop();
-                auto result = std::fmod(value1, value2);
-                current.data.stacks.emplace(result);
-                pc += 1;
-                break;
-            }
-            case lneg:
-            case ineg: {
-                auto i = current.data.stacks.top().getInt();
-                current.data.stacks.pop();
-                i = 0 - i;
-                current.data.stacks.emplace(i);
-                pc += 1;
-                break;
-            }
-            case dneg:
-            case fneg: {
-                auto i = current.data.stacks.top().getDouble();
-                current.data.stacks.pop();
-                i = 0.0 - i;
-                current.data.stacks.emplace(i);
-                pc += 1;
-                break;
-            }
-            // todo shl 相关指令暂时未实现，因为没有区分 int/long 和 float/double 类型
-            case i2d: {
-                auto i = current.data.stacks.top().getInt();
-                current.data.stacks.pop();
-                auto d = static_cast<double>(i);
-                current.data.stacks.emplace(d);
-                pc += 1;
-                break;
-            }
-            case iinc: {
-                uint8_t index, ii;
-                memcpy(&index, &code->code[pc + 1], 1);
-                memcpy(&ii, &code->code[pc + 2], 1);
-                auto i = current.data.locals[index].getInt() + ii;
-                current.data.locals[index] = sese::Value(i);
-                pc += 3;
-                break;
-            }
-            // todo i2l 相关指令暂时未实现，因为没有区分 int/long 和 float/double 类型
-            case lcmp: {
-                auto value1 = current.data.stacks.top().getInt();
-                current.data.stacks.pop();
-                auto value2 = current.data.stacks.top().getInt();
-                current.data.stacks.pop();
-                auto i = (value1 < value2) ? -1 : ((value1 == value2) ? 0 : 1);
-                current.data.stacks.emplace(i);
-                pc += 1;
-                break;
-            }
-            case dcmpl:
-            case fcmpl: {
-                auto value1 = current.data.stacks.top().getDouble();
-                current.data.stacks.pop();
-                auto value2 = current.data.stacks.top().getDouble();
-                current.data.stacks.pop();
-                if (std::isnan(value1) || std::isnan(value2)) {
-                    current.data.stacks.emplace(-1);
-                } else {
-                    auto i = (value1 < value2) ? -1 : ((value1 == value2) ? 0 : 1);
-                    current.data.stacks.emplace(i);
-                }
-                pc += 1;
-                break;
-            }
-            case dcmpg:
-            case fcmpg: {
-                auto value1 = current.data.stacks.top().getDouble();
-                current.data.stacks.pop();
-                auto value2 = current.data.stacks.top().getDouble();
-                current.data.stacks.pop();
-                if (std::isnan(value1) || std::isnan(value2)) {
-                    current.data.stacks.emplace(1);
-                } else {
-                    auto i = (value1 < value2) ? -1 : ((value1 == value2) ? 0 : 1);
-                    current.data.stacks.emplace(i);
-                }
-                pc += 1;
-                break;
-            }
-            case ifeq: {
-                int16_t pos;
-                memcpy(&pos, &code->code[pc + 1], 2);
-                pos = FromBigEndian16(pos);
-                auto i = current.data.stacks.top().getInt();
-                current.data.stacks.pop();
-                if (i == 0) {
-                    pc += pos;
-                } else {
-                    pc += 3;
-                }
-                break;
-            }
-            case ifne: {
-                int16_t pos;
-                memcpy(&pos, &code->code[pc + 1], 2);
-                pos = FromBigEndian16(pos);
-                auto i = current.data.stacks.top().getInt();
-                current.data.stacks.pop();
-                if (i != 0) {
-                    pc += pos;
-                } else {
-                    pc += 3;
-                }
-                break;
-            }
-            case iflt: {
-                int16_t pos;
-                memcpy(&pos, &code->code[pc + 1], 2);
-                pos = FromBigEndian16(pos);
-                auto i = current.data.stacks.top().getInt();
-                current.data.stacks.pop();
-                if (i < 0) {
-                    pc += pos;
-                } else {
-                    pc += 3;
-                }
-                break;
-            }
-            case ifge: {
-                int16_t pos;
-                memcpy(&pos, &code->code[pc + 1], 2);
-                pos = FromBigEndian16(pos);
-                auto i = current.data.stacks.top().getInt();
-                current.data.stacks.pop();
-                if (i >= 0) {
-                    pc += pos;
-                } else {
-                    pc += 3;
-                }
-                break;
-            }
-            case ifgt: {
-                int16_t pos;
-                memcpy(&pos, &code->code[pc + 1], 2);
-                pos = FromBigEndian16(pos);
-                auto i = current.data.stacks.top().getInt();
-                current.data.stacks.pop();
-                if (i > 0) {
-                    pc += pos;
-                } else {
-                    pc += 3;
-                }
-                break;
-            }
-            case ifle: {
-                int16_t pos;
-                memcpy(&pos, &code->code[pc + 1], 2);
-                pos = FromBigEndian16(pos);
-                auto i = current.data.stacks.top().getInt();
-                current.data.stacks.pop();
-                if (i <= 0) {
-                    pc += pos;
-                } else {
-                    pc += 3;
-                }
-                break;
-            }
-            case if_icmpeq: {
-                int16_t pos;
-                memcpy(&pos, &code->code[pc + 1], 2);
-                pos = FromBigEndian16(pos);
-                auto value2 = current.data.stacks.top().getInt();
-                current.data.stacks.pop();
-                auto value1 = current.data.stacks.top().getInt();
-                current.data.stacks.pop();
-                if (value1 == value2) {
-                    pc += pos;
-                } else {
-                    pc += 3;
-                }
-                break;
-            }
-            case if_icmpne: {
-                int16_t pos;
-                memcpy(&pos, &code->code[pc + 1], 2);
-                pos = FromBigEndian16(pos);
-                auto value2 = current.data.stacks.top().getInt();
-                current.data.stacks.pop();
-                auto value1 = current.data.stacks.top().getInt();
-                current.data.stacks.pop();
-                if (value1 != value2) {
-                    pc += pos;
-                } else {
-                    pc += 3;
-                }
-                break;
-            }
-            case if_icmplt: {
-                int16_t pos;
-                memcpy(&pos, &code->code[pc + 1], 2);
-                pos = FromBigEndian16(pos);
-                auto value2 = current.data.stacks.top().getInt();
-                current.data.stacks.pop();
-                auto value1 = current.data.stacks.top().getInt();
-                current.data.stacks.pop();
-                if (value1 < value2) {
-                    pc += pos;
-                } else {
-                    pc += 3;
-                }
-                break;
-            }
-            case if_icmpge: {
-                int16_t pos;
-                memcpy(&pos, &code->code[pc + 1], 2);
-                pos = FromBigEndian16(pos);
-                auto value2 = current.data.stacks.top().getInt();
-                current.data.stacks.pop();
-                auto value1 = current.data.stacks.top().getInt();
-                current.data.stacks.pop();
-                if (value1 >= value2) {
-                    pc += pos;
-                } else {
-                    pc += 3;
-                }
-                break;
-            }
-            case if_icmpgt: {
-                int16_t pos;
-                memcpy(&pos, &code->code[pc + 1], 2);
-                pos = FromBigEndian16(pos);
-                auto value2 = current.data.stacks.top().getInt();
-                current.data.stacks.pop();
-                auto value1 = current.data.stacks.top().getInt();
-                current.data.stacks.pop();
-                if (value1 > value2) {
-                    pc += pos;
-                } else {
-                    pc += 3;
-                }
-                break;
-            }
-            case if_icmple: {
-                int16_t pos;
-                memcpy(&pos, &code->code[pc + 1], 2);
-                pos = FromBigEndian16(pos);
-                auto value2 = current.data.stacks.top().getInt();
-                current.data.stacks.pop();
-                auto value1 = current.data.stacks.top().getInt();
-                current.data.stacks.pop();
-                if (value1 <= value2) {
-                    pc += pos;
-                } else {
-                    pc += 3;
-                }
-                break;
-            }
-            // todo if_acmpeq
-            case goto_: {
-                int16_t pos;
-                memcpy(&pos, &code->code[pc + 1], 2);
-                pos = FromBigEndian16(pos);
-                pc += pos;
-                break;
-            }
-            // todo jsr
-            case lreturn:
-            case ireturn: {
-                auto i = current.data.stacks.top().getInt();
-                current.data.stacks.pop();
-                prev.data.stacks.emplace(i);
-                pc += 1;
-                SESE_INFO("exit %s.%s with return value %d",
-                          current.class_->getThisName().c_str(),
-                          current.method->first.c_str(),
-                          i);
-                goto end;
-            }
-            case dreturn:
-            case freturn: {
-                auto i = current.data.stacks.top().getDouble();
-                current.data.stacks.pop();
-                prev.data.stacks.emplace(i);
-                pc += 1;
-                SESE_INFO("exit %s.%s with return value %le",
-                          current.class_->getThisName().c_str(),
-                          current.method->first.c_str(),
-                          i);
-                goto end;
-            }
-            // todo areturn
-            case return_: {
-                pc += 1;
-                SESE_INFO("exit %s.%s", current.class_->getThisName().c_str(), current.method->first.c_str());
-                goto end;
-            }
-            // todo 178 ... 195 大概率不会去实现的指令，多态等相关
-            case invokestatic: {
-                uint16_t constant_index;
-                memcpy(&constant_index, &code->code[pc + 1], 2);
-                constant_index = FromBigEndian16(constant_index);
-                auto result = getMethodRefResult(current.class_, constant_index);
-                auto class_ = classes[result.class_name];
-                auto method = class_->method_infos.find(result.method_id);
-                auto &&c = method->second.code_info;
-                Info info;
-                info.class_ = class_;
-                info.method = method;
-                info.data.locals.resize(c->max_locals);
-                for (int j = 0; j < method->second.args_type.size(); ++j) {
-                    info.data.locals[j] = std::move(current.data.stacks.top());
-                    current.data.stacks.pop();
-                }
-                run(current, info);
-                pc += 3;
-                break;
-            }
-            // todo 部分跳转和宽索引指令
-            default:
-                SESE_ERROR("opcode %d", op);
-                throw sese::Exception("Unsupported opcode");
+jvm::Frame *jvm::Runtime::enter(const StaticMethod &method, const Type *types, size_t count, Type result) {
+    if (!method.valid()) {
+        throw sese::Exception("java/lang/IllegalArgumentException: invalid method handle");
+    }
+    auto &&info = *method.method;
+    auto matches = [](const TypeInfo &type, Type expected) {
+        return !type.is_array && type.type == expected;
+    };
+    if (info.args_type.size() != count) {
+        throw sese::Exception("java/lang/IllegalArgumentException: wrong number of arguments");
+    }
+    for (size_t i = 0; i < count; ++i) {
+        if (!matches(info.args_type[i], types[i])) {
+            throw sese::Exception("java/lang/IllegalArgumentException: argument type mismatch");
         }
     }
-end:
-    return;
+    if (!matches(info.return_type, result)) {
+        throw sese::Exception("java/lang/IllegalArgumentException: result type mismatch");
+    }
+    auto &&stack = FrameStack::current();
+    return stack.push(method.class_, method.method, stack.freeSlots());
 }
 
-#pragma endregion
+void jvm::Runtime::finish(Frame *entry_frame) {
+    try {
+        execute(entry_frame);
+    } catch (...) {
+        FrameStack::current().unwind(entry_frame - 1);
+        throw;
+    }
+}
+
+jvm::Slot jvm::Runtime::call(Class *class_, Class::MethodInfo *method, const Slot *args, size_t count) {
+    Safepoint::Scope scope(safepoint);
+    auto &&stack = FrameStack::current();
+    auto entry = stack.push(class_, method, stack.freeSlots());
+    std::copy(args, args + count, entry->locals);
+    finish(entry);
+    return entry->locals[0];
+}
@@ -1,43 +1,448 @@
 #pragma once
 
-#include <stack>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <type_traits>
 #include <unordered_map>
 #include <jvm/Class.h>
-#include <sese/util/Value.h>
+#include <jvm/Frame.h>
+#include <jvm/Heap.h>
+#include <jvm/Native.h>
+#include <jvm/OpcodeProfile.h>
+#include <jvm/Profiler.h>
+#include <jvm/Safepoint.h>
+#include <jvm/Tracer.h>
+#include <jvm/WorkerPool.h>
 
 namespace jvm {
+    /// invokevirtual/invokeinterface 内联缓存的统计信息
+    struct DispatchStats {
+        /// 接收者的类已记录在调用点缓存中的调用次数
+        uint64_t hits{};
+        /// 未命中缓存、需要查询虚方法表或者接口方法表的调用次数
+        uint64_t misses{};
+        /// 调用点由单态变为多态的次数
+        uint64_t polymorphic_transitions{};
+        /// 调用点由多态变为超多态的次数，此后该调用点的每次调用都计为未命中
+        uint64_t megamorphic_transitions{};
+    };
+
+    /// 由 Runtime::findStatic 解析得到的静态方法，所属类已经完成初始化，可以在多个线程中重复调用
+    /// @note 只在得到它的 Runtime 的生命周期内有效
+    class StaticMethod {
+    public:
+        StaticMethod() = default;
+
+        [[nodiscard]] bool valid() const { return method != nullptr; }
+
+    private:
+        friend class Runtime;
+
+        Class *class_{};
+        Class::MethodInfo *method{};
+    };
+
+    /// 执行环境，已注册的类及其链接结果由所有线程共享，栈帧与操作数栈位于各线程私有的 FrameStack 中
+    /// @note 注册类与本地方法以及各项设置需要在任何线程开始执行之前完成，之后可以在多个线程中同时调用
+    /// run 与 invokeStatic；类的首次初始化只执行一次，其他线程等待其完成，常量池缓存、内联缓存与指令改写
+    /// 在首次解析后即不再变化
     class Runtime {
     public:
-        struct StackFrame {
-            std::stack<sese::Value> stacks;
-            std::vector<sese::Value> locals;
-        };
+        Runtime();
+
+        Runtime(const Runtime &) = delete;
+
+        Runtime &operator=(const Runtime &) = delete;
 
         void regClass(const std::shared_ptr<Class> &class_);
 
+        /// 注册本地方法，调用处在链接时直接绑定到 function，执行时不创建栈帧，也不产生 Tracer 事件
+        /// @param name 类名、方法名与描述符，例如 "java/lang/Math.sqrt(D)D"，已存在时替换
+        /// @param nothrow function 是否保证不抛出异常，只有这样的本地方法才会在 JIT 编译的代码中直接调用
+        /// @note 仅影响之后注册的类；java/lang/Math 中的常用方法以及 System.nanoTime 等已内置
+        /// @exception sese::Exception 描述符格式错误
+        void regNative(const std::string &name, NativeFunction function, bool nothrow = false);
+
         [[nodiscard]] bool hasMain() const;
 
         void run();
 
+        /// 执行已注册类中的静态方法，类尚未初始化时先执行其 <clinit>
+        /// @param class_name 类名，例如 "PiCalculator"
+        /// @param name_and_descriptor 方法名与描述符，例如 "calculatePi(I)D"
+        /// @param args 参数，long/double 占用两个 Slot
+        /// @exception sese::Exception 方法不存在、参数数量不匹配或者执行过程中抛出异常
+        /// @return 返回值，void 方法的返回值无意义
+        Slot invokeStatic(const std::string &class_name, const std::string &name_and_descriptor,
+                          const std::vector<Slot> &args);
+
+        /// 查找已注册类中的静态方法，类尚未初始化时先执行其 <clinit>
+        /// @param class_name 类名，例如 "PiCalculator"
+        /// @param name_and_descriptor 方法名与描述符，例如 "calculatePi(I)D"
+        /// @exception sese::Exception 类或者方法不存在、方法不是静态方法或者初始化失败
+        StaticMethod findStatic(const std::string &class_name, const std::string &name_and_descriptor);
+
+        /// 以 C++ 类型传递参数并取得返回值，参数直接写入被调用者的局部变量表，不经过中间的 Slot 数组
+        /// @tparam R 返回值类型，Java 的 boolean、byte、char、short、int、long、float、double 与 void
+        /// 分别对应 bool、int8_t、char16_t、int16_t、int32_t、int64_t、float、double 与 void
+        /// @param args 参数，类型按照同样的对应关系与描述符逐一匹配，不进行隐式的类型转换
+        /// @exception sese::Exception 句柄无效、参数或者返回值的类型与描述符不匹配，或者执行过程中抛出异常
+        /// @note 暂不支持引用类型的参数与返回值
+        template<typename R = void, typename... Args>
+        R invoke(const StaticMethod &method, Args... args);
+
+        /// 以多组参数批量调用同一个静态方法，每个线程只进入一次执行作用域，入口帧在每次调用时压入同一位置
+        /// @param args 参数，按组连续存放，每组占用方法参数所需的 Slot 数量，long/double 占用两个 Slot
+        /// @param results 每组参数对应的返回值，为 nullptr 时丢弃
+        /// @param count 参数的组数
+        /// @param threads 参与执行的线程数量，当前线程执行第一段，其余各段由 Runtime 常驻的工作线程执行，
+        /// 工作线程在首次使用时创建并在之后的调用中复用；不超过 1 时只在当前线程执行
+        /// @exception sese::Exception 句柄无效、参数或者返回值为引用类型，或者任意一次调用抛出异常，此时其余调用可能尚未执行
+        /// @note 参数与返回值中的引用不会随垃圾收集更新，因此只接受原始类型；
+        /// 多个线程同时批量调用时依次使用工作线程
+        void invokeBatch(const StaticMethod &method, const Slot *args, Slot *results, size_t count, size_t threads = 1);
+
+        /// 查找静态方法后调用，反复调用同一方法时应当保留 findStatic 得到的句柄
+        template<typename R = void, typename... Args>
+        R invoke(const std::string &class_name, const std::string &name_and_descriptor, Args... args) {
+            return invoke<R>(findStatic(class_name, name_and_descriptor), args...);
+        }
+
+        /// 设置方法进入与退出的监听器，为 nullptr 时关闭监听
+        /// @note 不持有监听器的生命周期，需要在执行期间保持有效；多个线程同时执行时回调会被并发调用
+        void setTracer(Tracer *tracer) { this->tracer = tracer; }
+
+        /// 设置是否在加载期将常见的字节码序列融合为超级指令，默认开启
+        /// @note 仅影响之后注册的类
+        void setFusion(bool enable) { fusion = enable; }
+
+        /// 设置字节码执行频率统计，为 nullptr 时关闭统计
+        /// @note 统计期间使用独立的解释器实例，不影响未开启统计时的派发；
+        /// 已融合的超级指令按其首条指令的通用形式计数，统计原始字节码时应同时关闭融合；
+        /// 内建函数计为 invokestatic；统计期间只应有一个线程执行
+        void setOpcodeProfile(OpcodeProfile *profile) { this->profile = profile; }
+
+        /// 设置按方法与指令的性能剖析，为 nullptr 时关闭剖析
+        /// @note 与 setOpcodeProfile 共用独立的解释器实例，开启期间不进入 JIT 编译的代码；
+        /// 统计期间只应有一个线程执行
+        void setProfiler(Profiler *profiler) { this->profiler = profiler; }
+
+        /// 设置是否使用基线 JIT 编译方法，默认关闭，平台不支持时忽略
+        /// @note 仅影响之后注册的类；编译后的代码不参与字节码频率统计与性能剖析
+        void setJit(bool enable) { jit = enable; }
+
+        /// 重新创建指定大小的堆，默认新生代 16 MiB、老年代 240 MiB
+        /// @param nursery 新生代大小，其中 eden 占 80%，两个 survivor 区各占 10%
+        /// @param old 老年代大小
+        /// @note 原有的对象全部失效，需要在执行任何字节码之前调用
+        /// @exception sese::Exception 堆过小
+        void setHeapSize(size_t nursery, size_t old);
+
+        /// 获取垃圾收集的暂停时间与晋升字节数等统计信息
+        [[nodiscard]] GcStats getGcStats() const { return heap->stats(); }
+
+        /// 获取虚方法调用的内联缓存命中与调用点状态变化等统计信息
+        /// @note JIT 编译的方法中的虚方法调用同样回到解释器派发，一并计入；
+        /// 命中与未命中次数在每次执行结束时计入，不包括仍在执行中的调用
+        [[nodiscard]] DispatchStats getDispatchStats() const;
+
     private:
         constexpr static auto main_signature = "main([Ljava/lang/String;)V";
 
-        struct Info {
-            std::shared_ptr<Class> class_{};
-            std::map<std::string, Class::MethodInfo>::iterator method;
-            StackFrame data;
+        constexpr static auto clinit_signature = "<clinit>()V";
+
+        constexpr static size_t default_nursery = 16 * 1024 * 1024;
+
+        constexpr static size_t default_old = 240 * 1024 * 1024;
+
+        struct {
+            Class *class_{};
+            Class::MethodInfo *method{};
         } main;
 
-        void run(Info &prev, Info &current);
+        /// 链接类，预解码所有方法的字节码并推导类型，随后替换内建函数、特化字段访问、进行超级指令融合与编译
+        /// @exception sese::Exception 字节码格式错误或者类型推导失败
+        void link(Class &class_);
+
+        /// 将字节码预解码为指令流，操作数转换为本机字节序，跳转偏移转换为指令下标，
+        /// 并为每个 invokevirtual/invokeinterface 调用点分配内联缓存
+        /// @param constant_count 所属类的常量池大小，用于校验常量池下标
+        /// @exception sese::Exception 字节码格式错误
+        void decode(Class::CodeInfo &code_info, size_t constant_count);
+
+        /// 将调用 Integer、Long 中位运算方法以及 System.arraycopy、Arrays.fill 的 invokestatic
+        /// 替换为对应的内建指令，调用已注册本地方法的 invokestatic 替换为 invokenative，
+        /// 这些类不会被注册，因此替换后不再需要解析方法引用；
+        /// 调用 Object 构造方法的 invokespecial 没有任何效果，替换为 pop
+        void intrinsify(const Class &class_, std::vector<Instruction> &instructions) const;
+
+        /// 注册内置的本地方法
+        void regBuiltinNatives();
+
+        /// 注册 Throwable 及运行时可能抛出的 JDK 异常类，这些类只包含空的构造方法，
+        /// 异常信息以 byte[] 形式存放在 Throwable 的隐藏字段中
+        void regBuiltinThrowables();
+
+        /// class_ 是否为 ancestor 或者其子类，class_ 为空时返回 false
+        /// @note 依赖计算布局时填充的父类，class_ 需要已经计算过布局
+        static bool isSubclassOf(const Class *class_, const Class *ancestor);
+
+        /// 创建异常对象，可能触发垃圾收集
+        /// @return 类未注册或者不是 Throwable 的子类时返回 nullptr
+        /// @exception sese::Exception 空间不足时抛出 java/lang/OutOfMemoryError
+        Object *newThrowable(const std::string &class_name, std::string_view message);
+
+        /// 将以 "java/lang/NullPointerException: 信息" 形式报告的运行时错误转换为异常对象
+        /// @return 不是 Java 异常或者对应的类未注册时返回 nullptr
+        Object *toThrowable(const char *what);
+
+        /// 以 "类名: 信息" 的形式描述异常对象，用于异常离开入口帧时转换为 sese::Exception
+        [[nodiscard]] std::string describe(const Object *exception) const;
+
+        /// 按照异常表的顺序查找覆盖指令 index 且能够捕获 exception 的处理器
+        /// @return 处理器入口的指令下标，不存在时返回 -1
+        int32_t findHandler(Class &class_, Class::CodeInfo &code_info, int32_t index, const Object *exception);
+
+        /// 按照字段描述符将 getfield/putfield 替换为读写固定宽度的特化指令，
+        /// 访问本类静态字段的 getstatic/putstatic 直接替换为读写字段地址的特化指令
+        static void specializeFields(const Class &class_, std::vector<Instruction> &instructions);
+
+        /// 字段访问指令按照字段描述符对应的特化指令
+        /// @param opcode getfield、putfield、getstatic 或者 putstatic
+        static uint16_t specializedOpcode(uint16_t opcode, std::string_view descriptor);
+
+        /// 窥孔优化，将常见的指令序列的首条指令替换为超级指令
+        static void fuse(std::vector<Instruction> &instructions);
+
+        /// 枚举当前线程 FrameStack 中所有栈帧里存放引用的 Slot、临时持有的引用以及所有类的静态引用字段，
+        /// 每个栈帧按照其当前指令处的类型推导结果区分引用，long/double 等原始类型不会被误认为引用
+        void scanRoots(const std::function<void(void *&)> &visit) const;
+
+        /// 在当前线程的 FrameStack 上压入入口帧并执行
+        Slot call(Class *class_, Class::MethodInfo *method, const Slot *args, size_t count);
 
-        
-        struct MethodRefResult {
-            std::string class_name;
-            std::string method_id;
+        /// C++ 类型对应的 Java 类型，不支持的类型为 object
+        template<typename T>
+        static constexpr Type typeOf() {
+            if constexpr (std::is_same_v<T, void>) return void_;
+            else if constexpr (std::is_same_v<T, bool>) return boolean;
+            else if constexpr (std::is_same_v<T, int8_t>) return byte;
+            else if constexpr (std::is_same_v<T, char16_t>) return char_;
+            else if constexpr (std::is_same_v<T, int16_t>) return short_;
+            else if constexpr (std::is_same_v<T, int32_t>) return int_;
+            else if constexpr (std::is_same_v<T, int64_t>) return long_;
+            else if constexpr (std::is_same_v<T, float>) return float_;
+            else if constexpr (std::is_same_v<T, double>) return double_;
+            else return object;
+        }
+
+        /// 检查参数与返回值的类型后压入入口帧，参数随后由调用者写入其局部变量表
+        /// @param types 参数的类型
+        /// @exception sese::Exception 句柄无效或者类型不匹配
+        Frame *enter(const StaticMethod &method, const Type *types, size_t count, Type result);
+
+        /// 执行 enter 压入的入口帧，异常离开时弹出残留的栈帧
+        void finish(Frame *entry_frame);
+
+        /// 在当前线程中依次执行 invokeBatch 的一段调用
+        /// @param cancel 其他线程失败时设置，之后不再开始新的调用
+        void runBatch(const StaticMethod &method, const Slot *args, Slot *results, size_t count,
+                      const std::atomic<bool> &cancel);
+
+        /// 解释器实例在每次派发时进行的统计，按位组合，每种组合对应一个独立的实例
+        enum Profiling : uint8_t {
+            no_profiling = 0,
+            /// 记录字节码执行频率，即 OpcodeProfile
+            opcode_profiling = 1,
+            /// 记录方法调用与指令执行次数，即 Profiler
+            method_profiling = 2
         };
-        static MethodRefResult getMethodRefResult(const std::shared_ptr<Class> &class_, uint16_t index);
+
+        /// 执行入口帧直至其返回，根据开启的统计选择解释器实例
+        /// @param entry_frame 已压入当前线程 FrameStack 的入口帧，返回值写入其局部变量表起始位置
+        void execute(Frame *entry_frame);
+
+        /// 解释器主循环，在同一个循环中处理方法调用与返回，直至入口帧返回
+        /// @tparam profiling 每次派发时进行的统计，见 Profiling
+        /// @param table 不为空时仅导出 computed goto 派发表，不执行任何字节码
+        template<uint8_t profiling>
+        void interpret(Frame *entry_frame, const void **table);
+
+        /// 获取 computed goto 派发表，switch 模式下返回 nullptr
+        const void *const *dispatchTable();
+
+        /// 解析方法引用并写入常量池缓存，方法可能继承自父类或者接口，此时 class_ 为声明该方法的类；
+        /// 静态方法同时初始化其所属的类，类正在由当前线程初始化时不写入缓存
+        /// @exception sese::Exception 类未注册、方法不存在或者初始化失败
+        const Class::ResolvedEntry &resolveMethod(Class &class_, uint16_t index);
+
+        /// 构建虚方法表与接口方法表，父类与接口需要已经计算过布局
+        void linkMethods(Class &class_);
+
+        /// 在 class_ 及其父类中查找已分配虚方法表下标的方法，class_ 为空时返回 nullptr
+        static const Class::MethodInfo *findVirtual(const Class *class_, const std::string &key);
+
+        /// 按照先子接口后父接口的顺序收集 class_ 直接实现的接口及其父接口，已收集的接口不再重复
+        static void collectInterfaces(const Class &class_, std::vector<Class *> &interfaces);
+
+        /// 按照 JVM 规范的方法解析顺序，依次在类及其父类、再在其实现的接口中查找方法
+        /// @param key 方法名与描述符
+        /// @return 方法及其所在的类，不存在时均为空
+        static Class::VirtualEntry findMethod(Class &class_, const std::string &key);
+
+        /// 根据接收者的实际类型选择已解析方法的实现，私有方法直接调用，其他实例方法查询虚方法表，
+        /// 接口方法查询接口方法表
+        /// @exception sese::Exception 接收者未实现该方法时抛出 java/lang/IncompatibleClassChangeError，
+        /// 选择得到抽象方法时抛出 java/lang/AbstractMethodError
+        static Class::VirtualEntry selectMethod(const Object *receiver, const Class::ResolvedEntry &resolved);
+
+        /// 内联缓存未命中时选择实现方法，缓存未满时记录接收者的类，已满时将调用点标记为超多态
+        /// @exception sese::Exception 同 selectMethod
+        Class::VirtualEntry dispatchMiss(Class::InlineCache &cache, const Object *receiver,
+                                         const Class::ResolvedEntry &resolved);
+
+        /// 解析 new 指令引用的类并写入常量池缓存，同时计算其实例布局并初始化
+        /// @note 类正在由当前线程初始化时不写入缓存
+        /// @exception sese::Exception 类未注册或者初始化失败
+        const Class::ResolvedEntry &resolveClass(Class &class_, uint16_t index);
+
+        /// 解析静态字段引用，依次在引用的类及其父类中查找，并初始化声明该字段的类
+        /// @note 只有声明该字段的类完成初始化后才写入缓存，此时 resolved 为 true
+        /// @exception sese::Exception 类未注册、字段不存在、不是静态字段或者初始化失败
+        const Class::ResolvedEntry &resolveStaticField(Class &class_, uint16_t index);
+
+        /// 初始化类，先初始化父类，再执行 <clinit>，每个类只执行一次；
+        /// 正在初始化的类直接返回，<clinit> 中访问本类不会递归初始化
+        /// @exception sese::Exception <clinit> 抛出 Error 时原样传播，其他异常包装为
+        /// java/lang/ExceptionInInitializerError；曾经初始化失败的类抛出 java/lang/NoClassDefFoundError
+        void initialize(Class &class_);
+
+        /// 分配静态字段存储，并按照 ConstantValue 属性写入常量字段的初值
+        void layoutStatics(Class &class_);
+
+        /// 解析实例字段引用并写入常量池缓存，依次在引用的类及其父类中查找
+        /// @exception sese::Exception 类未注册、字段不存在或者为静态字段
+        const Class::ResolvedEntry &resolveField(Class &class_, uint16_t index);
+
+        /// 计算实例字段布局，父类的字段位于子类之前，
+        /// 子类的字段按照大小降序排列并按自身大小对齐，以减少填充；随后解析实现的接口并构建虚方法表
+        /// @exception sese::Exception 父类未注册
+        void layout(Class &class_);
+
+        /// multianewarray，自外向内依次创建各维数组，构造期间外层数组作为临时根保持可达
+        /// @param descriptor 数组类型描述符，例如 "[[J"，维数不少于 dims
+        /// @param counts 各维长度，依次对应从外到内的维度
+        /// @exception sese::Exception 任一长度为负数时抛出 java/lang/NegativeArraySizeException，
+        /// 空间不足时抛出 java/lang/OutOfMemoryError
+        Array *newMultiArray(std::string_view descriptor, const Slot *counts, int32_t dims);
+
+        /// System.arraycopy，元素类型相同时整体 memmove，允许源与目标区间重叠
+        /// @note 引用数组不检查元素的实际类型
+        /// @exception sese::Exception 参数为 null、不是数组、元素类型不匹配或者越界时
+        /// 抛出对应的 Java 异常
+        void copyArray(void *src, int32_t src_pos, void *dest, int32_t dest_pos, int32_t length);
+
+        /// Arrays.fill，填充 [from, to) 区间，按照数组的元素类型截取 value
+        /// @param value 填充的值，long/double 占用两个 Slot
+        /// @exception sese::Exception 数组为 null 或者越界时抛出对应的 Java 异常
+        void fillArray(void *array, int32_t from, int32_t to, const Slot *value);
+
+        /// 解析 ldc 系列指令引用的常量并写入常量池缓存
+        /// @param wide 是否为 ldc2_w 加载的 long/double
+        /// @exception sese::Exception 常量类型与指令不匹配
+        const Class::ResolvedEntry &resolveConstant(Class &class_, uint16_t index, bool wide);
 
 
         std::unordered_map<std::string, std::shared_ptr<Class> > classes;
+
+        /// 保护执行期间对类的延迟修改：常量池缓存的填充、布局与方法表的构建、初始化状态的变化以及异常处理器的解析；
+        /// 持有期间不会执行字节码，也不会等待安全点
+        std::mutex link_mutex;
+
+        /// 类初始化完成或者失败时通知等待的线程，与 link_mutex 配合使用
+        std::condition_variable init_condition;
+
+        /// 保护内联缓存的追加
+        std::mutex dispatch_mutex;
+
+        /// 需要先于堆构造、后于堆析构
+        Safepoint safepoint;
+
+        std::unique_ptr<Heap> heap;
+
+        /// invokeBatch 的工作线程，先于堆析构
+        WorkerPool workers;
+
+        /// 本地方法表，invokenative 指令按照下标访问
+        std::vector<NativeMethod> natives;
+
+        std::unordered_map<std::string, int32_t> native_indices;
+
+        Class *throwable{};
+
+        /// Throwable 中异常信息字段的偏移
+        uint32_t message_offset{};
+
+        /// 内联缓存的统计，命中与未命中次数由解释器在本地累计，退出时一并计入
+        struct {
+            std::atomic<uint64_t> hits{};
+            std::atomic<uint64_t> misses{};
+            std::atomic<uint64_t> polymorphic_transitions{};
+            std::atomic<uint64_t> megamorphic_transitions{};
+        } dispatch_stats;
+
+        Tracer *tracer{};
+
+        OpcodeProfile *profile{};
+
+        Profiler *profiler{};
+
+        bool fusion{true};
+
+        bool jit{false};
     };
+
+    template<typename R, typename... Args>
+    R Runtime::invoke(const StaticMethod &method, Args... args) {
+        static_assert(typeOf<R>() != object, "unsupported result type");
+        static_assert(((typeOf<Args>() != object && typeOf<Args>() != void_) && ...), "unsupported argument type");
+        // 末尾的 void_ 使无参数时数组依然合法
+        static constexpr Type types[] = {typeOf<Args>()..., void_};
+        Safepoint::Scope scope(safepoint);
+        auto entry_frame = enter(method, types, sizeof...(Args), typeOf<R>());
+        auto slot = entry_frame->locals;
+        // 无参数时折叠表达式为空，store 不会被调用
+        [[maybe_unused]] auto store = [&slot](auto value) {
+            using T = decltype(value);
+            if constexpr (std::is_same_v<T, int64_t>) {
+                slot->l = value;
+                slot += 2;
+            } else if constexpr (std::is_same_v<T, double>) {
+                slot->d = value;
+                slot += 2;
+            } else if constexpr (std::is_same_v<T, float>) {
+                (slot++)->f = value;
+            } else {
+                (slot++)->i = static_cast<int32_t>(value);
+            }
+        };
+        (store(args), ...);
+        finish(entry_frame);
+        // 入口帧已经弹出，返回值依然位于其局部变量表起始位置
+        auto &&result = entry_frame->locals[0];
+        if constexpr (std::is_same_v<R, void>) {
+            return;
+        } else if constexpr (std::is_same_v<R, bool>) {
+            return result.i != 0;
+        } else if constexpr (std::is_same_v<R, int64_t>) {
+            return result.l;
+        } else if constexpr (std::is_same_v<R, float>) {
+            return result.f;
+        } else if constexpr (std::is_same_v<R, double>) {
+            return result.d;
+        } else {
+            return static_cast<R>(result.i);
+        }
+    }
 }
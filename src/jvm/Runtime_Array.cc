@@ -0,0 +1,168 @@
+#include "Runtime.h"
+
+#include <sese/util/Exception.h>
+
+#include <algorithm>
+#include <cstring>
+
+namespace {
+    using jvm::Array;
+
+    /// 数组类型描述符中元素类型的首字符对应的元素类型
+    Array::Element elementOf(char descriptor) {
+        switch (descriptor) {
+            case 'Z':
+                return Array::t_boolean;
+            case 'C':
+                return Array::t_char;
+            case 'F':
+                return Array::t_float;
+            case 'D':
+                return Array::t_double;
+            case 'B':
+                return Array::t_byte;
+            case 'S':
+                return Array::t_short;
+            case 'I':
+                return Array::t_int;
+            case 'J':
+                return Array::t_long;
+            default:
+                return Array::t_reference;
+        }
+    }
+
+    /// 自外向内递归创建，外层数组在创建内层数组期间保存在 handles 中，收集后从中重新读取
+    Array *build(jvm::Heap &heap, std::vector<void *> &handles, std::string_view descriptor,
+                 const jvm::Slot *counts, int32_t dims) {
+        auto array = heap.allocateArray(elementOf(descriptor[1]), counts[0].i);
+        if (dims == 1) return array;
+        auto index = handles.size();
+        handles.push_back(array);
+        for (int32_t i = 0; i < counts[0].i; ++i) {
+            void *element = build(heap, handles, descriptor.substr(1), counts + 1, dims - 1);
+            auto outer = static_cast<Array *>(handles[index]);
+            memcpy(outer->data() + i * sizeof(void *), &element, sizeof(void *));
+            heap.writeBarrier(outer);
+        }
+        array = static_cast<Array *>(handles[index]);
+        handles.pop_back();
+        return array;
+    }
+
+    /// 以 size 字节的元素重复填充 count 次，各字节相同时退化为 memset，
+    /// 否则写入首个元素后每次复制已填充的部分，使其长度翻倍，每次都是大块的连续复制
+    void repeat(uint8_t *begin, size_t count, const uint8_t *element, size_t size) {
+        auto total = count * size;
+        if (total == 0) return;
+        if (std::all_of(element, element + size, [&](uint8_t byte) { return byte == element[0]; })) {
+            memset(begin, element[0], total);
+            return;
+        }
+        memcpy(begin, element, size);
+        for (size_t filled = size; filled < total; filled *= 2) {
+            memcpy(begin + filled, begin, std::min(filled, total - filled));
+        }
+    }
+
+    [[noreturn]] void outOfBounds(const std::string &message) {
+        throw sese::Exception("java/lang/ArrayIndexOutOfBoundsException: " + message);
+    }
+}
+
+jvm::Array *jvm::Runtime::newMultiArray(std::string_view descriptor, const Slot *counts, int32_t dims) {
+    // 任一维度的长度为负数时，即使外层长度为 0 也需要抛出异常
+    for (int32_t i = 0; i < dims; ++i) {
+        if (counts[i].i < 0) {
+            throw sese::Exception("java/lang/NegativeArraySizeException: " + std::to_string(counts[i].i));
+        }
+    }
+    auto &&handles = FrameStack::current().handles();
+    auto mark = handles.size();
+    try {
+        return build(*heap, handles, descriptor, counts, dims);
+    } catch (...) {
+        handles.resize(mark);
+        throw;
+    }
+}
+
+void jvm::Runtime::copyArray(void *src, int32_t src_pos, void *dest, int32_t dest_pos, int32_t length) {
+    if (src == nullptr || dest == nullptr) throw sese::Exception("java/lang/NullPointerException");
+    auto from = static_cast<Array *>(src);
+    auto to = static_cast<Array *>(dest);
+    if (!(from->flags & Object::array)) {
+        throw sese::Exception("java/lang/ArrayStoreException: arraycopy: source type is not an array");
+    }
+    if (!(to->flags & Object::array)) {
+        throw sese::Exception("java/lang/ArrayStoreException: arraycopy: destination type is not an array");
+    }
+    if (from->element != to->element) {
+        throw sese::Exception("java/lang/ArrayStoreException: arraycopy: type mismatch");
+    }
+    if (src_pos < 0) {
+        outOfBounds("arraycopy: source index " + std::to_string(src_pos) + " out of bounds for length " +
+                    std::to_string(from->length));
+    }
+    if (dest_pos < 0) {
+        outOfBounds("arraycopy: destination index " + std::to_string(dest_pos) + " out of bounds for length " +
+                    std::to_string(to->length));
+    }
+    if (length < 0) {
+        outOfBounds("arraycopy: length " + std::to_string(length) + " is negative");
+    }
+    if (src_pos > from->length - length) {
+        outOfBounds("arraycopy: last source index " + std::to_string(static_cast<int64_t>(src_pos) + length) +
+                    " out of bounds for length " + std::to_string(from->length));
+    }
+    if (dest_pos > to->length - length) {
+        outOfBounds("arraycopy: last destination index " + std::to_string(static_cast<int64_t>(dest_pos) + length) +
+                    " out of bounds for length " + std::to_string(to->length));
+    }
+    auto size = Array::elementSize(from->element);
+    memmove(to->data() + static_cast<size_t>(dest_pos) * size, from->data() + static_cast<size_t>(src_pos) * size,
+            static_cast<size_t>(length) * size);
+    if (from->element == Array::t_reference && length) {
+        heap->writeBarrier(to);
+    }
+}
+
+void jvm::Runtime::fillArray(void *array, int32_t from, int32_t to, const Slot *value) {
+    if (array == nullptr) throw sese::Exception("java/lang/NullPointerException");
+    auto target = static_cast<Array *>(array);
+    if (from > to) {
+        throw sese::Exception("java/lang/IllegalArgumentException: fromIndex(" + std::to_string(from) +
+                              ") > toIndex(" + std::to_string(to) + ")");
+    }
+    if (from < 0) outOfBounds("Array index out of range: " + std::to_string(from));
+    if (to > target->length) outOfBounds("Array index out of range: " + std::to_string(to));
+    // 按照本机字节序取出值的低位部分，与元素的存放方式一致
+    uint8_t element[8];
+    auto size = Array::elementSize(target->element);
+    switch (target->element) {
+        case Array::t_boolean:
+        case Array::t_byte:
+            element[0] = static_cast<uint8_t>(value->i);
+            break;
+        case Array::t_char:
+        case Array::t_short: {
+            auto narrow = static_cast<uint16_t>(value->i);
+            memcpy(element, &narrow, sizeof(narrow));
+            break;
+        }
+        case Array::t_int:
+        case Array::t_float:
+            memcpy(element, &value->i, sizeof(value->i));
+            break;
+        case Array::t_reference:
+            memcpy(element, &value->ref, sizeof(value->ref));
+            break;
+        default:
+            memcpy(element, &value->l, sizeof(value->l));
+            break;
+    }
+    repeat(target->data() + static_cast<size_t>(from) * size, static_cast<size_t>(to - from), element, size);
+    if (target->element == Array::t_reference && value->ref && from < to) {
+        heap->writeBarrier(target);
+    }
+}
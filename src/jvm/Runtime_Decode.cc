@@ -0,0 +1,444 @@
+#include "Jit.h"
+#include "Opcode.h"
+#include "Runtime.h"
+#include "Verifier.h"
+
+#include <sese/util/Endian.h>
+#include <sese/util/Exception.h>
+
+#include <algorithm>
+#include <cstring>
+
+namespace {
+    /// 读取字节码中的大端操作数
+    class CodeReader {
+    public:
+        explicit CodeReader(std::string_view code) : code(code) {}
+
+        [[nodiscard]] uint8_t u1(size_t pos) const {
+            check(pos, 1);
+            return static_cast<uint8_t>(code[pos]);
+        }
+
+        [[nodiscard]] int8_t s1(size_t pos) const {
+            return static_cast<int8_t>(u1(pos));
+        }
+
+        [[nodiscard]] uint16_t u2(size_t pos) const {
+            check(pos, 2);
+            uint16_t value;
+            memcpy(&value, &code[pos], 2);
+            return FromBigEndian16(value);
+        }
+
+        [[nodiscard]] int16_t s2(size_t pos) const {
+            return static_cast<int16_t>(u2(pos));
+        }
+
+        [[nodiscard]] int32_t s4(size_t pos) const {
+            check(pos, 4);
+            uint32_t value;
+            memcpy(&value, &code[pos], 4);
+            return static_cast<int32_t>(FromBigEndian32(value));
+        }
+
+        /// 检查 pos 起的 length 个字节均在字节码范围内
+        void check(size_t pos, size_t length) const {
+            if (pos + length > code.size()) throw sese::Exception("truncated bytecode");
+        }
+
+    private:
+        std::string_view code;
+    };
+
+    /// 计算 pc 处指令的字节长度，不检查指令是否超出字节码末尾
+    size_t encodedLength(const CodeReader &reader, size_t pc) {
+        using namespace jvm;
+        auto op = reader.u1(pc);
+        switch (op) {
+            case bipush:
+            case ldc:
+            case iload:
+            case lload:
+            case fload:
+            case dload:
+            case aload:
+            case istore:
+            case lstore:
+            case fstore:
+            case dstore:
+            case astore:
+            case ret:
+            case newarray:
+                return 2;
+            case sipush:
+            case ldc_w:
+            case ldc2_w:
+            case iinc:
+            case getstatic:
+            case putstatic:
+            case getfield:
+            case putfield:
+            case invokevirtual:
+            case invokespecial:
+            case invokestatic:
+            case new_:
+            case anewarray:
+            case checkcast:
+            case instanceof:
+            case ifnull:
+            case ifnonnull:
+                return 3;
+            case multianewarray:
+                return 4;
+            case invokeinterface:
+            case invokedynamic:
+            case goto_w:
+            case jsr_w:
+                return 5;
+            case wide:
+                return reader.u1(pc + 1) == iinc ? 6 : 4;
+            case tableswitch: {
+                auto base = (pc + 4) & ~static_cast<size_t>(3);
+                auto low = reader.s4(base + 4);
+                auto high = reader.s4(base + 8);
+                if (low > high) throw sese::Exception("illegal tableswitch range");
+                return base + 12 + 4 * (static_cast<size_t>(high) - low + 1) - pc;
+            }
+            case lookupswitch: {
+                auto base = (pc + 4) & ~static_cast<size_t>(3);
+                auto pairs = reader.s4(base + 4);
+                if (pairs < 0) throw sese::Exception("illegal lookupswitch pairs");
+                return base + 8 + 8 * static_cast<size_t>(pairs) - pc;
+            }
+            default:
+                if (op >= ifeq && op <= jsr) return 3;
+                return 1;
+        }
+    }
+
+    /// 计算 pc 处指令的字节长度，指令超出字节码末尾时抛出异常，
+    /// 因此 switch 的跳转表在解码前已经确认完整
+    size_t instructionLength(const CodeReader &reader, size_t pc) {
+        auto length = encodedLength(reader, pc);
+        reader.check(pc, length);
+        return length;
+    }
+
+    bool isIload(uint16_t opcode) {
+        return opcode == jvm::iload || (opcode >= jvm::iload_0 && opcode <= jvm::iload_3);
+    }
+
+    bool isDload(uint16_t opcode) {
+        return opcode == jvm::dload || (opcode >= jvm::dload_0 && opcode <= jvm::dload_3);
+    }
+
+    bool isDstore(uint16_t opcode) {
+        return opcode == jvm::dstore || (opcode >= jvm::dstore_0 && opcode <= jvm::dstore_3);
+    }
+}
+
+void jvm::Runtime::link(Class &class_) {
+    class_.resolved_entries = std::make_unique<Class::ResolvedEntry[]>(class_.constant_infos.size());
+    layoutStatics(class_);
+    for (auto &&[_, method]: class_.method_infos) {
+        if (method.code_info) {
+            auto &&code_info = *method.code_info;
+            decode(code_info, class_.constant_infos.size());
+            Verifier::verify(class_, method, code_info);
+            intrinsify(class_, code_info.instructions);
+            specializeFields(class_, code_info.instructions);
+            if (fusion) {
+                fuse(code_info.instructions);
+            }
+            if (auto table = dispatchTable()) {
+                for (auto &&insn: code_info.instructions) {
+                    insn.handler = table[insn.opcode];
+                }
+            }
+            method.code_info->native = nullptr;
+            if (jit) {
+                Jit::compile(class_, *method.code_info, natives, safepoint.flag());
+            }
+        }
+    }
+}
+
+void jvm::Runtime::decode(Class::CodeInfo &code_info, size_t constant_count) {
+    auto &&code = code_info.code;
+    if (code.empty() || code.size() > UINT16_MAX) throw sese::Exception("illegal code length");
+    CodeReader reader(code);
+
+    // 第一遍确定每条指令的边界，用于将跳转偏移转换为指令下标
+    std::vector<int32_t> index_of_pc(code.size() + 1, -1);
+    int32_t count = 0;
+    for (size_t pc = 0; pc < code.size(); pc += instructionLength(reader, pc)) {
+        index_of_pc[pc] = count++;
+    }
+
+    auto target = [&](size_t pc, int32_t offset) -> int32_t {
+        auto dest = static_cast<int64_t>(pc) + offset;
+        if (dest < 0 || dest >= static_cast<int64_t>(code.size()) || index_of_pc[dest] < 0) {
+            throw sese::Exception("illegal branch target");
+        }
+        return index_of_pc[dest];
+    };
+
+    auto constant = [&](uint16_t index) -> int32_t {
+        if (index == 0 || index >= constant_count) throw sese::Exception("illegal constant pool index");
+        return index;
+    };
+
+    auto &&instructions = code_info.instructions;
+    instructions.clear();
+    instructions.reserve(count + 1);
+    auto &&tables = code_info.switch_tables;
+    tables.clear();
+    // 内联缓存含有原子变量而无法移动，先统计调用点数量，解码结束后一次分配
+    uint32_t call_sites = 0;
+    for (size_t pc = 0; pc < code.size(); pc += instructionLength(reader, pc)) {
+        Instruction insn;
+        insn.opcode = static_cast<uint8_t>(code[pc]);
+        insn.pc = static_cast<uint16_t>(pc);
+        switch (insn.opcode) {
+            case bipush:
+                insn.a = reader.s1(pc + 1);
+                break;
+            case ldc:
+                insn.a = constant(reader.u1(pc + 1));
+                break;
+            case iload:
+            case lload:
+            case fload:
+            case dload:
+            case aload:
+            case istore:
+            case lstore:
+            case fstore:
+            case dstore:
+            case astore:
+            case ret:
+            case newarray:
+                insn.a = reader.u1(pc + 1);
+                break;
+            case sipush:
+                insn.a = reader.s2(pc + 1);
+                break;
+            case invokevirtual:
+                insn.a = constant(reader.u2(pc + 1));
+                insn.c = static_cast<int32_t>(call_sites++);
+                break;
+            case ldc_w:
+            case ldc2_w:
+            case getstatic:
+            case putstatic:
+            case getfield:
+            case putfield:
+            case invokespecial:
+            case invokestatic:
+            case invokedynamic:
+            case new_:
+            case anewarray:
+            case checkcast:
+            case instanceof:
+                insn.a = constant(reader.u2(pc + 1));
+                break;
+            case invokeinterface:
+                insn.a = constant(reader.u2(pc + 1));
+                insn.b = reader.u1(pc + 3);
+                insn.c = static_cast<int32_t>(call_sites++);
+                break;
+            case multianewarray:
+                insn.a = constant(reader.u2(pc + 1));
+                insn.b = reader.u1(pc + 3);
+                break;
+            case iinc:
+                insn.a = reader.u1(pc + 1);
+                insn.b = reader.s1(pc + 2);
+                break;
+            case wide: {
+                // wide 前缀直接展开为带 16 位下标的原指令
+                insn.opcode = reader.u1(pc + 1);
+                insn.a = reader.u2(pc + 2);
+                if (insn.opcode == iinc) {
+                    insn.b = reader.s2(pc + 4);
+                } else if (!(insn.opcode >= iload && insn.opcode <= aload) &&
+                           !(insn.opcode >= istore && insn.opcode <= astore) &&
+                           insn.opcode != ret) {
+                    throw sese::Exception("illegal wide instruction");
+                }
+                break;
+            }
+            case goto_w:
+            case jsr_w:
+                insn.opcode = insn.opcode == goto_w ? goto_ : jsr;
+                insn.a = target(pc, reader.s4(pc + 1));
+                break;
+            case ifnull:
+            case ifnonnull:
+                insn.a = target(pc, reader.s2(pc + 1));
+                break;
+            case tableswitch: {
+                // 操作数从下一个 4 字节对齐的位置开始，范围已在计算指令长度时检查
+                auto base = (pc + 4) & ~static_cast<size_t>(3);
+                auto low = reader.s4(base + 4);
+                auto high = reader.s4(base + 8);
+                auto entries = static_cast<int64_t>(high) - low + 1;
+                insn.a = target(pc, reader.s4(base));
+                insn.b = low;
+                insn.c = static_cast<int32_t>(tables.size());
+                tables.push_back(static_cast<int32_t>(entries));
+                for (int64_t k = 0; k < entries; ++k) {
+                    tables.push_back(target(pc, reader.s4(base + 12 + 4 * static_cast<size_t>(k))));
+                }
+                break;
+            }
+            case lookupswitch: {
+                // 键值对数量同样已在计算指令长度时检查
+                auto base = (pc + 4) & ~static_cast<size_t>(3);
+                auto pairs = static_cast<size_t>(reader.s4(base + 4));
+                std::vector<std::pair<int32_t, int32_t> > entries(pairs);
+                for (size_t k = 0; k < pairs; ++k) {
+                    entries[k].first = reader.s4(base + 8 + 8 * k);
+                    entries[k].second = target(pc, reader.s4(base + 12 + 8 * k));
+                }
+                std::sort(entries.begin(), entries.end());
+                for (size_t k = 1; k < pairs; ++k) {
+                    if (entries[k - 1].first == entries[k].first) throw sese::Exception("duplicate lookupswitch key");
+                }
+                insn.a = target(pc, reader.s4(base));
+                insn.c = static_cast<int32_t>(tables.size());
+                auto range = pairs ? static_cast<int64_t>(entries.back().first) - entries.front().first + 1 : 0;
+                if (pairs && range <= 2 * static_cast<int64_t>(pairs)) {
+                    // 键足够密集，按照跳转表处理，空缺的键跳转至默认目标
+                    insn.opcode = tableswitch;
+                    insn.b = entries.front().first;
+                    tables.push_back(static_cast<int32_t>(range));
+                    auto first = tables.size();
+                    tables.resize(first + static_cast<size_t>(range), insn.a);
+                    for (auto &&[key, index]: entries) {
+                        tables[first + static_cast<size_t>(static_cast<int64_t>(key) - insn.b)] = index;
+                    }
+                } else {
+                    tables.push_back(static_cast<int32_t>(pairs));
+                    for (auto &&entry: entries) tables.push_back(entry.first);
+                    for (auto &&entry: entries) tables.push_back(entry.second);
+                }
+                break;
+            }
+            default:
+                if (insn.opcode >= iload_0 && insn.opcode <= aload_3) {
+                    insn.a = (insn.opcode - iload_0) % 4;
+                } else if (insn.opcode >= istore_0 && insn.opcode <= astore_3) {
+                    insn.a = (insn.opcode - istore_0) % 4;
+                } else if (insn.opcode >= ifeq && insn.opcode <= jsr) {
+                    insn.a = target(pc, reader.s2(pc + 1));
+                }
+                break;
+        }
+        instructions.push_back(insn);
+    }
+    Instruction end;
+    end.opcode = end_of_code;
+    end.pc = static_cast<uint16_t>(code.size() - 1);
+    instructions.push_back(end);
+    code_info.inline_caches = std::vector<Class::InlineCache>(call_sites);
+
+    // 异常表中的 end_pc 可以等于代码长度，对应末尾的 end_of_code
+    index_of_pc[code.size()] = count;
+    auto &&handlers = code_info.handlers;
+    handlers.clear();
+    for (auto &&info: code_info.exception_infos) {
+        if (info.from >= code.size() || info.to > code.size() || info.target >= code.size() ||
+            index_of_pc[info.from] < 0 || index_of_pc[info.to] < 0 || index_of_pc[info.target] < 0 ||
+            info.from >= info.to) {
+            throw sese::Exception("illegal exception table");
+        }
+        Class::HandlerInfo handler;
+        handler.from = index_of_pc[info.from];
+        handler.to = index_of_pc[info.to];
+        handler.target = index_of_pc[info.target];
+        handler.catch_type = info.type;
+        if (handler.catch_type != 0) constant(handler.catch_type);
+        handlers.push_back(handler);
+    }
+}
+
+void jvm::Runtime::specializeFields(const Class &class_, std::vector<Instruction> &instructions) {
+    auto this_name = class_.getThisName();
+    for (auto &&insn: instructions) {
+        if (insn.opcode == getfield || insn.opcode == putfield) {
+            // 描述符已在类型推导时访问过，此处不会越界
+            insn.opcode = specializedOpcode(insn.opcode, class_.getMemberRef(static_cast<uint16_t>(insn.a)).descriptor);
+            continue;
+        }
+        if (insn.opcode != getstatic && insn.opcode != putstatic) continue;
+        // 本类的方法开始执行时本类必然已经开始初始化，访问本类声明的静态字段无需经过初始化检查
+        auto ref = class_.getMemberRef(static_cast<uint16_t>(insn.a));
+        if (ref.class_name != this_name) continue;
+        for (auto &&field: class_.field_infos) {
+            if (!field.isStatic() || field.name != ref.name || field.descriptor != ref.descriptor) continue;
+            insn.opcode = specializedOpcode(insn.opcode, ref.descriptor);
+            setStaticAddress(insn, reinterpret_cast<uint8_t *>(&class_.statics[field.offset]));
+            break;
+        }
+    }
+}
+
+uint16_t jvm::Runtime::specializedOpcode(uint16_t opcode, std::string_view descriptor) {
+    auto get = opcode == getfield || opcode == getstatic;
+    uint16_t result;
+    switch (descriptor[0]) {
+        case 'Z':
+            result = get ? getfield_byte : putfield_boolean;
+            break;
+        case 'B':
+            result = get ? getfield_byte : putfield_byte;
+            break;
+        case 'C':
+            result = get ? getfield_char : putfield_short;
+            break;
+        case 'S':
+            result = get ? getfield_short : putfield_short;
+            break;
+        case 'I':
+        case 'F':
+            result = get ? getfield_int : putfield_int;
+            break;
+        case 'J':
+        case 'D':
+            result = get ? getfield_long : putfield_long;
+            break;
+        default:
+            result = get ? getfield_ref : putfield_ref;
+            break;
+    }
+    // 静态字段的特化指令与实例字段按照相同的顺序排列
+    static_assert(getstatic_byte - getfield_byte == putstatic_ref - putfield_ref);
+    if (opcode == getstatic || opcode == putstatic) result += getstatic_byte - getfield_byte;
+    return result;
+}
+
+void jvm::Runtime::fuse(std::vector<Instruction> &instructions) {
+    // 末尾的 end_of_code 不参与匹配，因此访问 insn[1]、insn[2] 不会越界
+    for (size_t i = 0; i + 1 < instructions.size(); ++i) {
+        auto insn = &instructions[i];
+        auto first = insn[0].opcode;
+        auto second = insn[1].opcode;
+        auto third = i + 2 < instructions.size() ? insn[2].opcode : static_cast<uint16_t>(end_of_code);
+        if (isIload(first) && isIload(second) && third >= if_icmpeq && third <= if_icmple) {
+            insn->opcode = iload_iload_if_icmpeq + (third - if_icmpeq);
+            insn->b = insn[1].a;
+            insn->c = insn[2].a;
+        } else if (isIload(first) && second == irem && (third == ifeq || third == ifne)) {
+            insn->opcode = third == ifeq ? iload_irem_ifeq : iload_irem_ifne;
+            insn->c = insn[2].a;
+        } else if (first == iinc && second == goto_) {
+            insn->opcode = iinc_goto;
+            insn->c = insn[1].a;
+        } else if (isDload(first) && (second == dadd || second == dsub) && isDstore(third)) {
+            insn->opcode = second == dadd ? dload_dadd_dstore : dload_dsub_dstore;
+            insn->c = insn[2].a;
+        }
+    }
+}
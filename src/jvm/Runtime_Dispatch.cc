@@ -0,0 +1,167 @@
+#include "Runtime.h"
+#include "Object.h"
+
+#include <sese/util/Exception.h>
+
+#include <algorithm>
+
+namespace {
+    using jvm::Class;
+
+    /// 参与虚方法派发的实例方法，静态方法、私有方法以及 <init> 等特殊方法直接调用
+    bool isVirtual(const Class::MethodInfo &method) {
+        return !method.isStatic() && !method.isPrivate() && method.name.front() != '<';
+    }
+}
+
+const jvm::Class::MethodInfo *jvm::Runtime::findVirtual(const Class *class_, const std::string &key) {
+    for (auto owner = class_; owner; owner = owner->super) {
+        auto iter = owner->method_infos.find(key);
+        if (iter != owner->method_infos.end() && iter->second.table_index >= 0) return &iter->second;
+    }
+    return nullptr;
+}
+
+void jvm::Runtime::collectInterfaces(const Class &class_, std::vector<Class *> &interfaces) {
+    for (auto &&interface: class_.super_interfaces) {
+        if (std::find(interfaces.begin(), interfaces.end(), interface) != interfaces.end()) continue;
+        interfaces.push_back(interface);
+        collectInterfaces(*interface, interfaces);
+    }
+}
+
+void jvm::Runtime::linkMethods(Class &class_) {
+    if (class_.isInterface()) {
+        for (auto &&[key, method]: class_.method_infos) {
+            if (!isVirtual(method)) continue;
+            method.table_index = static_cast<int32_t>(class_.vtable.size());
+            class_.vtable.push_back({&class_, &method});
+        }
+        return;
+    }
+    if (class_.super) {
+        class_.vtable = class_.super->vtable;
+    }
+    for (auto &&[key, method]: class_.method_infos) {
+        if (!isVirtual(method)) continue;
+        auto overridden = findVirtual(class_.super, key);
+        if (overridden) {
+            method.table_index = overridden->table_index;
+            class_.vtable[method.table_index] = {&class_, &method};
+        } else {
+            method.table_index = static_cast<int32_t>(class_.vtable.size());
+            class_.vtable.push_back({&class_, &method});
+        }
+    }
+
+    // 父类实现的接口同样需要接口方法表，其中的方法可能被本类重写
+    std::vector<Class *> interfaces;
+    collectInterfaces(class_, interfaces);
+    if (class_.super) {
+        for (auto &&[interface, _]: class_.super->itables) {
+            if (std::find(interfaces.begin(), interfaces.end(), interface) == interfaces.end()) {
+                interfaces.push_back(interface);
+            }
+        }
+    }
+    for (auto &&interface: interfaces) {
+        auto table = interface->vtable;
+        for (auto &&[key, method]: interface->method_infos) {
+            if (method.table_index < 0) continue;
+            if (auto implementation = findVirtual(&class_, key)) {
+                table[method.table_index] = class_.vtable[implementation->table_index];
+                continue;
+            }
+            // 类及其父类没有实现时选择默认方法，先收集的子接口优先
+            for (auto &&candidate: interfaces) {
+                auto iter = candidate->method_infos.find(key);
+                if (iter != candidate->method_infos.end() && iter->second.table_index >= 0 &&
+                    iter->second.code_info) {
+                    table[method.table_index] = {candidate, &iter->second};
+                    break;
+                }
+            }
+        }
+        class_.itables.emplace_back(interface, std::move(table));
+    }
+}
+
+jvm::Class::VirtualEntry jvm::Runtime::findMethod(Class &class_, const std::string &key) {
+    for (auto owner = &class_; owner; owner = owner->super) {
+        auto iter = owner->method_infos.find(key);
+        if (iter != owner->method_infos.end()) return {owner, &iter->second};
+    }
+    for (auto owner = &class_; owner; owner = owner->super) {
+        for (auto &&interface: owner->super_interfaces) {
+            auto found = findMethod(*interface, key);
+            if (found.method && !found.method->isStatic()) return found;
+        }
+    }
+    return {};
+}
+
+jvm::Class::VirtualEntry jvm::Runtime::selectMethod(const Object *receiver, const Class::ResolvedEntry &resolved) {
+    auto method = resolved.method;
+    if (method->table_index < 0) {
+        return {resolved.class_, method};
+    }
+    auto class_ = receiver->class_;
+    Class::VirtualEntry target{};
+    if (resolved.class_->isInterface()) {
+        // 数组的 class_ 为空，没有实现任何已注册的接口
+        if (class_) {
+            for (auto &&[interface, table]: class_->itables) {
+                if (interface == resolved.class_) target = table[method->table_index];
+            }
+        }
+    } else if (isSubclassOf(class_, resolved.class_)) {
+        target = class_->vtable[method->table_index];
+    }
+    if (target.method == nullptr) {
+        throw sese::Exception("java/lang/IncompatibleClassChangeError: " +
+                              (class_ ? class_->getThisName() : std::string("array")) + " does not implement " +
+                              resolved.class_->getThisName() + "." + std::string(method->name));
+    }
+    if (!target.method->code_info) {
+        // 已注册的本地方法只能以 invokestatic 调用，实例方法没有代码时无法执行
+        throw sese::Exception((target.method->isAbstract() ? "java/lang/AbstractMethodError: "
+                                                           : "java/lang/UnsatisfiedLinkError: ") +
+                              target.class_->getThisName() + "." + std::string(target.method->name));
+    }
+    return target;
+}
+
+jvm::Class::VirtualEntry jvm::Runtime::dispatchMiss(Class::InlineCache &cache, const Object *receiver,
+                                                    const Class::ResolvedEntry &resolved) {
+    auto target = selectMethod(receiver, resolved);
+    if (cache.megamorphic.load(std::memory_order_relaxed)) {
+        return target;
+    }
+    // 其他线程可能同时记录了同一种接收者类型，加锁后重新检查
+    std::lock_guard<std::mutex> guard(dispatch_mutex);
+    if (cache.megamorphic.load(std::memory_order_relaxed) || cache.find(receiver->class_)) {
+        return target;
+    }
+    auto size = cache.size.load(std::memory_order_relaxed);
+    if (size == Class::InlineCache::capacity) {
+        cache.megamorphic.store(true, std::memory_order_relaxed);
+        dispatch_stats.megamorphic_transitions.fetch_add(1, std::memory_order_relaxed);
+        return target;
+    }
+    cache.receivers[size] = receiver->class_;
+    cache.targets[size] = target;
+    cache.size.store(size + 1, std::memory_order_release);
+    if (size + 1 == 2) {
+        dispatch_stats.polymorphic_transitions.fetch_add(1, std::memory_order_relaxed);
+    }
+    return target;
+}
+
+jvm::DispatchStats jvm::Runtime::getDispatchStats() const {
+    DispatchStats stats;
+    stats.hits = dispatch_stats.hits.load();
+    stats.misses = dispatch_stats.misses.load();
+    stats.polymorphic_transitions = dispatch_stats.polymorphic_transitions.load();
+    stats.megamorphic_transitions = dispatch_stats.megamorphic_transitions.load();
+    return stats;
+}
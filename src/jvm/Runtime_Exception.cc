@@ -0,0 +1,217 @@
+#include "Runtime.h"
+#include "Object.h"
+
+#include <sese/util/Exception.h>
+
+#include <cstring>
+#include <iterator>
+
+namespace {
+    /// JDK 中的异常类及其父类，运行时抛出的异常以及常见的受检异常
+    const std::pair<const char *, const char *> throwables[] = {
+        {"java/lang/Throwable", "java/lang/Object"},
+        {"java/lang/Exception", "java/lang/Throwable"},
+        {"java/lang/Error", "java/lang/Throwable"},
+        {"java/lang/RuntimeException", "java/lang/Exception"},
+        {"java/lang/InterruptedException", "java/lang/Exception"},
+        {"java/lang/CloneNotSupportedException", "java/lang/Exception"},
+        {"java/io/IOException", "java/lang/Exception"},
+        {"java/lang/ArithmeticException", "java/lang/RuntimeException"},
+        {"java/lang/ArrayStoreException", "java/lang/RuntimeException"},
+        {"java/lang/ClassCastException", "java/lang/RuntimeException"},
+        {"java/lang/IllegalArgumentException", "java/lang/RuntimeException"},
+        {"java/lang/IllegalStateException", "java/lang/RuntimeException"},
+        {"java/lang/IndexOutOfBoundsException", "java/lang/RuntimeException"},
+        {"java/lang/ArrayIndexOutOfBoundsException", "java/lang/IndexOutOfBoundsException"},
+        {"java/lang/NegativeArraySizeException", "java/lang/RuntimeException"},
+        {"java/lang/NullPointerException", "java/lang/RuntimeException"},
+        {"java/lang/UnsupportedOperationException", "java/lang/RuntimeException"},
+        {"java/lang/LinkageError", "java/lang/Error"},
+        {"java/lang/NoClassDefFoundError", "java/lang/LinkageError"},
+        {"java/lang/ExceptionInInitializerError", "java/lang/LinkageError"},
+        {"java/lang/UnsatisfiedLinkError", "java/lang/LinkageError"},
+        {"java/lang/VerifyError", "java/lang/LinkageError"},
+        {"java/lang/IncompatibleClassChangeError", "java/lang/LinkageError"},
+        {"java/lang/AbstractMethodError", "java/lang/IncompatibleClassChangeError"},
+        {"java/lang/NoSuchFieldError", "java/lang/IncompatibleClassChangeError"},
+        {"java/lang/NoSuchMethodError", "java/lang/IncompatibleClassChangeError"},
+        {"java/lang/VirtualMachineError", "java/lang/Error"},
+        {"java/lang/OutOfMemoryError", "java/lang/VirtualMachineError"},
+        {"java/lang/StackOverflowError", "java/lang/VirtualMachineError"},
+    };
+
+    /// 构造方法的描述符与参数占用的 Slot 数量
+    const std::pair<const char *, uint16_t> constructors[] = {
+        {"()V", 0},
+        {"(Ljava/lang/String;)V", 1},
+        {"(Ljava/lang/String;Ljava/lang/Throwable;)V", 2},
+        {"(Ljava/lang/Throwable;)V", 1},
+    };
+
+    /// 异常信息字段，字符串尚未实现，以 UTF-8 编码的 byte[] 存放
+    constexpr auto message_field = "detailMessage";
+    constexpr auto message_descriptor = "[B";
+
+    /// 按大端序写入类文件
+    class ClassFileWriter {
+    public:
+        void u1(uint8_t value) { bytes.push_back(value); }
+
+        void u2(uint16_t value) {
+            u1(static_cast<uint8_t>(value >> 8));
+            u1(static_cast<uint8_t>(value));
+        }
+
+        void u4(uint32_t value) {
+            u2(static_cast<uint16_t>(value >> 16));
+            u2(static_cast<uint16_t>(value));
+        }
+
+        void utf8(std::string_view value) {
+            u1(jvm::Class::utf8_info);
+            u2(static_cast<uint16_t>(value.size()));
+            bytes.insert(bytes.end(), value.begin(), value.end());
+        }
+
+        std::vector<uint8_t> bytes;
+    };
+
+    /// 生成只包含空构造方法的异常类，Throwable 额外包含异常信息字段
+    std::vector<uint8_t> throwableClass(std::string_view name, std::string_view super) {
+        ClassFileWriter writer;
+        writer.u4(0xCAFEBABE);
+        writer.u2(0);
+        writer.u2(52);
+        // 1 类名，2 类，3 父类名，4 父类，5 <init>，6 Code，7 起为构造方法描述符，随后为字段名与字段描述符
+        constexpr uint16_t descriptors = 7;
+        constexpr uint16_t constructor_count = std::size(constructors);
+        constexpr uint16_t field_name = descriptors + constructor_count;
+        writer.u2(field_name + 2);
+        writer.utf8(name);
+        writer.u1(jvm::Class::class_info);
+        writer.u2(1);
+        writer.utf8(super);
+        writer.u1(jvm::Class::class_info);
+        writer.u2(3);
+        writer.utf8("<init>");
+        writer.utf8("Code");
+        for (auto &&[descriptor, _]: constructors) writer.utf8(descriptor);
+        writer.utf8(message_field);
+        writer.utf8(message_descriptor);
+
+        writer.u2(jvm::public_);
+        writer.u2(2);
+        writer.u2(4);
+        writer.u2(0);
+        auto root = super == "java/lang/Object";
+        writer.u2(root ? 1 : 0);
+        if (root) {
+            writer.u2(jvm::private_);
+            writer.u2(field_name);
+            writer.u2(field_name + 1);
+            writer.u2(0);
+        }
+        writer.u2(constructor_count);
+        for (uint16_t i = 0; i < constructor_count; ++i) {
+            writer.u2(jvm::public_);
+            writer.u2(5);
+            writer.u2(descriptors + i);
+            writer.u2(1);
+            // Code：max_stack、max_locals、仅有一条 return 的字节码、空的异常表与属性表
+            writer.u2(6);
+            writer.u4(13);
+            writer.u2(0);
+            writer.u2(constructors[i].second + 1);
+            writer.u4(1);
+            writer.u1(jvm::return_);
+            writer.u2(0);
+            writer.u2(0);
+        }
+        writer.u2(0);
+        return std::move(writer.bytes);
+    }
+}
+
+void jvm::Runtime::regBuiltinThrowables() {
+    for (auto &&[name, super]: throwables) {
+        auto buffer = std::make_shared<OwnedClassBuffer>(throwableClass(name, super));
+        regClass(std::make_shared<Class>(std::move(buffer)));
+    }
+    throwable = classes.at("java/lang/Throwable").get();
+    layout(*throwable);
+    for (auto &&field: throwable->field_infos) {
+        if (field.name == message_field) message_offset = field.offset;
+    }
+}
+
+bool jvm::Runtime::isSubclassOf(const Class *class_, const Class *ancestor) {
+    for (auto owner = class_; owner; owner = owner->super) {
+        if (owner == ancestor) return true;
+    }
+    return false;
+}
+
+jvm::Object *jvm::Runtime::newThrowable(const std::string &class_name, std::string_view message) {
+    auto iter = classes.find(class_name);
+    if (iter == classes.end()) return nullptr;
+    auto &&class_ = *iter->second;
+    {
+        std::lock_guard<std::mutex> guard(link_mutex);
+        layout(class_);
+    }
+    if (!isSubclassOf(&class_, throwable)) return nullptr;
+    auto object = heap->allocate(&class_, class_.instance_size);
+    if (message.empty()) return object;
+    auto &&handles = FrameStack::current().handles();
+    handles.push_back(object);
+    Array *array;
+    try {
+        array = heap->allocateArray(Array::t_byte, static_cast<int32_t>(message.size()));
+    } catch (...) {
+        handles.pop_back();
+        throw;
+    }
+    object = static_cast<Object *>(handles.back());
+    handles.pop_back();
+    memcpy(array->data(), message.data(), message.size());
+    memcpy(reinterpret_cast<uint8_t *>(object) + message_offset, &array, sizeof(array));
+    heap->writeBarrier(object);
+    return object;
+}
+
+jvm::Object *jvm::Runtime::toThrowable(const char *what) {
+    std::string_view text(what);
+    if (text.substr(0, 5) != "java/") return nullptr;
+    auto colon = text.find(": ");
+    auto name = text.substr(0, colon);
+    auto message = colon == std::string_view::npos ? std::string_view() : text.substr(colon + 2);
+    return newThrowable(std::string(name), message);
+}
+
+std::string jvm::Runtime::describe(const Object *exception) const {
+    if (exception->class_ == nullptr) return "java/lang/Object";
+    auto text = exception->class_->getThisName();
+    if (!isSubclassOf(exception->class_, throwable)) return text;
+    Array *message;
+    memcpy(&message, reinterpret_cast<const uint8_t *>(exception) + message_offset, sizeof(message));
+    if (message) {
+        text.append(": ").append(reinterpret_cast<const char *>(message->data()), message->length);
+    }
+    return text;
+}
+
+int32_t jvm::Runtime::findHandler(Class &class_, Class::CodeInfo &code_info, int32_t index, const Object *exception) {
+    // 处理器的类在首次匹配时解析并写回，抛出异常属于慢速路径，整个查找过程持有锁即可
+    std::lock_guard<std::mutex> guard(link_mutex);
+    for (auto &&handler: code_info.handlers) {
+        if (index < handler.from || index >= handler.to) continue;
+        if (handler.catch_type == 0) return handler.target;
+        if (handler.catch_class == nullptr) {
+            auto iter = classes.find(std::string(class_.getClassName(handler.catch_type)));
+            if (iter == classes.end()) continue;
+            handler.catch_class = iter->second.get();
+        }
+        if (isSubclassOf(exception->class_, handler.catch_class)) return handler.target;
+    }
+    return -1;
+}
@@ -0,0 +1,1544 @@
+#include "Opcode.h"
+#include "Runtime.h"
+
+#include <sese/Log.h>
+#include <sese/util/Exception.h>
+
+#include <atomic>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <utility>
+
+// 解释器已实现的指令，computed goto 模式下据此生成派发表
+#define JVM_INTERPRETER_INSTRUCTIONS(X) \
+    X(nop) X(aconst_null) X(iconst_m1) X(iconst_0) X(iconst_1) X(iconst_2) X(iconst_3) X(iconst_4) X(iconst_5) \
+    X(lconst_0) X(lconst_1) X(fconst_0) X(fconst_1) X(fconst_2) X(dconst_0) X(dconst_1) X(bipush) X(sipush) \
+    X(ldc) X(ldc_w) X(ldc2_w) \
+    X(iload) X(iload_0) X(iload_1) X(iload_2) X(iload_3) X(lload) X(lload_0) X(lload_1) X(lload_2) X(lload_3) \
+    X(fload) X(fload_0) X(fload_1) X(fload_2) X(fload_3) X(dload) X(dload_0) X(dload_1) X(dload_2) X(dload_3) \
+    X(aload) X(aload_0) X(aload_1) X(aload_2) X(aload_3) \
+    X(istore) X(istore_0) X(istore_1) X(istore_2) X(istore_3) X(lstore) X(lstore_0) X(lstore_1) X(lstore_2) \
+    X(lstore_3) X(fstore) X(fstore_0) X(fstore_1) X(fstore_2) X(fstore_3) X(dstore) X(dstore_0) X(dstore_1) \
+    X(dstore_2) X(dstore_3) X(astore) X(astore_0) X(astore_1) X(astore_2) X(astore_3) \
+    X(pop) X(pop2) X(dup) X(dup_x1) X(dup_x2) X(dup2) X(dup2_x1) X(dup2_x2) X(swap) \
+    X(iadd) X(ladd) X(fadd) X(dadd) X(isub) X(lsub) X(fsub) X(dsub) X(imul) X(lmul) X(fmul) X(dmul) \
+    X(idiv) X(ldiv) X(fdiv) X(ddiv) X(irem) X(lrem) X(frem) X(drem) X(ineg) X(lneg) X(fneg) X(dneg) \
+    X(ishl) X(lshl) X(ishr) X(lshr) X(iushr) X(lushr) X(iand) X(land) X(ior) X(lor) X(ixor) X(lxor) \
+    X(iinc) X(i2l) X(i2f) X(i2d) X(l2i) X(l2f) X(l2d) X(f2i) X(f2l) X(f2d) X(d2i) X(d2l) X(d2f) \
+    X(i2b) X(i2c) X(i2s) X(lcmp) X(fcmpl) X(fcmpg) X(dcmpl) X(dcmpg) \
+    X(ifeq) X(ifne) X(iflt) X(ifge) X(ifgt) X(ifle) \
+    X(if_icmpeq) X(if_icmpne) X(if_icmplt) X(if_icmpge) X(if_icmpgt) X(if_icmple) X(if_acmpeq) X(if_acmpne) \
+    X(goto_) X(tableswitch) X(lookupswitch) X(ireturn) X(lreturn) X(freturn) X(dreturn) X(areturn) X(return_) \
+    X(getstatic) X(putstatic) X(invokevirtual) X(invokespecial) \
+    X(invokestatic) X(invokeinterface) X(new_) X(newarray) X(anewarray) X(arraylength) X(athrow) X(multianewarray) X(ifnull) X(ifnonnull) \
+    X(end_of_code) \
+    X(iaload) X(laload) X(faload) X(daload) X(aaload) X(baload) X(caload) X(saload) \
+    X(iastore) X(lastore) X(fastore) X(dastore) X(aastore) X(bastore) X(castore) X(sastore) \
+    X(iload_iload_if_icmpeq) X(iload_iload_if_icmpne) X(iload_iload_if_icmplt) X(iload_iload_if_icmpge) \
+    X(iload_iload_if_icmpgt) X(iload_iload_if_icmple) X(iload_irem_ifeq) X(iload_irem_ifne) X(iinc_goto) \
+    X(dload_dadd_dstore) X(dload_dsub_dstore) \
+    X(ipopcnt) X(lpopcnt) X(iclz) X(lclz) X(ictz) X(lctz) X(irotl) X(irotr) X(lrotl) X(lrotr) X(ibswap) X(lbswap) \
+    X(arraycopy) X(arrayfill) X(arrayfill_range) X(invokenative) \
+    X(getfield_byte) X(getfield_char) X(getfield_short) X(getfield_int) X(getfield_long) X(getfield_ref) \
+    X(putfield_boolean) X(putfield_byte) X(putfield_short) X(putfield_int) X(putfield_long) X(putfield_ref) \
+    X(getstatic_byte) X(getstatic_char) X(getstatic_short) X(getstatic_int) X(getstatic_long) X(getstatic_ref) \
+    X(putstatic_boolean) X(putstatic_byte) X(putstatic_short) X(putstatic_int) X(putstatic_long) X(putstatic_ref)
+
+// 统计模式下每次派发先记录字节码与指令下标，超级指令按其首条指令的通用形式逐条执行，内建函数计为 invokestatic
+#ifdef JVM_COMPUTED_GOTO
+#define INSN(name) L_##name:
+#define DISPATCH() \
+    if constexpr (profiling != no_profiling) { \
+        auto dispatched = loadOpcode(*ip); \
+        RECORD(dispatched); \
+        goto *labels[dispatched]; \
+    } else goto *loadHandler(*ip)
+#else
+#define INSN(name) case name:
+#define DISPATCH() goto dispatch
+#endif
+
+#define RECORD(opcode) \
+    if constexpr ((profiling & opcode_profiling) != 0) { \
+        auto bytecode = bytecodeOf(opcode); \
+        profile->record(bytecode, static_cast<uint32_t>(sp - locals - frame->method->code_info->max_locals)); \
+        if (bytecode == invokestatic) profile->recordCall(frame->class_, static_cast<uint16_t>(ip->a)); \
+    } \
+    if constexpr ((profiling & method_profiling) != 0) ++counts[ip - base]
+
+// 剖析期间只解释执行，不进入编译后的代码
+#define HAS_NATIVE() (frame->method->code_info->native && (profiling & method_profiling) == 0)
+
+// 前进至下一条指令并派发
+#define NEXT() \
+    ++ip; \
+    DISPATCH()
+
+// 跳转同时作为回边检查安全点
+#define JUMP(index) \
+    ip = base + (index); \
+    SAFEPOINT_POLL(); \
+    DISPATCH()
+
+// 返回值已写入局部变量表起始位置，通知 Tracer 后弹出当前帧
+#define RETURN() \
+    if (tracer) tracer->onExit(*frame, ip->pc); \
+    goto leave
+
+// 切换至 frame 指向的栈帧，sp 由调用方维护
+#define LOAD_FRAME() \
+    base = frame->method->code_info->instructions.data(); \
+    locals = frame->locals
+
+// 操作数栈访问，sp 始终指向下一个空闲的 Slot，long/double 占用两个 Slot
+#define PUSH_INT(v) ((sp++)->i = (v))
+#define POP_INT() ((--sp)->i)
+#define PUSH_FLOAT(v) ((sp++)->f = (v))
+#define POP_FLOAT() ((--sp)->f)
+#define PUSH_LONG(v) (sp->l = (v), sp += 2)
+#define POP_LONG() ((sp -= 2)->l)
+#define PUSH_DOUBLE(v) (sp->d = (v), sp += 2)
+#define POP_DOUBLE() ((sp -= 2)->d)
+#define PUSH_REF(v) ((sp++)->ref = (v))
+#define POP_REF() ((--sp)->ref)
+
+// 参数按照从左到右的顺序依次位于操作数栈顶部，原地作为被调用者局部变量表的起始部分，
+// slots 为参数占用的 Slot 数量，包括接收者
+#define INVOKE(resolved, slots) \
+    sp -= (slots); \
+    frame->ip = ip; \
+    frame->sp = sp; \
+    frame = stack.push((resolved).class_, (resolved).method, sp); \
+    LOAD_FRAME(); \
+    ip = base; \
+    sp = frame->sp; \
+    SAFEPOINT_POLL(); \
+    if (tracer) tracer->onEnter(*frame); \
+    if constexpr ((profiling & method_profiling) != 0) { \
+        profiler->enter(frame->class_, frame->method); \
+        counts = profiler->counts(); \
+    } \
+    if (HAS_NATIVE()) { \
+        goto native; \
+    } \
+    DISPATCH()
+
+// 虚方法调用，接收者的类已记录在调用点的内联缓存中时直接调用缓存的实现方法，否则查表选择并记录
+#define INVOKE_VIRTUAL() \
+    auto &&entry = frame->class_->resolved_entries[ip->a]; \
+    auto &&resolved = entry.resolved ? entry : SLOW_PATH(resolveMethod(*frame->class_, ip->a)); \
+    auto slots = resolved.method->args_slots + 1; \
+    auto receiver = static_cast<const Object *>(sp[-slots].ref); \
+    NULL_CHECK(receiver); \
+    auto &&cache = frame->method->code_info->inline_caches[ip->c]; \
+    Class::VirtualEntry target; \
+    if (auto cached = cache.find(receiver->class_)) { \
+        ++hits; \
+        target = *cached; \
+    } else { \
+        ++misses; \
+        target = dispatchMiss(cache, receiver, resolved); \
+    } \
+    INVOKE(target, slots)
+
+// 解析当前指令引用的实例字段，得到其在对象中的偏移
+#define FIELD_OFFSET() \
+    auto &&entry = frame->class_->resolved_entries[ip->a]; \
+    auto offset = (entry.resolved ? entry : resolveField(*frame->class_, ip->a)).offset
+
+// 在解释器循环内创建异常对象并查找处理器，不经过 C++ 异常机制；
+// 操作数栈将被丢弃，创建异常对象前只需保存当前位置与局部变量表供枚举根集合
+#define RAISE(name, message) \
+    { \
+        frame->ip = ip; \
+        frame->sp = locals + frame->method->code_info->max_locals; \
+        exception = newThrowable(name, message); \
+        goto throw_; \
+    }
+
+#define NULL_CHECK(ref) \
+    if ((ref) == nullptr) RAISE("java/lang/NullPointerException", {})
+
+// 下标按无符号数比较，负数同样视为越界
+#define ARRAY_CHECK(array, index) \
+    NULL_CHECK(array); \
+    if (static_cast<uint32_t>(index) >= static_cast<uint32_t>((array)->length)) \
+        RAISE("java/lang/ArrayIndexOutOfBoundsException", "Index " + std::to_string(index) + \
+              " out of bounds for length " + std::to_string((array)->length))
+
+// 分配可能触发垃圾收集，先保存当前位置供枚举根集合
+#define GC_POINT() \
+    frame->ip = ip; \
+    frame->sp = sp
+
+// 首次解析可能执行 <clinit> 或者等待其他线程完成初始化，与分配一样先保存当前位置
+#define SLOW_PATH(call) (frame->ip = ip, frame->sp = sp, call)
+
+// 其他线程请求垃圾收集时暂停，当前位置即为根集合的枚举位置
+#define SAFEPOINT_POLL() \
+    if (safepoint.requested()) { \
+        GC_POINT(); \
+        safepoint.park(); \
+    }
+
+// Java 整数运算按补码回绕，借助无符号运算避免 C++ 有符号溢出的未定义行为
+#define WRAP_INT(a, op, b) static_cast<int32_t>(static_cast<uint32_t>(a) op static_cast<uint32_t>(b))
+#define WRAP_LONG(a, op, b) static_cast<int64_t>(static_cast<uint64_t>(a) op static_cast<uint64_t>(b))
+
+// 按位运算的 int 与 long 版本
+#define bitwise(iname, lname, op) \
+    INSN(iname) { \
+        auto value2 = POP_INT(); \
+        auto value1 = POP_INT(); \
+        PUSH_INT(value1 op value2); \
+        NEXT(); \
+    } \
+    INSN(lname) { \
+        auto value2 = POP_LONG(); \
+        auto value1 = POP_LONG(); \
+        PUSH_LONG(value1 op value2); \
+        NEXT(); \
+    }
+
+#define iconst_N(n) \
+    INSN(iconst_##n) { \
+        PUSH_INT(n); \
+        NEXT(); \
+    }
+
+#define lconst_N(n) \
+    INSN(lconst_##n) { \
+        PUSH_LONG(n); \
+        NEXT(); \
+    }
+
+#define fconst_N(n) \
+    INSN(fconst_##n) { \
+        PUSH_FLOAT(n##.0f); \
+        NEXT(); \
+    }
+
+#define dconst_N(n) \
+    INSN(dconst_##n) { \
+        PUSH_DOUBLE(n##.0); \
+        NEXT(); \
+    }
+
+#define iload_N(n) \
+    INSN(iload_##n) { \
+        PUSH_INT(locals[n].i); \
+        NEXT(); \
+    }
+
+#define lload_N(n) \
+    INSN(lload_##n) { \
+        PUSH_LONG(locals[n].l); \
+        NEXT(); \
+    }
+
+#define fload_N(n) \
+    INSN(fload_##n) { \
+        PUSH_FLOAT(locals[n].f); \
+        NEXT(); \
+    }
+
+#define dload_N(n) \
+    INSN(dload_##n) { \
+        PUSH_DOUBLE(locals[n].d); \
+        NEXT(); \
+    }
+
+#define istore_N(n) \
+    INSN(istore_##n) { \
+        locals[n].i = POP_INT(); \
+        NEXT(); \
+    }
+
+#define lstore_N(n) \
+    INSN(lstore_##n) { \
+        locals[n].l = POP_LONG(); \
+        NEXT(); \
+    }
+
+#define fstore_N(n) \
+    INSN(fstore_##n) { \
+        locals[n].f = POP_FLOAT(); \
+        NEXT(); \
+    }
+
+#define dstore_N(n) \
+    INSN(dstore_##n) { \
+        locals[n].d = POP_DOUBLE(); \
+        NEXT(); \
+    }
+
+#define aload_N(n) \
+    INSN(aload_##n) { \
+        PUSH_REF(locals[n].ref); \
+        NEXT(); \
+    }
+
+#define astore_N(n) \
+    INSN(astore_##n) { \
+        locals[n].ref = POP_REF(); \
+        NEXT(); \
+    }
+
+// 字段按照链接时计算的偏移直接读写，借助 memcpy 避免违反严格别名规则，编译后即为单条 mov
+#define getfield_T(name, type, PUSH) \
+    INSN(getfield_##name) { \
+        FIELD_OFFSET(); \
+        auto object = static_cast<uint8_t *>(POP_REF()); \
+        NULL_CHECK(object); \
+        type value; \
+        memcpy(&value, object + offset, sizeof(type)); \
+        PUSH(value); \
+        NEXT(); \
+    }
+
+#define putfield_T(name, type, POP) \
+    INSN(putfield_##name) { \
+        FIELD_OFFSET(); \
+        auto value = static_cast<type>(POP()); \
+        auto object = static_cast<uint8_t *>(POP_REF()); \
+        NULL_CHECK(object); \
+        memcpy(object + offset, &value, sizeof(type)); \
+        NEXT(); \
+    }
+
+// 静态字段的地址在替换指令时写入，所属类已完成初始化，读写即为对固定地址的单条 mov；
+// 静态引用字段作为根集合枚举，写入时不需要写屏障
+#define getstatic_T(name, type, PUSH) \
+    INSN(getstatic_##name) { \
+        type value; \
+        memcpy(&value, staticAddress(*ip), sizeof(type)); \
+        PUSH(value); \
+        NEXT(); \
+    }
+
+#define putstatic_T(name, type, POP) \
+    INSN(putstatic_##name) { \
+        auto value = static_cast<type>(POP()); \
+        memcpy(staticAddress(*ip), &value, sizeof(type)); \
+        NEXT(); \
+    }
+
+// 首次执行时解析字段并初始化所属类，<clinit> 可能触发垃圾收集；
+// 初始化完成后将指令替换为特化指令，所属类正在由当前线程初始化时保持原样，本次按照特化指令的语义访问。
+// 替换在 link_mutex 下进行且只进行一次，字段地址写入后才发布 handler 与 opcode
+#define xstatic(name) \
+    INSN(name) { \
+        GC_POINT(); \
+        auto &&field = resolveStaticField(*frame->class_, ip->a); \
+        auto opcode = specializedOpcode(name, frame->class_->getMemberRef(ip->a).descriptor); \
+        if (field.resolved) { \
+            auto &&insn = frame->method->code_info->instructions[ip - base]; \
+            std::lock_guard<std::mutex> guard(link_mutex); \
+            if (loadOpcode(insn) == name) { \
+                setStaticAddress(insn, field.address); \
+                auto table = dispatchTable(); \
+                publishInstruction(insn, opcode, table ? table[opcode] : nullptr); \
+            } \
+        } \
+        sp = accessStatic(opcode, field.address, sp); \
+        NEXT(); \
+    }
+
+// 数组元素按照本机类型连续存放，与字段访问一样借助 memcpy 读写
+#define xaload(name, type, PUSH) \
+    INSN(name) { \
+        auto index = POP_INT(); \
+        auto array = static_cast<Array *>(POP_REF()); \
+        ARRAY_CHECK(array, index); \
+        type value; \
+        memcpy(&value, array->data() + static_cast<size_t>(index) * sizeof(type), sizeof(type)); \
+        PUSH(value); \
+        NEXT(); \
+    }
+
+#define xastore(name, type, POP) \
+    INSN(name) { \
+        auto value = static_cast<type>(POP()); \
+        auto index = POP_INT(); \
+        auto array = static_cast<Array *>(POP_REF()); \
+        ARRAY_CHECK(array, index); \
+        memcpy(array->data() + static_cast<size_t>(index) * sizeof(type), &value, sizeof(type)); \
+        NEXT(); \
+    }
+
+// 复制栈顶 size 个 Slot 并插入到其下方 skip 个 Slot 之下，
+// 类型推导已保证不会拆开 long/double，因此只需按 Slot 搬运而无需区分类别
+#define dup_N(name, size, skip) \
+    INSN(name) { \
+        for (int i = 0; i < (size); ++i) sp[i] = sp[i - (size)]; \
+        for (int i = -1; i >= -(skip); --i) sp[i] = sp[i - (size)]; \
+        for (int i = 0; i < (size); ++i) sp[i - (skip) - (size)] = sp[i]; \
+        sp += (size); \
+        NEXT(); \
+    }
+
+#define if_N(name, cond) \
+    INSN(name) { \
+        auto value = POP_INT(); \
+        if (value cond 0) { \
+            JUMP(ip->a); \
+        } \
+        NEXT(); \
+    }
+
+#define if_icmpN(name, cond) \
+    INSN(name) { \
+        auto value2 = POP_INT(); \
+        auto value1 = POP_INT(); \
+        if (value1 cond value2) { \
+            JUMP(ip->a); \
+        } \
+        NEXT(); \
+    }
+
+#define iload_iload_if_icmpN(name, cond) \
+    INSN(iload_iload_##name) { \
+        if (locals[ip->a].i cond locals[ip->b].i) { \
+            JUMP(ip->c); \
+        } \
+        ip += 3; \
+        DISPATCH(); \
+    }
+
+// 除数为 0 时异常在 irem 处抛出，先移到 irem 再查找处理器，处理器范围可能从 irem 开始
+#define iload_irem_ifN(name, cond) \
+    INSN(iload_irem_##name) { \
+        auto value2 = locals[ip->a].i; \
+        auto value1 = POP_INT(); \
+        if (value2 == 0) { \
+            ++ip; \
+            RAISE("java/lang/ArithmeticException", "/ by zero"); \
+        } \
+        if ((value2 == -1 ? 0 : value1 % value2) cond 0) { \
+            JUMP(ip->c); \
+        } \
+        ip += 3; \
+        DISPATCH(); \
+    }
+
+#define dload_dop_dstore(name, op) \
+    INSN(dload_##name##_dstore) { \
+        auto value1 = POP_DOUBLE(); \
+        locals[ip->c].d = value1 op locals[ip->a].d; \
+        ip += 3; \
+        DISPATCH(); \
+    }
+
+namespace {
+    /// 线程本地累计的计数，析构时计入共享的计数器
+    class LocalCounter {
+    public:
+        explicit LocalCounter(std::atomic<uint64_t> &total) : total(total) {
+        }
+
+        ~LocalCounter() {
+            if (count) total.fetch_add(count, std::memory_order_relaxed);
+        }
+
+        LocalCounter(const LocalCounter &) = delete;
+
+        LocalCounter &operator=(const LocalCounter &) = delete;
+
+        void operator++() { ++count; }
+
+    private:
+        std::atomic<uint64_t> &total;
+        uint64_t count{};
+    };
+
+    /// C++ 异常穿过解释器时退出剖析中尚未退出的方法
+    class ProfilerScope {
+    public:
+        explicit ProfilerScope(jvm::Profiler *profiler) : profiler(profiler), depth(profiler ? profiler->depth() : 0) {
+        }
+
+        ~ProfilerScope() {
+            if (profiler) profiler->unwind(depth);
+        }
+
+        ProfilerScope(const ProfilerScope &) = delete;
+
+        ProfilerScope &operator=(const ProfilerScope &) = delete;
+
+    private:
+        jvm::Profiler *profiler;
+        size_t depth;
+    };
+
+    /// 按照特化后的静态字段指令读写 address
+    /// @return 新的栈顶
+    jvm::Slot *accessStatic(uint16_t opcode, uint8_t *address, jvm::Slot *sp) {
+        using namespace jvm;
+        auto load = [address](auto value) {
+            memcpy(&value, address, sizeof(value));
+            return value;
+        };
+        auto store = [address](auto value) { memcpy(address, &value, sizeof(value)); };
+        switch (opcode) {
+            case getstatic_byte:
+                PUSH_INT(load(int8_t{}));
+                break;
+            case getstatic_char:
+                PUSH_INT(load(uint16_t{}));
+                break;
+            case getstatic_short:
+                PUSH_INT(load(int16_t{}));
+                break;
+            case getstatic_int:
+                PUSH_INT(load(int32_t{}));
+                break;
+            case getstatic_long:
+                PUSH_LONG(load(int64_t{}));
+                break;
+            case getstatic_ref:
+                PUSH_REF(load(static_cast<void *>(nullptr)));
+                break;
+            case putstatic_boolean:
+                store(static_cast<uint8_t>(POP_INT() & 1));
+                break;
+            case putstatic_byte:
+                store(static_cast<int8_t>(POP_INT()));
+                break;
+            case putstatic_short:
+                store(static_cast<int16_t>(POP_INT()));
+                break;
+            case putstatic_int:
+                store(POP_INT());
+                break;
+            case putstatic_long:
+                store(POP_LONG());
+                break;
+            default:
+                store(POP_REF());
+                break;
+        }
+        return sp;
+    }
+
+    /// Java 浮点数转整数的语义：NaN 为 0，超出范围时取最接近的边界值
+    template<typename To, typename From>
+    To saturate(From value) {
+        if (std::isnan(value)) return 0;
+        if (value >= static_cast<From>(std::numeric_limits<To>::max())) return std::numeric_limits<To>::max();
+        if (value <= static_cast<From>(std::numeric_limits<To>::min())) return std::numeric_limits<To>::min();
+        return static_cast<To>(value);
+    }
+
+    // 以下为位运算内建函数的实现，参数均为无符号整数，GCC 与 Clang 下编译为 popcnt、lzcnt 等指令
+
+    template<typename T>
+    int32_t bitCount(T value) {
+#if defined(__GNUC__)
+        return __builtin_popcountll(value);
+#else
+        int32_t count = 0;
+        for (; value; value &= value - 1) ++count;
+        return count;
+#endif
+    }
+
+    template<typename T>
+    int32_t leadingZeros(T value) {
+        constexpr int32_t bits = sizeof(T) * 8;
+        if (value == 0) return bits;
+#if defined(__GNUC__)
+        return __builtin_clzll(value) - (64 - bits);
+#else
+        int32_t count = 0;
+        for (; !(value >> (bits - 1)); value <<= 1) ++count;
+        return count;
+#endif
+    }
+
+    template<typename T>
+    int32_t trailingZeros(T value) {
+        if (value == 0) return sizeof(T) * 8;
+#if defined(__GNUC__)
+        return __builtin_ctzll(value);
+#else
+        int32_t count = 0;
+        for (; !(value & 1); value >>= 1) ++count;
+        return count;
+#endif
+    }
+
+    /// 与 Java 一致，仅取 distance 的低 5 位或低 6 位，负数即为反方向旋转
+    template<typename T>
+    T rotateLeft(T value, int32_t distance) {
+        constexpr uint32_t bits = sizeof(T) * 8;
+        auto shift = static_cast<uint32_t>(distance) & (bits - 1);
+        return shift == 0 ? value : static_cast<T>(value << shift | value >> (bits - shift));
+    }
+
+    template<typename T>
+    T reverseBytes(T value) {
+#if defined(__GNUC__)
+        if constexpr (sizeof(T) == 4) return __builtin_bswap32(value);
+        else return __builtin_bswap64(value);
+#else
+        T result = 0;
+        for (size_t i = 0; i < sizeof(T); ++i, value >>= 8) result = result << 8 | (value & 0xFF);
+        return result;
+#endif
+    }
+}
+
+const void *const *jvm::Runtime::dispatchTable() {
+#ifdef JVM_COMPUTED_GOTO
+    static const void *table[instruction_count]{};
+    static const bool exported = (interpret<no_profiling>(nullptr, table), true);
+    (void) exported;
+    return table;
+#else
+    return nullptr;
+#endif
+}
+
+void jvm::Runtime::execute(Frame *entry_frame) {
+    switch ((profile ? opcode_profiling : no_profiling) | (profiler ? method_profiling : no_profiling)) {
+        case opcode_profiling:
+            interpret<opcode_profiling>(entry_frame, nullptr);
+            break;
+        case method_profiling:
+            interpret<method_profiling>(entry_frame, nullptr);
+            break;
+        case opcode_profiling | method_profiling:
+            interpret<opcode_profiling | method_profiling>(entry_frame, nullptr);
+            break;
+        default:
+            interpret<no_profiling>(entry_frame, nullptr);
+    }
+}
+
+template<uint8_t profiling>
+void jvm::Runtime::interpret(Frame *entry_frame, const void **table) {
+#ifdef JVM_COMPUTED_GOTO
+    [[maybe_unused]] static const void *labels[instruction_count]{};
+    if (table) {
+        // 标签地址在整个程序运行期间都有效，导出到调用者的表中不会悬空
+#if defined(__GNUC__) && !defined(__clang__) && __GNUC__ >= 12
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wdangling-pointer"
+#endif
+        for (int i = 0; i < instruction_count; ++i) {
+            table[i] = &&L_unsupported;
+        }
+#define EXPORT_HANDLER(name) table[name] = &&L_##name;
+        JVM_INTERPRETER_INSTRUCTIONS(EXPORT_HANDLER)
+#undef EXPORT_HANDLER
+#if defined(__GNUC__) && !defined(__clang__) && __GNUC__ >= 12
+#pragma GCC diagnostic pop
+#endif
+        if constexpr (profiling != no_profiling) {
+            for (int i = end_of_code + 1; i < instruction_count; ++i) {
+                table[i] = table[baseOpcode(i)];
+            }
+        }
+        return;
+    }
+    if constexpr (profiling != no_profiling) {
+        static const bool exported = (interpret<profiling>(nullptr, labels), true);
+        (void) exported;
+    }
+#else
+    (void) table;
+#endif
+    auto &&stack = FrameStack::current();
+    Tracer *const tracer = this->tracer;
+    [[maybe_unused]] OpcodeProfile *const profile = this->profile;
+    [[maybe_unused]] Profiler *const profiler = (profiling & method_profiling) != 0 ? this->profiler : nullptr;
+    ProfilerScope profiler_scope(profiler);
+    Heap *const heap = this->heap.get();
+    // 内联缓存的命中与未命中次数先在本地累计，退出时一并计入
+    LocalCounter hits(dispatch_stats.hits);
+    LocalCounter misses(dispatch_stats.misses);
+    Frame *frame = entry_frame;
+    const Instruction *base;
+    const Instruction *ip;
+    Slot *locals;
+    Slot *sp = frame->sp;
+    LOAD_FRAME();
+    ip = base;
+    if (tracer) tracer->onEnter(*frame);
+    // 剖析中当前方法的指令执行次数
+    [[maybe_unused]] uint64_t *counts = nullptr;
+    if constexpr ((profiling & method_profiling) != 0) {
+        profiler->enter(frame->class_, frame->method);
+        counts = profiler->counts();
+    }
+    // 正在查找处理器的异常对象
+    Object *exception = nullptr;
+#ifndef JVM_COMPUTED_GOTO
+    // switch 模式下正在派发的指令的 opcode
+    uint16_t dispatched;
+#endif
+
+resume:
+    // 整个解释器循环只有这一个 try 块，正常执行的路径不需要为异常付出额外的代价；
+    // 解释器内产生的异常以及 athrow 直接跳转至 throw_，只有运行时辅助函数报告的错误才经过 catch
+    try {
+    if (exception) {
+        goto throw_;
+    }
+    if (HAS_NATIVE()) {
+        goto native;
+    }
+
+#ifdef JVM_COMPUTED_GOTO
+    DISPATCH();
+#else
+dispatch:
+    dispatched = loadOpcode(*ip);
+    if constexpr (profiling != no_profiling) {
+        RECORD(dispatched);
+    }
+    switch (profiling != no_profiling ? baseOpcode(dispatched) : dispatched) {
+#endif
+    INSN(nop) {
+        NEXT();
+    }
+    INSN(aconst_null) {
+        (sp++)->ref = nullptr;
+        NEXT();
+    }
+    INSN(iconst_m1) {
+        PUSH_INT(-1);
+        NEXT();
+    }
+    iconst_N(0)
+    iconst_N(1)
+    iconst_N(2)
+    iconst_N(3)
+    iconst_N(4)
+    iconst_N(5)
+    lconst_N(0)
+    lconst_N(1)
+    fconst_N(0)
+    fconst_N(1)
+    fconst_N(2)
+    dconst_N(0)
+    dconst_N(1)
+    INSN(bipush)
+    INSN(sipush) {
+        PUSH_INT(ip->a);
+        NEXT();
+    }
+    INSN(ldc)
+    INSN(ldc_w) {
+        auto &&entry = frame->class_->resolved_entries[ip->a];
+        *sp++ = entry.resolved ? entry.value : resolveConstant(*frame->class_, ip->a, false).value;
+        NEXT();
+    }
+    INSN(ldc2_w) {
+        auto &&entry = frame->class_->resolved_entries[ip->a];
+        *sp = entry.resolved ? entry.value : resolveConstant(*frame->class_, ip->a, true).value;
+        sp += 2;
+        NEXT();
+    }
+    INSN(iload) {
+        PUSH_INT(locals[ip->a].i);
+        NEXT();
+    }
+    iload_N(0)
+    iload_N(1)
+    iload_N(2)
+    iload_N(3)
+    INSN(lload) {
+        PUSH_LONG(locals[ip->a].l);
+        NEXT();
+    }
+    lload_N(0)
+    lload_N(1)
+    lload_N(2)
+    lload_N(3)
+    INSN(fload) {
+        PUSH_FLOAT(locals[ip->a].f);
+        NEXT();
+    }
+    fload_N(0)
+    fload_N(1)
+    fload_N(2)
+    fload_N(3)
+    INSN(dload) {
+        PUSH_DOUBLE(locals[ip->a].d);
+        NEXT();
+    }
+    dload_N(0)
+    dload_N(1)
+    dload_N(2)
+    dload_N(3)
+    INSN(aload) {
+        PUSH_REF(locals[ip->a].ref);
+        NEXT();
+    }
+    aload_N(0)
+    aload_N(1)
+    aload_N(2)
+    aload_N(3)
+    xaload(iaload, int32_t, PUSH_INT)
+    xaload(laload, int64_t, PUSH_LONG)
+    xaload(faload, float, PUSH_FLOAT)
+    xaload(daload, double, PUSH_DOUBLE)
+    xaload(aaload, void *, PUSH_REF)
+    xaload(baload, int8_t, PUSH_INT)
+    xaload(caload, uint16_t, PUSH_INT)
+    xaload(saload, int16_t, PUSH_INT)
+    INSN(istore) {
+        locals[ip->a].i = POP_INT();
+        NEXT();
+    }
+    istore_N(0)
+    istore_N(1)
+    istore_N(2)
+    istore_N(3)
+    INSN(lstore) {
+        locals[ip->a].l = POP_LONG();
+        NEXT();
+    }
+    lstore_N(0)
+    lstore_N(1)
+    lstore_N(2)
+    lstore_N(3)
+    INSN(fstore) {
+        locals[ip->a].f = POP_FLOAT();
+        NEXT();
+    }
+    fstore_N(0)
+    fstore_N(1)
+    fstore_N(2)
+    fstore_N(3)
+    INSN(dstore) {
+        locals[ip->a].d = POP_DOUBLE();
+        NEXT();
+    }
+    dstore_N(0)
+    dstore_N(1)
+    dstore_N(2)
+    dstore_N(3)
+    INSN(astore) {
+        locals[ip->a].ref = POP_REF();
+        NEXT();
+    }
+    astore_N(0)
+    astore_N(1)
+    astore_N(2)
+    astore_N(3)
+    xastore(iastore, int32_t, POP_INT)
+    xastore(lastore, int64_t, POP_LONG)
+    xastore(fastore, float, POP_FLOAT)
+    xastore(dastore, double, POP_DOUBLE)
+    INSN(aastore) {
+        // 元素的实际类型不做检查
+        auto value = POP_REF();
+        auto index = POP_INT();
+        auto array = static_cast<Array *>(POP_REF());
+        ARRAY_CHECK(array, index);
+        memcpy(array->data() + static_cast<size_t>(index) * sizeof(value), &value, sizeof(value));
+        heap->writeBarrier(array);
+        NEXT();
+    }
+    INSN(bastore) {
+        // boolean 数组与 byte 数组共用 bastore，前者只保留最低位
+        auto value = POP_INT();
+        auto index = POP_INT();
+        auto array = static_cast<Array *>(POP_REF());
+        ARRAY_CHECK(array, index);
+        array->data()[index] = static_cast<uint8_t>(array->element == Array::t_boolean ? value & 1 : value);
+        NEXT();
+    }
+    xastore(castore, uint16_t, POP_INT)
+    xastore(sastore, int16_t, POP_INT)
+    INSN(pop) {
+        --sp;
+        NEXT();
+    }
+    INSN(pop2) {
+        sp -= 2;
+        NEXT();
+    }
+    dup_N(dup, 1, 0)
+    dup_N(dup_x1, 1, 1)
+    dup_N(dup_x2, 1, 2)
+    dup_N(dup2, 2, 0)
+    dup_N(dup2_x1, 2, 1)
+    dup_N(dup2_x2, 2, 2)
+    INSN(swap) {
+        std::swap(sp[-1], sp[-2]);
+        NEXT();
+    }
+    INSN(iadd) {
+        auto value2 = POP_INT();
+        auto value1 = POP_INT();
+        PUSH_INT(WRAP_INT(value1, +, value2));
+        NEXT();
+    }
+    INSN(ladd) {
+        auto value2 = POP_LONG();
+        auto value1 = POP_LONG();
+        PUSH_LONG(WRAP_LONG(value1, +, value2));
+        NEXT();
+    }
+    INSN(fadd) {
+        auto value2 = POP_FLOAT();
+        auto value1 = POP_FLOAT();
+        PUSH_FLOAT(value1 + value2);
+        NEXT();
+    }
+    INSN(dadd) {
+        auto value2 = POP_DOUBLE();
+        auto value1 = POP_DOUBLE();
+        PUSH_DOUBLE(value1 + value2);
+        NEXT();
+    }
+    INSN(isub) {
+        auto value2 = POP_INT();
+        auto value1 = POP_INT();
+        PUSH_INT(WRAP_INT(value1, -, value2));
+        NEXT();
+    }
+    INSN(lsub) {
+        auto value2 = POP_LONG();
+        auto value1 = POP_LONG();
+        PUSH_LONG(WRAP_LONG(value1, -, value2));
+        NEXT();
+    }
+    INSN(fsub) {
+        auto value2 = POP_FLOAT();
+        auto value1 = POP_FLOAT();
+        PUSH_FLOAT(value1 - value2);
+        NEXT();
+    }
+    INSN(dsub) {
+        auto value2 = POP_DOUBLE();
+        auto value1 = POP_DOUBLE();
+        PUSH_DOUBLE(value1 - value2);
+        NEXT();
+    }
+    INSN(imul) {
+        auto value2 = POP_INT();
+        auto value1 = POP_INT();
+        PUSH_INT(WRAP_INT(value1, *, value2));
+        NEXT();
+    }
+    INSN(lmul) {
+        auto value2 = POP_LONG();
+        auto value1 = POP_LONG();
+        PUSH_LONG(WRAP_LONG(value1, *, value2));
+        NEXT();
+    }
+    INSN(fmul) {
+        auto value2 = POP_FLOAT();
+        auto value1 = POP_FLOAT();
+        PUSH_FLOAT(value1 * value2);
+        NEXT();
+    }
+    INSN(dmul) {
+        auto value2 = POP_DOUBLE();
+        auto value1 = POP_DOUBLE();
+        PUSH_DOUBLE(value1 * value2);
+        NEXT();
+    }
+    INSN(idiv) {
+        auto value2 = POP_INT();
+        auto value1 = POP_INT();
+        if (value2 == 0) RAISE("java/lang/ArithmeticException", "/ by zero");
+        // INT32_MIN / -1 在 Java 中回绕为 INT32_MIN
+        PUSH_INT(value2 == -1 ? WRAP_INT(0, -, value1) : value1 / value2);
+        NEXT();
+    }
+    INSN(ldiv) {
+        auto value2 = POP_LONG();
+        auto value1 = POP_LONG();
+        if (value2 == 0) RAISE("java/lang/ArithmeticException", "/ by zero");
+        PUSH_LONG(value2 == -1 ? WRAP_LONG(0, -, value1) : value1 / value2);
+        NEXT();
+    }
+    INSN(fdiv) {
+        auto value2 = POP_FLOAT();
+        auto value1 = POP_FLOAT();
+        PUSH_FLOAT(value1 / value2);
+        NEXT();
+    }
+    INSN(ddiv) {
+        auto value2 = POP_DOUBLE();
+        auto value1 = POP_DOUBLE();
+        PUSH_DOUBLE(value1 / value2);
+        NEXT();
+    }
+    INSN(irem) {
+        auto value2 = POP_INT();
+        auto value1 = POP_INT();
+        if (value2 == 0) RAISE("java/lang/ArithmeticException", "/ by zero");
+        PUSH_INT(value2 == -1 ? 0 : value1 % value2);
+        NEXT();
+    }
+    INSN(lrem) {
+        auto value2 = POP_LONG();
+        auto value1 = POP_LONG();
+        if (value2 == 0) RAISE("java/lang/ArithmeticException", "/ by zero");
+        PUSH_LONG(value2 == -1 ? 0 : value1 % value2);
+        NEXT();
+    }
+    INSN(frem) {
+        auto value2 = POP_FLOAT();
+        auto value1 = POP_FLOAT();
+        PUSH_FLOAT(std::fmod(value1, value2));
+        NEXT();
+    }
+    INSN(drem) {
+        auto value2 = POP_DOUBLE();
+        auto value1 = POP_DOUBLE();
+        PUSH_DOUBLE(std::fmod(value1, value2));
+        NEXT();
+    }
+    INSN(ineg) {
+        auto value = POP_INT();
+        PUSH_INT(WRAP_INT(0, -, value));
+        NEXT();
+    }
+    INSN(lneg) {
+        auto value = POP_LONG();
+        PUSH_LONG(WRAP_LONG(0, -, value));
+        NEXT();
+    }
+    INSN(fneg) {
+        auto value = POP_FLOAT();
+        PUSH_FLOAT(-value);
+        NEXT();
+    }
+    INSN(dneg) {
+        auto value = POP_DOUBLE();
+        PUSH_DOUBLE(-value);
+        NEXT();
+    }
+    // 移位距离仅取低 5 位或低 6 位，左移与无符号右移借助无符号运算
+    INSN(ishl) {
+        auto value2 = POP_INT();
+        auto value1 = POP_INT();
+        PUSH_INT(static_cast<int32_t>(static_cast<uint32_t>(value1) << (value2 & 0x1F)));
+        NEXT();
+    }
+    INSN(lshl) {
+        auto value2 = POP_INT();
+        auto value1 = POP_LONG();
+        PUSH_LONG(static_cast<int64_t>(static_cast<uint64_t>(value1) << (value2 & 0x3F)));
+        NEXT();
+    }
+    INSN(ishr) {
+        auto value2 = POP_INT();
+        auto value1 = POP_INT();
+        PUSH_INT(value1 >> (value2 & 0x1F));
+        NEXT();
+    }
+    INSN(lshr) {
+        auto value2 = POP_INT();
+        auto value1 = POP_LONG();
+        PUSH_LONG(value1 >> (value2 & 0x3F));
+        NEXT();
+    }
+    INSN(iushr) {
+        auto value2 = POP_INT();
+        auto value1 = POP_INT();
+        PUSH_INT(static_cast<int32_t>(static_cast<uint32_t>(value1) >> (value2 & 0x1F)));
+        NEXT();
+    }
+    INSN(lushr) {
+        auto value2 = POP_INT();
+        auto value1 = POP_LONG();
+        PUSH_LONG(static_cast<int64_t>(static_cast<uint64_t>(value1) >> (value2 & 0x3F)));
+        NEXT();
+    }
+    bitwise(iand, land, &)
+    bitwise(ior, lor, |)
+    bitwise(ixor, lxor, ^)
+    INSN(iinc) {
+        locals[ip->a].i = WRAP_INT(locals[ip->a].i, +, ip->b);
+        NEXT();
+    }
+    INSN(i2l) {
+        auto value = POP_INT();
+        PUSH_LONG(static_cast<int64_t>(value));
+        NEXT();
+    }
+    INSN(i2f) {
+        auto value = POP_INT();
+        PUSH_FLOAT(static_cast<float>(value));
+        NEXT();
+    }
+    INSN(i2d) {
+        auto value = POP_INT();
+        PUSH_DOUBLE(static_cast<double>(value));
+        NEXT();
+    }
+    INSN(l2i) {
+        auto value = POP_LONG();
+        PUSH_INT(static_cast<int32_t>(value));
+        NEXT();
+    }
+    INSN(l2f) {
+        auto value = POP_LONG();
+        PUSH_FLOAT(static_cast<float>(value));
+        NEXT();
+    }
+    INSN(l2d) {
+        auto value = POP_LONG();
+        PUSH_DOUBLE(static_cast<double>(value));
+        NEXT();
+    }
+    INSN(f2i) {
+        auto value = POP_FLOAT();
+        PUSH_INT(saturate<int32_t>(value));
+        NEXT();
+    }
+    INSN(f2l) {
+        auto value = POP_FLOAT();
+        PUSH_LONG(saturate<int64_t>(value));
+        NEXT();
+    }
+    INSN(f2d) {
+        auto value = POP_FLOAT();
+        PUSH_DOUBLE(static_cast<double>(value));
+        NEXT();
+    }
+    INSN(d2i) {
+        auto value = POP_DOUBLE();
+        PUSH_INT(saturate<int32_t>(value));
+        NEXT();
+    }
+    INSN(d2l) {
+        auto value = POP_DOUBLE();
+        PUSH_LONG(saturate<int64_t>(value));
+        NEXT();
+    }
+    INSN(d2f) {
+        auto value = POP_DOUBLE();
+        PUSH_FLOAT(static_cast<float>(value));
+        NEXT();
+    }
+    INSN(i2b) {
+        auto value = POP_INT();
+        PUSH_INT(static_cast<int8_t>(value));
+        NEXT();
+    }
+    INSN(i2c) {
+        auto value = POP_INT();
+        PUSH_INT(static_cast<uint16_t>(value));
+        NEXT();
+    }
+    INSN(i2s) {
+        auto value = POP_INT();
+        PUSH_INT(static_cast<int16_t>(value));
+        NEXT();
+    }
+    INSN(lcmp) {
+        auto value2 = POP_LONG();
+        auto value1 = POP_LONG();
+        PUSH_INT((value1 < value2) ? -1 : ((value1 == value2) ? 0 : 1));
+        NEXT();
+    }
+    INSN(fcmpl)
+    INSN(fcmpg) {
+        auto value2 = POP_FLOAT();
+        auto value1 = POP_FLOAT();
+        if (std::isnan(value1) || std::isnan(value2)) {
+            PUSH_INT(ip->opcode == fcmpg ? 1 : -1);
+        } else {
+            PUSH_INT((value1 < value2) ? -1 : ((value1 == value2) ? 0 : 1));
+        }
+        NEXT();
+    }
+    INSN(dcmpl)
+    INSN(dcmpg) {
+        auto value2 = POP_DOUBLE();
+        auto value1 = POP_DOUBLE();
+        if (std::isnan(value1) || std::isnan(value2)) {
+            PUSH_INT(ip->opcode == dcmpg ? 1 : -1);
+        } else {
+            PUSH_INT((value1 < value2) ? -1 : ((value1 == value2) ? 0 : 1));
+        }
+        NEXT();
+    }
+    if_N(ifeq, ==)
+    if_N(ifne, !=)
+    if_N(iflt, <)
+    if_N(ifge, >=)
+    if_N(ifgt, >)
+    if_N(ifle, <=)
+    if_icmpN(if_icmpeq, ==)
+    if_icmpN(if_icmpne, !=)
+    if_icmpN(if_icmplt, <)
+    if_icmpN(if_icmpge, >=)
+    if_icmpN(if_icmpgt, >)
+    if_icmpN(if_icmple, <=)
+    INSN(if_acmpeq) {
+        auto value2 = POP_REF();
+        auto value1 = POP_REF();
+        if (value1 == value2) {
+            JUMP(ip->a);
+        }
+        NEXT();
+    }
+    INSN(if_acmpne) {
+        auto value2 = POP_REF();
+        auto value1 = POP_REF();
+        if (value1 != value2) {
+            JUMP(ip->a);
+        }
+        NEXT();
+    }
+    INSN(goto_) {
+        JUMP(ip->a);
+    }
+    // todo jsr
+    INSN(tableswitch) {
+        // 减去最小的键后按无符号数比较，一次比较即可同时排除两端越界的键
+        auto table = frame->method->code_info->switch_tables.data() + ip->c;
+        auto index = static_cast<uint32_t>(POP_INT()) - static_cast<uint32_t>(ip->b);
+        JUMP(index < static_cast<uint32_t>(table[0]) ? table[1 + index] : ip->a);
+    }
+    INSN(lookupswitch) {
+        auto table = frame->method->code_info->switch_tables.data() + ip->c;
+        auto key = POP_INT();
+        JUMP(lookupSwitch(table, key, ip->a));
+    }
+    INSN(ireturn) {
+        auto i = POP_INT();
+        locals->i = i;
+        sp = locals + 1;
+        RETURN();
+    }
+    INSN(lreturn) {
+        auto l = POP_LONG();
+        locals->l = l;
+        sp = locals + 2;
+        RETURN();
+    }
+    INSN(freturn) {
+        auto f = POP_FLOAT();
+        locals->f = f;
+        sp = locals + 1;
+        RETURN();
+    }
+    INSN(dreturn) {
+        auto d = POP_DOUBLE();
+        locals->d = d;
+        sp = locals + 2;
+        RETURN();
+    }
+    INSN(areturn) {
+        auto ref = POP_REF();
+        locals->ref = ref;
+        sp = locals + 1;
+        RETURN();
+    }
+    INSN(return_) {
+        sp = locals;
+        RETURN();
+    }
+    xstatic(getstatic)
+    xstatic(putstatic)
+    INSN(invokevirtual) {
+        INVOKE_VIRTUAL();
+    }
+    INSN(invokespecial) {
+        auto &&entry = frame->class_->resolved_entries[ip->a];
+        auto &&resolved = entry.resolved ? entry : SLOW_PATH(resolveMethod(*frame->class_, ip->a));
+        auto slots = resolved.method->args_slots + 1;
+        NULL_CHECK(sp[-slots].ref);
+        INVOKE(resolved, slots);
+    }
+    INSN(invokestatic) {
+        auto &&entry = frame->class_->resolved_entries[ip->a];
+        auto &&resolved = entry.resolved ? entry : SLOW_PATH(resolveMethod(*frame->class_, ip->a));
+        INVOKE(resolved, resolved.method->args_slots);
+    }
+    INSN(invokeinterface) {
+        INVOKE_VIRTUAL();
+    }
+    INSN(new_) {
+        auto &&entry = frame->class_->resolved_entries[ip->a];
+        auto &&resolved = entry.resolved ? entry : SLOW_PATH(resolveClass(*frame->class_, ip->a));
+        GC_POINT();
+        PUSH_REF(heap->allocate(resolved.class_, resolved.class_->instance_size));
+        NEXT();
+    }
+    INSN(newarray) {
+        GC_POINT();
+        auto length = POP_INT();
+        PUSH_REF(heap->allocateArray(static_cast<Array::Element>(ip->a), length));
+        NEXT();
+    }
+    INSN(anewarray) {
+        // 元素的类型不参与运行时检查，因此无需解析
+        GC_POINT();
+        auto length = POP_INT();
+        PUSH_REF(heap->allocateArray(Array::t_reference, length));
+        NEXT();
+    }
+    INSN(arraylength) {
+        auto array = static_cast<Array *>(POP_REF());
+        NULL_CHECK(array);
+        PUSH_INT(array->length);
+        NEXT();
+    }
+    INSN(athrow) {
+        auto object = static_cast<Object *>(POP_REF());
+        NULL_CHECK(object);
+        exception = object;
+        goto throw_;
+    }
+    INSN(multianewarray) {
+        GC_POINT();
+        sp -= ip->b;
+        auto array = newMultiArray(frame->class_->getClassName(ip->a), sp, ip->b);
+        PUSH_REF(array);
+        NEXT();
+    }
+    INSN(ifnull) {
+        if (POP_REF() == nullptr) {
+            JUMP(ip->a);
+        }
+        NEXT();
+    }
+    INSN(ifnonnull) {
+        if (POP_REF() != nullptr) {
+            JUMP(ip->a);
+        }
+        NEXT();
+    }
+    iload_iload_if_icmpN(if_icmpeq, ==)
+    iload_iload_if_icmpN(if_icmpne, !=)
+    iload_iload_if_icmpN(if_icmplt, <)
+    iload_iload_if_icmpN(if_icmpge, >=)
+    iload_iload_if_icmpN(if_icmpgt, >)
+    iload_iload_if_icmpN(if_icmple, <=)
+    iload_irem_ifN(ifeq, ==)
+    iload_irem_ifN(ifne, !=)
+    INSN(iinc_goto) {
+        locals[ip->a].i = WRAP_INT(locals[ip->a].i, +, ip->b);
+        JUMP(ip->c);
+    }
+    dload_dop_dstore(dadd, +)
+    dload_dop_dstore(dsub, -)
+    INSN(ipopcnt) {
+        auto value = POP_INT();
+        PUSH_INT(bitCount(static_cast<uint32_t>(value)));
+        NEXT();
+    }
+    INSN(lpopcnt) {
+        auto value = POP_LONG();
+        PUSH_INT(bitCount(static_cast<uint64_t>(value)));
+        NEXT();
+    }
+    INSN(iclz) {
+        auto value = POP_INT();
+        PUSH_INT(leadingZeros(static_cast<uint32_t>(value)));
+        NEXT();
+    }
+    INSN(lclz) {
+        auto value = POP_LONG();
+        PUSH_INT(leadingZeros(static_cast<uint64_t>(value)));
+        NEXT();
+    }
+    INSN(ictz) {
+        auto value = POP_INT();
+        PUSH_INT(trailingZeros(static_cast<uint32_t>(value)));
+        NEXT();
+    }
+    INSN(lctz) {
+        auto value = POP_LONG();
+        PUSH_INT(trailingZeros(static_cast<uint64_t>(value)));
+        NEXT();
+    }
+    INSN(irotl) {
+        auto distance = POP_INT();
+        auto value = POP_INT();
+        PUSH_INT(static_cast<int32_t>(rotateLeft(static_cast<uint32_t>(value), distance)));
+        NEXT();
+    }
+    INSN(irotr) {
+        auto distance = POP_INT();
+        auto value = POP_INT();
+        PUSH_INT(static_cast<int32_t>(rotateLeft(static_cast<uint32_t>(value), WRAP_INT(0, -, distance))));
+        NEXT();
+    }
+    INSN(lrotl) {
+        auto distance = POP_INT();
+        auto value = POP_LONG();
+        PUSH_LONG(static_cast<int64_t>(rotateLeft(static_cast<uint64_t>(value), distance)));
+        NEXT();
+    }
+    INSN(lrotr) {
+        auto distance = POP_INT();
+        auto value = POP_LONG();
+        PUSH_LONG(static_cast<int64_t>(rotateLeft(static_cast<uint64_t>(value), WRAP_INT(0, -, distance))));
+        NEXT();
+    }
+    INSN(ibswap) {
+        auto value = POP_INT();
+        PUSH_INT(static_cast<int32_t>(reverseBytes(static_cast<uint32_t>(value))));
+        NEXT();
+    }
+    INSN(lbswap) {
+        auto value = POP_LONG();
+        PUSH_LONG(static_cast<int64_t>(reverseBytes(static_cast<uint64_t>(value))));
+        NEXT();
+    }
+    INSN(arraycopy) {
+        sp -= 5;
+        copyArray(sp[0].ref, sp[1].i, sp[2].ref, sp[3].i, sp[4].i);
+        NEXT();
+    }
+    INSN(arrayfill) {
+        sp -= 1 + ip->b;
+        auto array = static_cast<Array *>(sp[0].ref);
+        NULL_CHECK(array);
+        fillArray(array, 0, array->length, sp + 1);
+        NEXT();
+    }
+    INSN(arrayfill_range) {
+        sp -= 3 + ip->b;
+        fillArray(sp[0].ref, sp[1].i, sp[2].i, sp + 3);
+        NEXT();
+    }
+    INSN(invokenative) {
+        auto &&method = natives[ip->b];
+        sp -= method.args_slots;
+        method.function(sp);
+        sp += method.return_slots;
+        NEXT();
+    }
+    getfield_T(byte, int8_t, PUSH_INT)
+    getfield_T(char, uint16_t, PUSH_INT)
+    getfield_T(short, int16_t, PUSH_INT)
+    getfield_T(int, int32_t, PUSH_INT)
+    getfield_T(long, int64_t, PUSH_LONG)
+    getfield_T(ref, void *, PUSH_REF)
+    INSN(putfield_boolean) {
+        FIELD_OFFSET();
+        auto value = static_cast<uint8_t>(POP_INT() & 1);
+        auto object = static_cast<uint8_t *>(POP_REF());
+        NULL_CHECK(object);
+        object[offset] = value;
+        NEXT();
+    }
+    putfield_T(byte, int8_t, POP_INT)
+    putfield_T(short, int16_t, POP_INT)
+    putfield_T(int, int32_t, POP_INT)
+    putfield_T(long, int64_t, POP_LONG)
+    INSN(putfield_ref) {
+        FIELD_OFFSET();
+        auto value = POP_REF();
+        auto object = static_cast<uint8_t *>(POP_REF());
+        NULL_CHECK(object);
+        memcpy(object + offset, &value, sizeof(value));
+        heap->writeBarrier(object);
+        NEXT();
+    }
+    getstatic_T(byte, int8_t, PUSH_INT)
+    getstatic_T(char, uint16_t, PUSH_INT)
+    getstatic_T(short, int16_t, PUSH_INT)
+    getstatic_T(int, int32_t, PUSH_INT)
+    getstatic_T(long, int64_t, PUSH_LONG)
+    getstatic_T(ref, void *, PUSH_REF)
+    INSN(putstatic_boolean) {
+        auto value = static_cast<uint8_t>(POP_INT() & 1);
+        *staticAddress(*ip) = value;
+        NEXT();
+    }
+    putstatic_T(byte, int8_t, POP_INT)
+    putstatic_T(short, int16_t, POP_INT)
+    putstatic_T(int, int32_t, POP_INT)
+    putstatic_T(long, int64_t, POP_LONG)
+    putstatic_T(ref, void *, POP_REF)
+    INSN(end_of_code) {
+        throw sese::Exception("execution fell off the end of the code");
+    }
+    // todo jsr/ret
+#ifdef JVM_COMPUTED_GOTO
+L_unsupported:
+#else
+    default:
+#endif
+    SESE_ERROR("opcode %d", ip->opcode);
+    throw sese::Exception("Unsupported opcode");
+#ifndef JVM_COMPUTED_GOTO
+    }
+#endif
+leave:
+    // 返回值已写入局部变量表起始位置，sp 指向其后，即调用者弹出参数后的栈顶
+    if constexpr ((profiling & method_profiling) != 0) {
+        profiler->exit();
+        counts = profiler->counts();
+    }
+    frame = stack.pop();
+    if (frame + 1 == entry_frame) {
+        return;
+    }
+    LOAD_FRAME();
+    ip = frame->ip;
+    if (HAS_NATIVE()) {
+        ++ip;
+        goto native;
+    }
+    NEXT();
+
+native: {
+    // 从 ip 处进入编译后的代码，直至遇到调用、返回或者慢速路径时回到解释器，
+    // 此时操作数栈已位于帧内存中，只需按照返回的栈深度恢复 sp
+    auto &&code = frame->method->code_info;
+    auto result = code->native(locals, static_cast<uint32_t>(ip - base));
+    ip = base + (result & 0xFFFF);
+    sp = locals + code->max_locals + (result >> 16);
+    if (safepoint.requested()) {
+        // 编译后的代码在回边处因安全点请求退出，暂停后从同一位置重新进入
+        GC_POINT();
+        safepoint.park();
+        goto native;
+    }
+    DISPATCH();
+}
+
+throw_:
+    // 依次在当前帧及其调用者中查找处理器，找到时清空操作数栈并压入异常对象，
+    // 否则弹出栈帧继续查找，调用者的 ip 停留在调用指令上
+    for (;;) {
+        auto &&code = *frame->method->code_info;
+        auto handler = findHandler(*frame->class_, code, static_cast<int32_t>(ip - base), exception);
+        if (handler >= 0) {
+            sp = locals + code.max_locals;
+            PUSH_REF(exception);
+            exception = nullptr;
+            JUMP(handler);
+        }
+        if (tracer) tracer->onExit(*frame, ip->pc);
+        if constexpr ((profiling & method_profiling) != 0) {
+            profiler->exit();
+            counts = profiler->counts();
+        }
+        frame = stack.pop();
+        if (frame + 1 == entry_frame) {
+            goto uncaught;
+        }
+        LOAD_FRAME();
+        ip = frame->ip;
+    }
+    } catch (const sese::Exception &e) {
+        // 方法解析、分配、本地方法等以 C++ 异常报告的 Java 异常，转换为异常对象后回到循环中查找处理器
+        frame->ip = ip;
+        frame->sp = locals + frame->method->code_info->max_locals;
+        exception = toThrowable(e.what());
+        if (exception == nullptr) throw;
+    }
+    goto resume;
+
+uncaught:
+    // 入口帧也没有处理器，恢复为 C++ 异常交给调用者
+    throw sese::Exception(describe(exception));
+}
@@ -0,0 +1,77 @@
+#include "Opcode.h"
+#include "Runtime.h"
+
+#include <string>
+#include <unordered_map>
+
+namespace {
+    /// 可替换为内建指令的方法，键为 "类名.方法名描述符"
+    const std::unordered_map<std::string, jvm::InternalOpcode> &intrinsics() {
+        static const std::unordered_map<std::string, jvm::InternalOpcode> table{
+            {"java/lang/Integer.bitCount(I)I", jvm::ipopcnt},
+            {"java/lang/Long.bitCount(J)I", jvm::lpopcnt},
+            {"java/lang/Integer.numberOfLeadingZeros(I)I", jvm::iclz},
+            {"java/lang/Long.numberOfLeadingZeros(J)I", jvm::lclz},
+            {"java/lang/Integer.numberOfTrailingZeros(I)I", jvm::ictz},
+            {"java/lang/Long.numberOfTrailingZeros(J)I", jvm::lctz},
+            {"java/lang/Integer.rotateLeft(II)I", jvm::irotl},
+            {"java/lang/Integer.rotateRight(II)I", jvm::irotr},
+            {"java/lang/Long.rotateLeft(JI)J", jvm::lrotl},
+            {"java/lang/Long.rotateRight(JI)J", jvm::lrotr},
+            {"java/lang/Integer.reverseBytes(I)I", jvm::ibswap},
+            {"java/lang/Long.reverseBytes(J)J", jvm::lbswap},
+            {"java/lang/System.arraycopy(Ljava/lang/Object;ILjava/lang/Object;II)V", jvm::arraycopy},
+            {"java/util/Arrays.fill([ZZ)V", jvm::arrayfill},
+            {"java/util/Arrays.fill([BB)V", jvm::arrayfill},
+            {"java/util/Arrays.fill([CC)V", jvm::arrayfill},
+            {"java/util/Arrays.fill([SS)V", jvm::arrayfill},
+            {"java/util/Arrays.fill([II)V", jvm::arrayfill},
+            {"java/util/Arrays.fill([JJ)V", jvm::arrayfill},
+            {"java/util/Arrays.fill([FF)V", jvm::arrayfill},
+            {"java/util/Arrays.fill([DD)V", jvm::arrayfill},
+            {"java/util/Arrays.fill([Ljava/lang/Object;Ljava/lang/Object;)V", jvm::arrayfill},
+            {"java/util/Arrays.fill([ZIIZ)V", jvm::arrayfill_range},
+            {"java/util/Arrays.fill([BIIB)V", jvm::arrayfill_range},
+            {"java/util/Arrays.fill([CIIC)V", jvm::arrayfill_range},
+            {"java/util/Arrays.fill([SIIS)V", jvm::arrayfill_range},
+            {"java/util/Arrays.fill([IIII)V", jvm::arrayfill_range},
+            {"java/util/Arrays.fill([JIIJ)V", jvm::arrayfill_range},
+            {"java/util/Arrays.fill([FIIF)V", jvm::arrayfill_range},
+            {"java/util/Arrays.fill([DIID)V", jvm::arrayfill_range},
+            {"java/util/Arrays.fill([Ljava/lang/Object;IILjava/lang/Object;)V", jvm::arrayfill_range},
+        };
+        return table;
+    }
+}
+
+void jvm::Runtime::intrinsify(const Class &class_, std::vector<Instruction> &instructions) const {
+    auto &&table = intrinsics();
+    std::string key;
+    for (auto &&insn: instructions) {
+        if (insn.opcode == invokespecial) {
+            auto ref = class_.getMemberRef(static_cast<uint16_t>(insn.a));
+            if (ref.class_name == "java/lang/Object" && ref.name == "<init>") {
+                insn.opcode = pop;
+            }
+            continue;
+        }
+        if (insn.opcode != invokestatic) continue;
+        auto ref = class_.getMemberRef(static_cast<uint16_t>(insn.a));
+        key.assign(ref.class_name).append(".").append(ref.name).append(ref.descriptor);
+        auto it = table.find(key);
+        if (it == table.end()) {
+            auto native = native_indices.find(key);
+            if (native != native_indices.end()) {
+                insn.opcode = invokenative;
+                insn.b = native->second;
+            }
+            continue;
+        }
+        insn.opcode = it->second;
+        if (insn.opcode == arrayfill || insn.opcode == arrayfill_range) {
+            // 描述符以 ")V" 结尾，其前一个字符为最后一个参数的末尾
+            auto last = ref.descriptor[ref.descriptor.size() - 3];
+            insn.b = last == 'J' || last == 'D' ? 2 : 1;
+        }
+    }
+}
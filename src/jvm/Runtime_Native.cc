@@ -0,0 +1,307 @@
+#include "Runtime.h"
+
+#include <sese/util/Exception.h>
+
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+namespace {
+    using jvm::Slot;
+
+    /// 描述符中一个参数或者返回值占用的 Slot 数量，pos 移动到其后
+    /// @return 描述符格式错误时返回 -1
+    int32_t slotsOf(std::string_view descriptor, size_t &pos) {
+        if (pos >= descriptor.size()) return -1;
+        auto type = descriptor[pos];
+        if (type == '[') {
+            while (pos < descriptor.size() && descriptor[pos] == '[') ++pos;
+            if (pos >= descriptor.size()) return -1;
+            type = descriptor[pos] == 'L' ? 'L' : 'I';
+            if (type == 'I') {
+                ++pos;
+                return 1;
+            }
+        }
+        switch (type) {
+            case 'J':
+            case 'D':
+                ++pos;
+                return 2;
+            case 'V':
+                ++pos;
+                return 0;
+            case 'L': {
+                auto end = descriptor.find(';', pos);
+                if (end == std::string_view::npos) return -1;
+                pos = end + 1;
+                return 1;
+            }
+            case 'B':
+            case 'C':
+            case 'F':
+            case 'I':
+            case 'S':
+            case 'Z':
+                ++pos;
+                return 1;
+            default:
+                return -1;
+        }
+    }
+
+    // 以下为 Java 语义的数学函数，与 C++ 标准库的差异在于 NaN、有符号零以及整数溢出的处理
+
+    /// NaN 优先，+0.0 大于 -0.0
+    template<typename T>
+    T max(T a, T b) {
+        if (std::isnan(a)) return a;
+        if (std::isnan(b)) return b;
+        if (a == 0 && b == 0) return std::signbit(a) ? b : a;
+        return a >= b ? a : b;
+    }
+
+    template<typename T>
+    T min(T a, T b) {
+        if (std::isnan(a)) return a;
+        if (std::isnan(b)) return b;
+        if (a == 0 && b == 0) return std::signbit(a) ? a : b;
+        return a <= b ? a : b;
+    }
+
+    /// 最小值的绝对值仍为最小值
+    template<typename T>
+    T abs(T value) {
+        using U = std::make_unsigned_t<T>;
+        return value < 0 ? static_cast<T>(U{} - static_cast<U>(value)) : value;
+    }
+
+    template<typename T>
+    T floorDiv(T x, T y) {
+        if (y == 0) throw sese::Exception("java/lang/ArithmeticException: / by zero");
+        if (y == -1) return static_cast<T>(std::make_unsigned_t<T>{} - static_cast<std::make_unsigned_t<T> >(x));
+        auto q = x / y;
+        if ((x % y != 0) && ((x < 0) != (y < 0))) --q;
+        return q;
+    }
+
+    template<typename T>
+    T floorMod(T x, T y) {
+        if (y == 0) throw sese::Exception("java/lang/ArithmeticException: / by zero");
+        if (y == -1) return 0;
+        auto m = x % y;
+        if (m != 0 && ((m < 0) != (y < 0))) m += y;
+        return m;
+    }
+
+    /// 四舍五入，恰好位于中间时向正无穷方向取整，NaN 为 0，超出范围时取最接近的边界值
+    template<typename To, typename From>
+    To round(From value) {
+        if (std::isnan(value)) return 0;
+        auto floor = std::floor(value);
+        if (value - floor >= static_cast<From>(0.5)) floor += 1;
+        if (floor >= static_cast<From>(std::numeric_limits<To>::max())) return std::numeric_limits<To>::max();
+        if (floor <= static_cast<From>(std::numeric_limits<To>::min())) return std::numeric_limits<To>::min();
+        return static_cast<To>(floor);
+    }
+
+    /// 与 C 的 pow 不同，指数为 NaN 时结果总是 NaN，底数绝对值为 1 且指数为无穷时结果为 NaN
+    double pow(double x, double y) {
+        if (std::isnan(y)) return y;
+        if (std::isinf(y) && std::fabs(x) == 1) return std::numeric_limits<double>::quiet_NaN();
+        return std::pow(x, y);
+    }
+
+    template<typename T>
+    T signum(T value) {
+        if (std::isnan(value) || value == 0) return value;
+        return value > 0 ? 1 : -1;
+    }
+
+    template<typename T>
+    T checked(bool overflow, T value, const char *type) {
+        if (overflow) throw sese::Exception(std::string("java/lang/ArithmeticException: ") + type + " overflow");
+        return value;
+    }
+
+    template<typename To, typename From>
+    To bitCast(From value) {
+        static_assert(sizeof(To) == sizeof(From));
+        To result;
+        memcpy(&result, &value, sizeof(To));
+        return result;
+    }
+
+    struct Builtin {
+        const char *name;
+        jvm::NativeFunction function;
+        bool nothrow;
+    };
+
+    // 参数与返回值的存取，long/double 参数占用两个 Slot
+    const Builtin builtins[] = {
+        {"java/lang/Math.sqrt(D)D", [](Slot *args) { args[0].d = std::sqrt(args[0].d); }, true},
+        {"java/lang/StrictMath.sqrt(D)D", [](Slot *args) { args[0].d = std::sqrt(args[0].d); }, true},
+        {"java/lang/Math.cbrt(D)D", [](Slot *args) { args[0].d = std::cbrt(args[0].d); }, true},
+        {"java/lang/Math.sin(D)D", [](Slot *args) { args[0].d = std::sin(args[0].d); }, true},
+        {"java/lang/Math.cos(D)D", [](Slot *args) { args[0].d = std::cos(args[0].d); }, true},
+        {"java/lang/Math.tan(D)D", [](Slot *args) { args[0].d = std::tan(args[0].d); }, true},
+        {"java/lang/Math.asin(D)D", [](Slot *args) { args[0].d = std::asin(args[0].d); }, true},
+        {"java/lang/Math.acos(D)D", [](Slot *args) { args[0].d = std::acos(args[0].d); }, true},
+        {"java/lang/Math.atan(D)D", [](Slot *args) { args[0].d = std::atan(args[0].d); }, true},
+        {"java/lang/Math.atan2(DD)D", [](Slot *args) { args[0].d = std::atan2(args[0].d, args[2].d); }, true},
+        {"java/lang/Math.hypot(DD)D", [](Slot *args) { args[0].d = std::hypot(args[0].d, args[2].d); }, true},
+        {"java/lang/Math.exp(D)D", [](Slot *args) { args[0].d = std::exp(args[0].d); }, true},
+        {"java/lang/Math.log(D)D", [](Slot *args) { args[0].d = std::log(args[0].d); }, true},
+        {"java/lang/Math.log10(D)D", [](Slot *args) { args[0].d = std::log10(args[0].d); }, true},
+        {"java/lang/Math.pow(DD)D", [](Slot *args) { args[0].d = pow(args[0].d, args[2].d); }, true},
+        {"java/lang/Math.floor(D)D", [](Slot *args) { args[0].d = std::floor(args[0].d); }, true},
+        {"java/lang/Math.ceil(D)D", [](Slot *args) { args[0].d = std::ceil(args[0].d); }, true},
+        {"java/lang/Math.rint(D)D", [](Slot *args) { args[0].d = std::nearbyint(args[0].d); }, true},
+        {"java/lang/Math.round(D)J", [](Slot *args) { args[0].l = round<int64_t>(args[0].d); }, true},
+        {"java/lang/Math.round(F)I", [](Slot *args) { args[0].i = round<int32_t>(args[0].f); }, true},
+        {"java/lang/Math.signum(D)D", [](Slot *args) { args[0].d = signum(args[0].d); }, true},
+        {"java/lang/Math.signum(F)F", [](Slot *args) { args[0].f = signum(args[0].f); }, true},
+        {"java/lang/Math.abs(I)I", [](Slot *args) { args[0].i = abs(args[0].i); }, true},
+        {"java/lang/Math.abs(J)J", [](Slot *args) { args[0].l = abs(args[0].l); }, true},
+        {"java/lang/Math.abs(F)F", [](Slot *args) { args[0].f = std::fabs(args[0].f); }, true},
+        {"java/lang/Math.abs(D)D", [](Slot *args) { args[0].d = std::fabs(args[0].d); }, true},
+        {"java/lang/Math.max(II)I", [](Slot *args) { args[0].i = std::max(args[0].i, args[1].i); }, true},
+        {"java/lang/Math.max(JJ)J", [](Slot *args) { args[0].l = std::max(args[0].l, args[2].l); }, true},
+        {"java/lang/Math.max(FF)F", [](Slot *args) { args[0].f = max(args[0].f, args[1].f); }, true},
+        {"java/lang/Math.max(DD)D", [](Slot *args) { args[0].d = max(args[0].d, args[2].d); }, true},
+        {"java/lang/Math.min(II)I", [](Slot *args) { args[0].i = std::min(args[0].i, args[1].i); }, true},
+        {"java/lang/Math.min(JJ)J", [](Slot *args) { args[0].l = std::min(args[0].l, args[2].l); }, true},
+        {"java/lang/Math.min(FF)F", [](Slot *args) { args[0].f = min(args[0].f, args[1].f); }, true},
+        {"java/lang/Math.min(DD)D", [](Slot *args) { args[0].d = min(args[0].d, args[2].d); }, true},
+        {"java/lang/Math.floorDiv(II)I", [](Slot *args) { args[0].i = floorDiv(args[0].i, args[1].i); }, false},
+        {"java/lang/Math.floorDiv(JJ)J", [](Slot *args) { args[0].l = floorDiv(args[0].l, args[2].l); }, false},
+        {"java/lang/Math.floorMod(II)I", [](Slot *args) { args[0].i = floorMod(args[0].i, args[1].i); }, false},
+        {"java/lang/Math.floorMod(JJ)J", [](Slot *args) { args[0].l = floorMod(args[0].l, args[2].l); }, false},
+        {
+            "java/lang/Math.floorMod(JI)I",
+            [](Slot *args) { args[0].i = static_cast<int32_t>(floorMod<int64_t>(args[0].l, args[2].i)); }, false
+        },
+        {
+            "java/lang/Math.addExact(II)I", [](Slot *args) {
+                int32_t result;
+                auto overflow = __builtin_add_overflow(args[0].i, args[1].i, &result);
+                args[0].i = checked(overflow, result, "integer");
+            },
+            false
+        },
+        {
+            "java/lang/Math.addExact(JJ)J", [](Slot *args) {
+                int64_t result;
+                auto overflow = __builtin_add_overflow(args[0].l, args[2].l, &result);
+                args[0].l = checked(overflow, result, "long");
+            },
+            false
+        },
+        {
+            "java/lang/Math.subtractExact(II)I", [](Slot *args) {
+                int32_t result;
+                auto overflow = __builtin_sub_overflow(args[0].i, args[1].i, &result);
+                args[0].i = checked(overflow, result, "integer");
+            },
+            false
+        },
+        {
+            "java/lang/Math.subtractExact(JJ)J", [](Slot *args) {
+                int64_t result;
+                auto overflow = __builtin_sub_overflow(args[0].l, args[2].l, &result);
+                args[0].l = checked(overflow, result, "long");
+            },
+            false
+        },
+        {
+            "java/lang/Math.multiplyExact(II)I", [](Slot *args) {
+                int32_t result;
+                auto overflow = __builtin_mul_overflow(args[0].i, args[1].i, &result);
+                args[0].i = checked(overflow, result, "integer");
+            },
+            false
+        },
+        {
+            "java/lang/Math.multiplyExact(JJ)J", [](Slot *args) {
+                int64_t result;
+                auto overflow = __builtin_mul_overflow(args[0].l, args[2].l, &result);
+                args[0].l = checked(overflow, result, "long");
+            },
+            false
+        },
+        {
+            "java/lang/Math.toIntExact(J)I", [](Slot *args) {
+                auto value = args[0].l;
+                args[0].i = checked(value != static_cast<int32_t>(value), static_cast<int32_t>(value), "integer");
+            },
+            false
+        },
+        {"java/lang/Double.isNaN(D)Z", [](Slot *args) { args[0].i = std::isnan(args[0].d); }, true},
+        {"java/lang/Float.isNaN(F)Z", [](Slot *args) { args[0].i = std::isnan(args[0].f); }, true},
+        {
+            "java/lang/Double.doubleToRawLongBits(D)J",
+            [](Slot *args) { args[0].l = bitCast<int64_t>(args[0].d); }, true
+        },
+        {
+            "java/lang/Double.longBitsToDouble(J)D",
+            [](Slot *args) { args[0].d = bitCast<double>(args[0].l); }, true
+        },
+        {
+            "java/lang/Float.floatToRawIntBits(F)I",
+            [](Slot *args) { args[0].i = bitCast<int32_t>(args[0].f); }, true
+        },
+        {
+            "java/lang/Float.intBitsToFloat(I)F",
+            [](Slot *args) { args[0].f = bitCast<float>(args[0].i); }, true
+        },
+        {
+            "java/lang/System.nanoTime()J", [](Slot *args) {
+                args[0].l = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                    std::chrono::steady_clock::now().time_since_epoch()).count();
+            },
+            true
+        },
+        {
+            "java/lang/System.currentTimeMillis()J", [](Slot *args) {
+                args[0].l = std::chrono::duration_cast<std::chrono::milliseconds>(
+                    std::chrono::system_clock::now().time_since_epoch()).count();
+            },
+            true
+        },
+    };
+}
+
+void jvm::Runtime::regNative(const std::string &name, NativeFunction function, bool nothrow) {
+    auto begin = name.find('(');
+    if (begin == std::string::npos || function == nullptr) {
+        throw sese::Exception("illegal native method " + name);
+    }
+    std::string_view descriptor(name);
+    NativeMethod method{function, 0, 0, nothrow};
+    auto pos = begin + 1;
+    while (pos < descriptor.size() && descriptor[pos] != ')') {
+        auto slots = slotsOf(descriptor, pos);
+        if (slots <= 0) throw sese::Exception("illegal native method " + name);
+        method.args_slots += static_cast<uint16_t>(slots);
+    }
+    auto return_slots = ++pos < descriptor.size() ? slotsOf(descriptor, pos) : -1;
+    if (return_slots < 0 || pos != descriptor.size()) {
+        throw sese::Exception("illegal native method " + name);
+    }
+    method.return_slots = static_cast<uint16_t>(return_slots);
+    auto iter = native_indices.find(name);
+    if (iter != native_indices.end()) {
+        natives[iter->second] = method;
+        return;
+    }
+    native_indices.emplace(name, static_cast<int32_t>(natives.size()));
+    natives.push_back(method);
+}
+
+void jvm::Runtime::regBuiltinNatives() {
+    for (auto &&builtin: builtins) {
+        regNative(builtin.name, builtin.function, builtin.nothrow);
+    }
+}
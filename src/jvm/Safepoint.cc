@@ -0,0 +1,139 @@
+#include "Safepoint.h"
+
+#include <algorithm>
+
+namespace {
+    /// Safepoint 编号，所有实例共用，线程私有的注册表据此区分先后创建于同一地址的实例
+    uint64_t nextId() {
+        static std::atomic<uint64_t> next{1};
+        return next++;
+    }
+}
+
+jvm::Safepoint::Safepoint() : id(nextId()) {
+}
+
+jvm::Safepoint::~Safepoint() {
+    std::lock_guard<std::mutex> guard(mutex);
+    for (auto &&mutator: mutators) {
+        mutator->orphaned = true;
+    }
+}
+
+jvm::Safepoint::Mutator *jvm::Safepoint::current() {
+    // 当前线程在各个 Safepoint 中的注册，线程退出时标记为已退出，由 Safepoint 在之后的注册中移除
+    struct Registrations {
+        std::vector<std::pair<uint64_t, std::shared_ptr<Mutator> > > entries;
+
+        ~Registrations() {
+            for (auto &&entry: entries) entry.second->exited = true;
+        }
+    };
+    thread_local Registrations registrations;
+    auto &&entries = registrations.entries;
+    for (auto &&[owner, mutator]: entries) {
+        if (owner == id) return mutator.get();
+    }
+    entries.erase(std::remove_if(entries.begin(), entries.end(), [](auto &&entry) {
+        return entry.second->orphaned.load();
+    }), entries.end());
+    auto mutator = std::make_shared<Mutator>();
+    mutator->stack = &FrameStack::current();
+    {
+        std::lock_guard<std::mutex> guard(mutex);
+        mutators.erase(std::remove_if(mutators.begin(), mutators.end(), [](auto &&item) {
+            return item->exited.load();
+        }), mutators.end());
+        mutators.push_back(mutator);
+    }
+    entries.emplace_back(id, mutator);
+    return mutator.get();
+}
+
+void jvm::Safepoint::resume(Mutator &mutator, Mutator::State waiting) {
+    // 先公开状态再检查请求，与 stopTheWorld 中先设置请求再检查各线程状态的顺序相对，
+    // 两者至少有一方能够看到对方的写入
+    for (;;) {
+        mutator.state = Mutator::running;
+        if (!pending) return;
+        std::unique_lock<std::mutex> lock(mutex);
+        mutator.state = waiting;
+        condition.notify_all();
+        condition.wait(lock, [this] { return !pending; });
+    }
+}
+
+jvm::Safepoint::Scope::Scope(Safepoint &safepoint) : safepoint(safepoint), mutator(safepoint.current()) {
+    if (mutator->depth++ == 0) {
+        safepoint.resume(*mutator, Mutator::idle);
+    }
+}
+
+jvm::Safepoint::Scope::~Scope() {
+    if (--mutator->depth == 0) {
+        mutator->state = Mutator::idle;
+        if (safepoint.pending) {
+            std::lock_guard<std::mutex> guard(safepoint.mutex);
+            safepoint.condition.notify_all();
+        }
+    }
+}
+
+jvm::Safepoint::Blocking::Blocking(Safepoint &safepoint) : safepoint(safepoint) {
+    auto current = safepoint.current();
+    if (current->depth == 0) return;
+    mutator = current;
+    mutator->state = Mutator::safe;
+    if (safepoint.pending) {
+        std::lock_guard<std::mutex> guard(safepoint.mutex);
+        safepoint.condition.notify_all();
+    }
+}
+
+jvm::Safepoint::Blocking::~Blocking() {
+    if (mutator) {
+        safepoint.resume(*mutator, Mutator::safe);
+    }
+}
+
+void jvm::Safepoint::park() {
+    auto mutator = current();
+    std::unique_lock<std::mutex> lock(mutex);
+    mutator->state = Mutator::safe;
+    condition.notify_all();
+    condition.wait(lock, [this] { return !pending; });
+    mutator->state = Mutator::running;
+}
+
+void jvm::Safepoint::stopTheWorld(const std::function<void()> &operation) {
+    auto self = current();
+    auto saved = static_cast<Mutator::State>(self->state.load());
+    std::unique_lock<std::mutex> lock(mutex);
+    pending = true;
+    if (saved == Mutator::running) {
+        self->state = Mutator::safe;
+    }
+    condition.wait(lock, [this] {
+        return std::none_of(mutators.begin(), mutators.end(), [](auto &&mutator) {
+            return mutator->state == Mutator::running;
+        });
+    });
+    auto finish = [&] {
+        pending = false;
+        self->state = saved;
+        condition.notify_all();
+    };
+    try {
+        operation();
+    } catch (...) {
+        finish();
+        throw;
+    }
+    finish();
+}
+
+void jvm::Safepoint::forEachStack(const std::function<void(FrameStack &)> &visit) const {
+    for (auto &&mutator: mutators) {
+        if (mutator->state == Mutator::safe && !mutator->exited) visit(*mutator->stack);
+    }
+}
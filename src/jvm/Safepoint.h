@@ -0,0 +1,117 @@
+#pragma once
+
+#include <jvm/Frame.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace jvm {
+    /// 多个线程在同一个堆上执行字节码时的全局安全点
+    /// @note 线程在 Scope 期间处于运行状态。垃圾收集前由发起收集的线程请求安全点，
+    /// 运行中的线程在回边与方法入口处检查请求并暂停；处于 Blocking 区域中的线程，
+    /// 例如等待堆的锁或者等待其他线程完成类初始化，视为已经到达安全点。
+    /// 所有运行中的线程都暂停后，各线程的 FrameStack 均处于可枚举的状态，收集结束后一并恢复
+    class Safepoint {
+        struct Mutator;
+
+    public:
+        Safepoint();
+
+        ~Safepoint();
+
+        Safepoint(const Safepoint &) = delete;
+
+        Safepoint &operator=(const Safepoint &) = delete;
+
+        /// 当前线程执行字节码的作用域，可以嵌套，最外层进入时若收集正在进行则等待其结束
+        class Scope {
+        public:
+            explicit Scope(Safepoint &safepoint);
+
+            ~Scope();
+
+            Scope(const Scope &) = delete;
+
+            Scope &operator=(const Scope &) = delete;
+
+        private:
+            Safepoint &safepoint;
+            Mutator *mutator;
+        };
+
+        /// 可能长时间等待的区域，期间当前线程视为已到达安全点，离开时若收集正在进行则等待其结束
+        /// @note 进入前当前线程的根集合需要处于可枚举的状态，区域内不能访问堆中的对象，
+        /// 也不能在持有其他线程进入安全点前可能等待的锁时离开；当前线程不在 Scope 中时没有任何效果
+        class Blocking {
+        public:
+            explicit Blocking(Safepoint &safepoint);
+
+            ~Blocking();
+
+            Blocking(const Blocking &) = delete;
+
+            Blocking &operator=(const Blocking &) = delete;
+
+        private:
+            Safepoint &safepoint;
+            Mutator *mutator{};
+        };
+
+        /// 是否有线程正在请求安全点，解释器在回边与方法入口处检查
+        [[nodiscard]] bool requested() const { return pending.load(std::memory_order_relaxed); }
+
+        /// 请求标志的地址，JIT 编译的代码在回边处直接读取
+        [[nodiscard]] const std::atomic<bool> *flag() const { return &pending; }
+
+        /// 暂停当前线程直至收集结束
+        /// @note 调用前当前线程的根集合需要处于可枚举的状态
+        void park();
+
+        /// 等待其他运行中的线程全部到达安全点后执行 operation，随后恢复这些线程；
+        /// 发起的线程自身在 operation 期间同样视为已到达安全点
+        /// @note 同一时刻只能有一个线程发起，由调用者的锁保证
+        void stopTheWorld(const std::function<void()> &operation);
+
+        /// 枚举已到达安全点的线程的 FrameStack，只能在 stopTheWorld 的 operation 中调用
+        void forEachStack(const std::function<void(FrameStack &)> &visit) const;
+
+    private:
+        /// 线程在此 Safepoint 中的状态，由 Safepoint 与线程私有的注册表共同持有
+        struct Mutator {
+            enum State : uint8_t {
+                /// 没有在执行字节码，其 FrameStack 中不包含需要枚举的栈帧
+                idle,
+                running,
+                /// 已暂停或者处于 Blocking 区域中
+                safe
+            };
+
+            FrameStack *stack{};
+            std::atomic<uint8_t> state{idle};
+            /// 嵌套的 Scope 数量，只由所属线程访问
+            uint32_t depth{};
+            /// 所属线程已经退出
+            std::atomic<bool> exited{};
+            /// 所属的 Safepoint 已经销毁
+            std::atomic<bool> orphaned{};
+        };
+
+        /// 获取当前线程的状态，首次访问时注册
+        Mutator *current();
+
+        /// 由 safe 或者 idle 切换为 running，收集正在进行时等待其结束
+        /// @param waiting 等待期间的状态
+        void resume(Mutator &mutator, Mutator::State waiting);
+
+        /// 用于区分先后创建于同一地址的 Safepoint
+        uint64_t id;
+        std::atomic<bool> pending{};
+        mutable std::mutex mutex;
+        std::condition_variable condition;
+        std::vector<std::shared_ptr<Mutator> > mutators;
+    };
+}
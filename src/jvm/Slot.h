@@ -0,0 +1,18 @@
+#pragma once
+
+#include <cstdint>
+
+namespace jvm {
+    /// 局部变量表与操作数栈的基本存储单元
+    /// @note long 与 double 按照 JVM 规范占用两个连续的 Slot，值保存在较低的 Slot 中，
+    /// 因此 max_stack 与 max_locals 可以直接作为 Slot 数量使用
+    union Slot {
+        int32_t i;
+        int64_t l;
+        float f;
+        double d;
+        void *ref;
+    };
+
+    static_assert(sizeof(Slot) == 8, "Slot must be 8 bytes");
+}
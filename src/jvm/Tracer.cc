@@ -0,0 +1,90 @@
+#include "Tracer.h"
+
+#include <cinttypes>
+#include <cstdio>
+
+jvm::RingBufferTracer::RingBufferTracer(size_t capacity) {
+    size_t size = 1;
+    while (size < capacity) size <<= 1;
+    entries = std::make_unique<Entry[]>(size);
+    mask = size - 1;
+}
+
+void jvm::RingBufferTracer::onEnter(const Frame &frame) {
+    TraceEvent event;
+    event.kind = TraceEvent::enter;
+    event.class_ = frame.class_;
+    event.method = frame.method;
+    event.value = frame.locals[0];
+    record(event);
+}
+
+void jvm::RingBufferTracer::onExit(const Frame &frame, uint16_t pc) {
+    TraceEvent event;
+    event.kind = TraceEvent::exit;
+    event.pc = pc;
+    event.class_ = frame.class_;
+    event.method = frame.method;
+    event.value = frame.locals[0];
+    record(event);
+}
+
+void jvm::RingBufferTracer::record(const TraceEvent &event) {
+    auto sequence = head.fetch_add(1, std::memory_order_relaxed);
+    auto &&entry = entries[sequence & mask];
+    // 先作废旧序号，读取方据此识别正在被覆盖的事件
+    entry.sequence.store(0, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    entry.event = event;
+    entry.sequence.store(sequence + 1, std::memory_order_release);
+}
+
+std::vector<jvm::TraceEvent> jvm::RingBufferTracer::snapshot() const {
+    std::vector<TraceEvent> events;
+    auto end = head.load(std::memory_order_acquire);
+    auto begin = end > mask + 1 ? end - (mask + 1) : 0;
+    events.reserve(end - begin);
+    for (auto sequence = begin; sequence < end; ++sequence) {
+        auto &&entry = entries[sequence & mask];
+        if (entry.sequence.load(std::memory_order_acquire) != sequence + 1) continue;
+        auto event = entry.event;
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (entry.sequence.load(std::memory_order_relaxed) != sequence + 1) continue;
+        events.push_back(event);
+    }
+    return events;
+}
+
+void jvm::RingBufferTracer::dump(sese::io::OutputStream *output) const {
+    char line[512];
+    for (auto &&event: snapshot()) {
+        auto class_name = event.class_->getThisName();
+        auto &&method = *event.method;
+        auto length = std::snprintf(line, sizeof(line), "%s %s.%.*s%.*s",
+                                    event.kind == TraceEvent::enter ? "enter" : "exit",
+                                    class_name.c_str(),
+                                    static_cast<int>(method.name.size()), method.name.data(),
+                                    static_cast<int>(method.descriptor.size()), method.descriptor.data());
+        if (length >= static_cast<int>(sizeof(line))) length = sizeof(line) - 1;
+        if (event.kind == TraceEvent::exit) {
+            auto remain = sizeof(line) - length;
+            auto &&type = method.return_type;
+            if (type.is_array || type.type == object) {
+                length += std::snprintf(line + length, remain, " pc=%d return=%p", event.pc, event.value.ref);
+            } else if (type.type == long_) {
+                length += std::snprintf(line + length, remain, " pc=%d return=%" PRId64, event.pc, event.value.l);
+            } else if (type.type == float_) {
+                length += std::snprintf(line + length, remain, " pc=%d return=%g", event.pc, event.value.f);
+            } else if (type.type == double_) {
+                length += std::snprintf(line + length, remain, " pc=%d return=%g", event.pc, event.value.d);
+            } else if (type.type == void_) {
+                length += std::snprintf(line + length, remain, " pc=%d", event.pc);
+            } else {
+                length += std::snprintf(line + length, remain, " pc=%d return=%d", event.pc, event.value.i);
+            }
+        }
+        if (length >= static_cast<int>(sizeof(line))) length = sizeof(line) - 1;
+        line[length++] = '\n';
+        output->write(line, length);
+    }
+}
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <jvm/Frame.h>
+
+#include <sese/io/OutputStream.h>
+
+#include <atomic>
+#include <vector>
+
+namespace jvm {
+    /// 方法进入与退出的监听接口
+    /// @note 未设置监听器时解释器仅多出一次空指针判断，回调在解释器线程中同步执行
+    class Tracer {
+    public:
+        virtual ~Tracer() = default;
+
+        /// 方法开始执行前调用
+        /// @param frame 新压入的栈帧，参数位于 frame.locals 起始处
+        virtual void onEnter(const Frame &frame) = 0;
+
+        /// 方法返回或者因未捕获的异常退出时调用
+        /// @param frame 即将弹出的栈帧，正常返回时返回值已写入 frame.locals 起始处
+        /// @param pc 返回指令或者抛出异常的指令的字节码位置
+        virtual void onExit(const Frame &frame, uint16_t pc) = 0;
+    };
+
+    /// 调用事件
+    struct TraceEvent {
+        enum Kind : uint8_t {
+            enter,
+            exit
+        };
+
+        Kind kind{};
+        /// 进入时为 0，退出时为返回指令的字节码位置
+        uint16_t pc{};
+        const Class *class_{};
+        const Class::MethodInfo *method{};
+        /// 进入时为第一个参数所在的 Slot，退出时为返回值，void 方法无意义
+        Slot value{};
+    };
+
+    /// 将最近的调用事件记录在定长环形缓冲区中的 Tracer，记录过程无锁且不分配内存
+    class RingBufferTracer final : public Tracer {
+    public:
+        /// @param capacity 缓冲区容量，向上取整为 2 的幂
+        explicit RingBufferTracer(size_t capacity);
+
+        void onEnter(const Frame &frame) override;
+
+        void onExit(const Frame &frame, uint16_t pc) override;
+
+        /// 按发生顺序获取缓冲区中仍然保留的事件，正在被覆盖的事件会被跳过
+        [[nodiscard]] std::vector<TraceEvent> snapshot() const;
+
+        /// 以文本形式输出缓冲区中的事件，每行一个
+        void dump(sese::io::OutputStream *output) const;
+
+    private:
+        struct Entry {
+            /// 写入完成后的事件序号加一，为 0 表示尚未写入
+            std::atomic<uint64_t> sequence{0};
+            TraceEvent event;
+        };
+
+        void record(const TraceEvent &event);
+
+        std::unique_ptr<Entry[]> entries;
+        size_t mask;
+        std::atomic<uint64_t> head{0};
+    };
+}
@@ -2,6 +2,7 @@
 
 #include <string>
 #include <cstdint>
+#include <vector>
 
 
 namespace jvm {
@@ -31,4 +32,27 @@ namespace jvm {
 
         [[nodiscard]] std::string toString() const;
     };
+
+    /// 类型推导中 Slot 的类型，long/double 的第二个 Slot 为 top
+    enum class VerificationType : uint8_t {
+        top,
+        int_,
+        float_,
+        long_,
+        double_,
+        /// 任意引用，包括 null 与尚未初始化的对象
+        reference
+    };
+
+    /// 方法中每条指令执行前局部变量表与操作数栈的类型
+    struct TypeMap {
+        /// 每条指令对应的类型数量，为 max_locals + max_stack
+        uint32_t width{};
+        /// 操作数栈深度，单位为 Slot，不可达的指令为 -1
+        std::vector<int32_t> depths;
+        /// 按指令下标连续存放，每条指令的前 max_locals 项为局部变量表，其后为操作数栈
+        std::vector<VerificationType> types;
+
+        [[nodiscard]] const VerificationType *at(size_t index) const { return types.data() + index * width; }
+    };
 }
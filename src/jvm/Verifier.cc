@@ -0,0 +1,869 @@
+#include "Verifier.h"
+#include "Object.h"
+#include "Opcode.h"
+
+#include <sese/util/Exception.h>
+
+#include <algorithm>
+
+namespace {
+    using namespace jvm;
+    using VT = VerificationType;
+
+    bool isWide(VT type) {
+        return type == VT::long_ || type == VT::double_;
+    }
+
+    /// 描述符首字符对应的类型，boolean/byte/char/short 按 int 处理，数组与对象均为引用
+    VT typeOf(char descriptor) {
+        switch (descriptor) {
+            case 'J':
+                return VT::long_;
+            case 'D':
+                return VT::double_;
+            case 'F':
+                return VT::float_;
+            case 'L':
+            case '[':
+                return VT::reference;
+            default:
+                return VT::int_;
+        }
+    }
+
+    /// 描述符是否为至少 dims 维的数组类型
+    bool isArrayOf(std::string_view descriptor, int32_t dims) {
+        if (descriptor.size() <= static_cast<size_t>(dims)) return false;
+        return std::all_of(descriptor.begin(), descriptor.begin() + dims, [](char c) { return c == '['; });
+    }
+
+    VT typeOf(const TypeInfo &type) {
+        if (type.is_array || type.type == object) return VT::reference;
+        return typeOf(static_cast<char>(type.type));
+    }
+
+    /// 单个方法的类型推导
+    class Inference {
+    public:
+        Inference(const Class &class_, const Class::MethodInfo &method, Class::CodeInfo &code_info)
+            : class_(class_), method(method), code_info(code_info), map(code_info.type_map),
+              max_locals(code_info.max_locals), max_stack(code_info.max_stack) {
+        }
+
+        void run() {
+            auto &&instructions = code_info.instructions;
+            auto count = instructions.size();
+            map.width = max_locals + max_stack;
+            map.depths.assign(count, -1);
+            map.types.assign(count * map.width, VT::top);
+            declared.assign(count, false);
+            reached.assign(count, false);
+
+            // 末尾的 end_of_code 与代码长度对应，作为异常表中 end_pc 的映射
+            index_of_pc.assign(code_info.code.size() + 1, -1);
+            for (size_t i = 0; i + 1 < count; ++i) {
+                index_of_pc[instructions[i].pc] = static_cast<int32_t>(i);
+            }
+            index_of_pc[code_info.code.size()] = static_cast<int32_t>(count - 1);
+
+            parseHandlers();
+            parseStackMap();
+
+            state.assign(map.width, VT::top);
+            depth = 0;
+            size_t slot = 0;
+            if (!method.isStatic()) {
+                setLocal(slot++, VT::reference);
+            }
+            for (auto &&arg: method.args_type) {
+                auto type = typeOf(arg);
+                setLocal(slot, type);
+                slot += isWide(type) ? 2 : 1;
+            }
+            flow(0);
+
+            while (!worklist.empty()) {
+                current = worklist.back();
+                worklist.pop_back();
+                auto &&insn = instructions[current];
+                pc = insn.pc;
+                auto types = &map.types[current * map.width];
+                state.assign(types, types + map.width);
+                depth = map.depths[current];
+                flowHandlers();
+                step(insn);
+                flowHandlers();
+            }
+
+            // 未被执行到的 StackMapTable 帧不视为可达
+            for (size_t i = 0; i < count; ++i) {
+                if (!reached[i]) map.depths[i] = -1;
+            }
+        }
+
+    private:
+        struct Handler {
+            size_t from;
+            size_t to;
+            size_t target;
+        };
+
+        [[noreturn]] void fail(const std::string &reason) const {
+            throw sese::Exception("java/lang/VerifyError: " + class_.getThisName() + "." +
+                                  std::string(method.name) + std::string(method.descriptor) +
+                                  " pc " + std::to_string(pc) + ": " + reason);
+        }
+
+        size_t indexOf(int64_t target_pc) const {
+            if (target_pc < 0 || target_pc >= static_cast<int64_t>(index_of_pc.size()) ||
+                index_of_pc[target_pc] < 0) {
+                fail("illegal branch target");
+            }
+            return static_cast<size_t>(index_of_pc[target_pc]);
+        }
+
+        void parseHandlers() {
+            for (auto &&info: code_info.exception_infos) {
+                Handler handler{indexOf(info.from), indexOf(info.to), indexOf(info.target)};
+                if (handler.from >= handler.to || handler.target + 1 >= code_info.instructions.size()) {
+                    fail("illegal exception table");
+                }
+                handlers.push_back(handler);
+            }
+        }
+
+        static void readType(ByteReader &reader, std::vector<VT> &types) {
+            auto tag = reader.u1();
+            switch (tag) {
+                case 0:
+                    types.push_back(VT::top);
+                    break;
+                case 1:
+                    types.push_back(VT::int_);
+                    break;
+                case 2:
+                    types.push_back(VT::float_);
+                    break;
+                case 3:
+                    types.push_back(VT::double_);
+                    types.push_back(VT::top);
+                    break;
+                case 4:
+                    types.push_back(VT::long_);
+                    types.push_back(VT::top);
+                    break;
+                case 5:
+                case 6:
+                    types.push_back(VT::reference);
+                    break;
+                case 7:
+                case 8:
+                    // Object 与 Uninitialized 的类名以及 new 指令位置不参与推导
+                    reader.u2();
+                    types.push_back(VT::reference);
+                    break;
+                default:
+                    throw sese::Exception("java/lang/VerifyError: illegal stack map verification type");
+            }
+        }
+
+        /// 去掉最后 count 个局部变量，long/double 算作一个
+        static void chop(std::vector<VT> &locals, size_t count) {
+            for (size_t i = 0; i < count && !locals.empty(); ++i) {
+                auto wide = locals.size() >= 2 && locals.back() == VT::top && isWide(locals[locals.size() - 2]);
+                locals.resize(locals.size() - (wide ? 2 : 1));
+            }
+        }
+
+        /// 将 StackMapTable 中的帧写入对应指令处的类型，推导时作为该处的已知类型
+        void parseStackMap() {
+            for (auto &&attribute: code_info.attribute_infos) {
+                if (attribute.name != "StackMapTable") continue;
+                ByteReader reader(reinterpret_cast<const uint8_t *>(attribute.info.data()), attribute.info.size());
+                std::vector<VT> locals;
+                if (!method.isStatic()) locals.push_back(VT::reference);
+                for (auto &&arg: method.args_type) {
+                    auto type = typeOf(arg);
+                    locals.push_back(type);
+                    if (isWide(type)) locals.push_back(VT::top);
+                }
+                int64_t offset = -1;
+                auto frames = reader.u2();
+                for (uint16_t k = 0; k < frames; ++k) {
+                    auto frame_type = reader.u1();
+                    std::vector<VT> stack;
+                    uint16_t delta;
+                    if (frame_type < 64) {
+                        delta = frame_type;
+                    } else if (frame_type < 128) {
+                        delta = frame_type - 64;
+                        readType(reader, stack);
+                    } else if (frame_type < 247) {
+                        fail("reserved stack map frame type");
+                    } else if (frame_type == 247) {
+                        delta = reader.u2();
+                        readType(reader, stack);
+                    } else if (frame_type < 251) {
+                        delta = reader.u2();
+                        chop(locals, 251 - frame_type);
+                    } else if (frame_type == 251) {
+                        delta = reader.u2();
+                    } else if (frame_type < 255) {
+                        delta = reader.u2();
+                        for (int j = 0; j < frame_type - 251; ++j) readType(reader, locals);
+                    } else {
+                        delta = reader.u2();
+                        locals.clear();
+                        auto locals_count = reader.u2();
+                        for (uint16_t j = 0; j < locals_count; ++j) readType(reader, locals);
+                        auto stack_count = reader.u2();
+                        for (uint16_t j = 0; j < stack_count; ++j) readType(reader, stack);
+                    }
+                    offset += delta + 1;
+                    pc = static_cast<uint16_t>(offset);
+                    auto index = indexOf(offset);
+                    if (index + 1 >= code_info.instructions.size()) fail("illegal stack map frame offset");
+                    if (locals.size() > max_locals || stack.size() > max_stack) {
+                        fail("stack map frame exceeds max_locals or max_stack");
+                    }
+                    auto types = &map.types[index * map.width];
+                    std::copy(locals.begin(), locals.end(), types);
+                    std::copy(stack.begin(), stack.end(), types + max_locals);
+                    map.depths[index] = static_cast<int32_t>(stack.size());
+                    declared[index] = true;
+                }
+                pc = 0;
+            }
+        }
+
+        /// 当前状态流向 target 指令
+        void flow(size_t target) {
+            if (target + 1 >= code_info.instructions.size()) fail("execution falls off the end of the code");
+            auto types = &map.types[target * map.width];
+            auto &&target_depth = map.depths[target];
+            if (declared[target]) {
+                // 声明的帧中局部变量为 top 时接受任意类型，其余必须一致
+                if (target_depth != depth) fail("stack map frame mismatch");
+                for (size_t i = 0; i < max_locals + static_cast<size_t>(depth); ++i) {
+                    if (types[i] != state[i] && (i >= max_locals || types[i] != VT::top)) {
+                        fail("stack map frame mismatch");
+                    }
+                }
+                if (!reached[target]) {
+                    reached[target] = true;
+                    worklist.push_back(target);
+                }
+                return;
+            }
+            if (!reached[target]) {
+                std::copy(state.begin(), state.end(), types);
+                target_depth = depth;
+                reached[target] = true;
+                worklist.push_back(target);
+                return;
+            }
+            if (target_depth != depth) fail("inconsistent operand stack depth");
+            for (size_t i = max_locals; i < max_locals + static_cast<size_t>(depth); ++i) {
+                if (types[i] != state[i]) fail("inconsistent operand stack");
+            }
+            auto changed = false;
+            for (size_t i = 0; i < max_locals; ++i) {
+                if (types[i] != state[i] && types[i] != VT::top) {
+                    types[i] = VT::top;
+                    changed = true;
+                }
+            }
+            if (changed) worklist.push_back(target);
+        }
+
+        /// 异常处理器入口处的局部变量与当前一致，操作数栈仅有异常对象
+        void flowHandlers() {
+            if (handlers.empty()) return;
+            auto saved_state = state;
+            auto saved_depth = depth;
+            for (auto &&handler: handlers) {
+                if (current < handler.from || current >= handler.to) continue;
+                if (max_stack < 1) fail("exception handler needs operand stack");
+                std::fill(state.begin() + max_locals, state.end(), VT::top);
+                state[max_locals] = VT::reference;
+                depth = 1;
+                flow(handler.target);
+            }
+            state = std::move(saved_state);
+            depth = saved_depth;
+        }
+
+        VT *stack() {
+            return state.data() + max_locals;
+        }
+
+        void push(VT type) {
+            if (static_cast<size_t>(depth) + (isWide(type) ? 2 : 1) > max_stack) fail("operand stack overflow");
+            stack()[depth++] = type;
+            if (isWide(type)) stack()[depth++] = VT::top;
+        }
+
+        void pop(VT type) {
+            if (isWide(type)) {
+                if (depth < 2 || stack()[depth - 2] != type || stack()[depth - 1] != VT::top) {
+                    fail("operand stack type mismatch");
+                }
+                depth -= 2;
+            } else {
+                if (depth < 1 || stack()[depth - 1] != type) fail("operand stack type mismatch");
+                depth -= 1;
+            }
+        }
+
+        /// 栈操作指令只能在完整的值之间切分，position 处不能是 long/double 的第二个 Slot
+        void boundary(int32_t position) {
+            if (position < 0) fail("operand stack underflow");
+            if (position < depth && stack()[position] == VT::top) fail("operand splits a long or double");
+        }
+
+        /// 复制栈顶 size 个 Slot 并插入到其下方 skip 个 Slot 之下
+        void dup(int32_t size, int32_t skip) {
+            boundary(depth - size);
+            boundary(depth - size - skip);
+            if (static_cast<size_t>(depth + size) > max_stack) fail("operand stack overflow");
+            auto top = stack() + depth;
+            for (int32_t i = 0; i < size; ++i) top[i] = top[i - size];
+            for (int32_t i = -1; i >= -skip; --i) top[i] = top[i - size];
+            for (int32_t i = 0; i < size; ++i) top[i - skip - size] = top[i];
+            depth += size;
+        }
+
+        void setLocal(size_t index, VT type) {
+            if (index + (isWide(type) ? 2 : 1) > max_locals) fail("local variable index out of range");
+            // 覆盖 long/double 的第二个 Slot 后原来的值不再可用
+            if (index > 0 && isWide(state[index - 1])) state[index - 1] = VT::top;
+            state[index] = type;
+            if (isWide(type)) state[index + 1] = VT::top;
+        }
+
+        void load(int32_t index, VT type) {
+            auto wide = isWide(type);
+            if (index < 0 || static_cast<size_t>(index) + (wide ? 2 : 1) > max_locals) {
+                fail("local variable index out of range");
+            }
+            if (state[index] != type || (wide && state[index + 1] != VT::top)) fail("local variable type mismatch");
+            push(type);
+        }
+
+        void store(int32_t index, VT type) {
+            pop(type);
+            if (index < 0) fail("local variable index out of range");
+            setLocal(static_cast<size_t>(index), type);
+        }
+
+        void binary(VT type) {
+            pop(type);
+            pop(type);
+            push(type);
+        }
+
+        void convert(VT from, VT to) {
+            pop(from);
+            push(to);
+        }
+
+        void returns(VT type) {
+            auto &&return_type = method.return_type;
+            if (return_type.is_array == 0 && return_type.type == void_) fail("return value from void method");
+            if (typeOf(return_type) != type) fail("return type mismatch");
+            pop(type);
+        }
+
+        /// 按照方法描述符弹出参数并压入返回值
+        void invoke(std::string_view descriptor, bool receiver) {
+            std::vector<VT> args;
+            size_t i = 1;
+            if (descriptor.empty() || descriptor[0] != '(') fail("malformed method descriptor");
+            while (i < descriptor.size() && descriptor[i] != ')') {
+                args.push_back(typeOf(descriptor[i]));
+                while (i < descriptor.size() && descriptor[i] == '[') ++i;
+                if (i < descriptor.size() && descriptor[i] == 'L') i = descriptor.find(';', i);
+                if (i == std::string_view::npos || i >= descriptor.size()) fail("malformed method descriptor");
+                ++i;
+            }
+            if (i + 1 >= descriptor.size()) fail("malformed method descriptor");
+            for (auto iter = args.rbegin(); iter != args.rend(); ++iter) pop(*iter);
+            if (receiver) pop(VT::reference);
+            if (descriptor[i + 1] != 'V') push(typeOf(descriptor[i + 1]));
+        }
+
+        void branch(int32_t target) {
+            flow(static_cast<size_t>(target));
+        }
+
+        /// tableswitch 与 lookupswitch 的跳转目标来自预解码得到的跳转表
+        void switchTargets(const Instruction &insn) {
+            branch(insn.a);
+            auto table = code_info.switch_tables.data() + insn.c;
+            auto targets = table + 1 + (insn.opcode == lookupswitch ? table[0] : 0);
+            for (int32_t k = 0; k < table[0]; ++k) branch(targets[k]);
+        }
+
+        void step(const Instruction &insn) {
+            auto terminal = false;
+            switch (insn.opcode) {
+                case nop:
+                    break;
+                case aconst_null:
+                    push(VT::reference);
+                    break;
+                case iconst_m1:
+                case iconst_0:
+                case iconst_1:
+                case iconst_2:
+                case iconst_3:
+                case iconst_4:
+                case iconst_5:
+                case bipush:
+                case sipush:
+                    push(VT::int_);
+                    break;
+                case lconst_0:
+                case lconst_1:
+                    push(VT::long_);
+                    break;
+                case fconst_0:
+                case fconst_1:
+                case fconst_2:
+                    push(VT::float_);
+                    break;
+                case dconst_0:
+                case dconst_1:
+                    push(VT::double_);
+                    break;
+                case ldc:
+                case ldc_w: {
+                    auto tag = class_.getConstant(insn.a).tag;
+                    if (tag == Class::integer_info) push(VT::int_);
+                    else if (tag == Class::float_info) push(VT::float_);
+                    else if (tag == Class::string_info || tag == Class::class_info ||
+                             tag == Class::method_handle_info || tag == Class::method_type_info) {
+                        push(VT::reference);
+                    } else fail("illegal ldc constant");
+                    break;
+                }
+                case ldc2_w: {
+                    auto tag = class_.getConstant(insn.a).tag;
+                    if (tag == Class::long_info) push(VT::long_);
+                    else if (tag == Class::double_info) push(VT::double_);
+                    else fail("illegal ldc2_w constant");
+                    break;
+                }
+                case iload:
+                case iload_0:
+                case iload_1:
+                case iload_2:
+                case iload_3:
+                    load(insn.a, VT::int_);
+                    break;
+                case lload:
+                case lload_0:
+                case lload_1:
+                case lload_2:
+                case lload_3:
+                    load(insn.a, VT::long_);
+                    break;
+                case fload:
+                case fload_0:
+                case fload_1:
+                case fload_2:
+                case fload_3:
+                    load(insn.a, VT::float_);
+                    break;
+                case dload:
+                case dload_0:
+                case dload_1:
+                case dload_2:
+                case dload_3:
+                    load(insn.a, VT::double_);
+                    break;
+                case aload:
+                case aload_0:
+                case aload_1:
+                case aload_2:
+                case aload_3:
+                    load(insn.a, VT::reference);
+                    break;
+                case iaload:
+                case baload:
+                case caload:
+                case saload:
+                case laload:
+                case faload:
+                case daload:
+                case aaload: {
+                    static const VT elements[] = {
+                        VT::int_, VT::long_, VT::float_, VT::double_, VT::reference, VT::int_, VT::int_, VT::int_
+                    };
+                    pop(VT::int_);
+                    pop(VT::reference);
+                    push(elements[insn.opcode - iaload]);
+                    break;
+                }
+                case istore:
+                case istore_0:
+                case istore_1:
+                case istore_2:
+                case istore_3:
+                    store(insn.a, VT::int_);
+                    break;
+                case lstore:
+                case lstore_0:
+                case lstore_1:
+                case lstore_2:
+                case lstore_3:
+                    store(insn.a, VT::long_);
+                    break;
+                case fstore:
+                case fstore_0:
+                case fstore_1:
+                case fstore_2:
+                case fstore_3:
+                    store(insn.a, VT::float_);
+                    break;
+                case dstore:
+                case dstore_0:
+                case dstore_1:
+                case dstore_2:
+                case dstore_3:
+                    store(insn.a, VT::double_);
+                    break;
+                case astore:
+                case astore_0:
+                case astore_1:
+                case astore_2:
+                case astore_3:
+                    store(insn.a, VT::reference);
+                    break;
+                case iastore:
+                case lastore:
+                case fastore:
+                case dastore:
+                case aastore:
+                case bastore:
+                case castore:
+                case sastore: {
+                    static const VT elements[] = {
+                        VT::int_, VT::long_, VT::float_, VT::double_, VT::reference, VT::int_, VT::int_, VT::int_
+                    };
+                    pop(elements[insn.opcode - iastore]);
+                    pop(VT::int_);
+                    pop(VT::reference);
+                    break;
+                }
+                case jvm::pop:
+                    boundary(depth - 1);
+                    depth -= 1;
+                    break;
+                case pop2:
+                    boundary(depth - 2);
+                    depth -= 2;
+                    break;
+                case jvm::dup:
+                    dup(1, 0);
+                    break;
+                case dup_x1:
+                    dup(1, 1);
+                    break;
+                case dup_x2:
+                    dup(1, 2);
+                    break;
+                case dup2:
+                    dup(2, 0);
+                    break;
+                case dup2_x1:
+                    dup(2, 1);
+                    break;
+                case dup2_x2:
+                    dup(2, 2);
+                    break;
+                case swap:
+                    boundary(depth - 1);
+                    boundary(depth - 2);
+                    std::swap(stack()[depth - 1], stack()[depth - 2]);
+                    break;
+                case iadd:
+                case isub:
+                case imul:
+                case idiv:
+                case irem:
+                case iand:
+                case ior:
+                case ixor:
+                    binary(VT::int_);
+                    break;
+                case ladd:
+                case lsub:
+                case lmul:
+                case jvm::ldiv:
+                case lrem:
+                case land:
+                case lor:
+                case lxor:
+                    binary(VT::long_);
+                    break;
+                case fadd:
+                case fsub:
+                case fmul:
+                case fdiv:
+                case frem:
+                    binary(VT::float_);
+                    break;
+                case dadd:
+                case dsub:
+                case dmul:
+                case ddiv:
+                case drem:
+                    binary(VT::double_);
+                    break;
+                case ineg:
+                    convert(VT::int_, VT::int_);
+                    break;
+                case lneg:
+                    convert(VT::long_, VT::long_);
+                    break;
+                case fneg:
+                    convert(VT::float_, VT::float_);
+                    break;
+                case dneg:
+                    convert(VT::double_, VT::double_);
+                    break;
+                case ishl:
+                case ishr:
+                case iushr:
+                    binary(VT::int_);
+                    break;
+                case lshl:
+                case lshr:
+                case lushr:
+                    pop(VT::int_);
+                    convert(VT::long_, VT::long_);
+                    break;
+                case iinc:
+                    load(insn.a, VT::int_);
+                    depth -= 1;
+                    break;
+                case i2l:
+                    convert(VT::int_, VT::long_);
+                    break;
+                case i2f:
+                    convert(VT::int_, VT::float_);
+                    break;
+                case i2d:
+                    convert(VT::int_, VT::double_);
+                    break;
+                case l2i:
+                    convert(VT::long_, VT::int_);
+                    break;
+                case l2f:
+                    convert(VT::long_, VT::float_);
+                    break;
+                case l2d:
+                    convert(VT::long_, VT::double_);
+                    break;
+                case f2i:
+                    convert(VT::float_, VT::int_);
+                    break;
+                case f2l:
+                    convert(VT::float_, VT::long_);
+                    break;
+                case f2d:
+                    convert(VT::float_, VT::double_);
+                    break;
+                case d2i:
+                    convert(VT::double_, VT::int_);
+                    break;
+                case d2l:
+                    convert(VT::double_, VT::long_);
+                    break;
+                case d2f:
+                    convert(VT::double_, VT::float_);
+                    break;
+                case i2b:
+                case i2c:
+                case i2s:
+                    convert(VT::int_, VT::int_);
+                    break;
+                case lcmp:
+                    pop(VT::long_);
+                    convert(VT::long_, VT::int_);
+                    break;
+                case fcmpl:
+                case fcmpg:
+                    pop(VT::float_);
+                    convert(VT::float_, VT::int_);
+                    break;
+                case dcmpl:
+                case dcmpg:
+                    pop(VT::double_);
+                    convert(VT::double_, VT::int_);
+                    break;
+                case ifeq:
+                case ifne:
+                case iflt:
+                case ifge:
+                case ifgt:
+                case ifle:
+                    pop(VT::int_);
+                    branch(insn.a);
+                    break;
+                case if_icmpeq:
+                case if_icmpne:
+                case if_icmplt:
+                case if_icmpge:
+                case if_icmpgt:
+                case if_icmple:
+                    pop(VT::int_);
+                    pop(VT::int_);
+                    branch(insn.a);
+                    break;
+                case if_acmpeq:
+                case if_acmpne:
+                    pop(VT::reference);
+                    pop(VT::reference);
+                    branch(insn.a);
+                    break;
+                case ifnull:
+                case ifnonnull:
+                    pop(VT::reference);
+                    branch(insn.a);
+                    break;
+                case goto_:
+                    branch(insn.a);
+                    terminal = true;
+                    break;
+                case jsr:
+                case ret:
+                    fail("jsr/ret are not supported");
+                case tableswitch:
+                case lookupswitch:
+                    pop(VT::int_);
+                    switchTargets(insn);
+                    terminal = true;
+                    break;
+                case ireturn:
+                    returns(VT::int_);
+                    terminal = true;
+                    break;
+                case lreturn:
+                    returns(VT::long_);
+                    terminal = true;
+                    break;
+                case freturn:
+                    returns(VT::float_);
+                    terminal = true;
+                    break;
+                case dreturn:
+                    returns(VT::double_);
+                    terminal = true;
+                    break;
+                case areturn:
+                    returns(VT::reference);
+                    terminal = true;
+                    break;
+                case return_:
+                    if (method.return_type.is_array || method.return_type.type != void_) {
+                        fail("missing return value");
+                    }
+                    terminal = true;
+                    break;
+                case getstatic:
+                    push(typeOf(class_.getMemberRef(insn.a).descriptor.at(0)));
+                    break;
+                case putstatic:
+                    pop(typeOf(class_.getMemberRef(insn.a).descriptor.at(0)));
+                    break;
+                case getfield:
+                    pop(VT::reference);
+                    push(typeOf(class_.getMemberRef(insn.a).descriptor.at(0)));
+                    break;
+                case putfield:
+                    pop(typeOf(class_.getMemberRef(insn.a).descriptor.at(0)));
+                    pop(VT::reference);
+                    break;
+                case invokevirtual:
+                case invokespecial:
+                case invokeinterface:
+                    invoke(class_.getMemberRef(insn.a).descriptor, true);
+                    break;
+                case invokestatic:
+                    invoke(class_.getMemberRef(insn.a).descriptor, false);
+                    break;
+                case invokedynamic: {
+                    auto &&call_site = class_.getConstant(insn.a, Class::invoke_dynamic_info);
+                    auto &&name_and_type = class_.getConstant(call_site.index2, Class::name_and_type_info);
+                    invoke(class_.getUtf8(name_and_type.index2), false);
+                    break;
+                }
+                case new_:
+                    push(VT::reference);
+                    break;
+                case newarray:
+                    if (insn.a < Array::t_boolean || insn.a > Array::t_long) fail("illegal newarray type");
+                    convert(VT::int_, VT::reference);
+                    break;
+                case anewarray:
+                    convert(VT::int_, VT::reference);
+                    break;
+                case arraylength:
+                    convert(VT::reference, VT::int_);
+                    break;
+                case athrow:
+                    pop(VT::reference);
+                    terminal = true;
+                    break;
+                case checkcast:
+                    convert(VT::reference, VT::reference);
+                    break;
+                case instanceof:
+                    convert(VT::reference, VT::int_);
+                    break;
+                case monitorenter:
+                case monitorexit:
+                    pop(VT::reference);
+                    break;
+                case multianewarray:
+                    if (insn.b < 1 || !isArrayOf(class_.getClassName(insn.a), insn.b)) {
+                        fail("illegal multianewarray dimensions");
+                    }
+                    for (int32_t i = 0; i < insn.b; ++i) pop(VT::int_);
+                    push(VT::reference);
+                    break;
+                case end_of_code:
+                    fail("execution falls off the end of the code");
+                default:
+                    fail("illegal opcode " + std::to_string(insn.opcode));
+            }
+            if (!terminal) {
+                flow(current + 1);
+            }
+        }
+
+        const Class &class_;
+        const Class::MethodInfo &method;
+        Class::CodeInfo &code_info;
+        TypeMap &map;
+        size_t max_locals;
+        size_t max_stack;
+        std::vector<int32_t> index_of_pc;
+        std::vector<Handler> handlers;
+        /// 存在 StackMapTable 声明的帧
+        std::vector<bool> declared;
+        std::vector<bool> reached;
+        std::vector<size_t> worklist;
+        /// 正在处理的指令及其执行过程中的类型
+        size_t current{};
+        uint16_t pc{};
+        std::vector<VT> state;
+        int32_t depth{};
+    };
+}
+
+void jvm::Verifier::verify(const Class &class_, const Class::MethodInfo &method, Class::CodeInfo &code_info) {
+    Inference(class_, method, code_info).run();
+}
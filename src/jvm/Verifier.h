@@ -0,0 +1,18 @@
+#pragma once
+
+#include <jvm/Class.h>
+
+namespace jvm {
+    /// 链接阶段的类型推导，对方法字节码做抽象解释，得到每条指令执行前局部变量表与操作数栈中每个 Slot 的类型
+    /// @note 引用类型不区分具体的类，仅用于区分 Slot 的类别；推导通过后解释器与 JIT 可以直接按照指令隐含的类型
+    /// 读写 Slot，long/double 固定占用两个 Slot，栈操作指令也无需在运行时判断操作数的类别
+    class Verifier {
+    public:
+        /// 推导方法的类型并写入 code_info.type_map，需要在预解码之后、超级指令融合之前调用
+        /// @note 存在 StackMapTable 时以其声明的帧作为跳转目标处的类型，每条指令只需处理一次；
+        /// 否则在跳转目标处合并类型并迭代至不动点
+        /// @exception sese::Exception 类型不匹配、操作数栈越界、执行越过代码末尾或者使用了 jsr/ret 时抛出
+        /// java/lang/VerifyError
+        static void verify(const Class &class_, const Class::MethodInfo &method, Class::CodeInfo &code_info);
+    };
+}
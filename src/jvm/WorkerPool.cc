@@ -0,0 +1,50 @@
+#include "WorkerPool.h"
+
+jvm::WorkerPool::~WorkerPool() {
+    {
+        std::lock_guard<std::mutex> guard(mutex);
+        stopping = true;
+    }
+    wake.notify_all();
+    for (auto &&thread: threads) {
+        thread.join();
+    }
+}
+
+void jvm::WorkerPool::start(size_t count, const std::function<void(size_t)> &task) {
+    std::unique_lock<std::mutex> lock(mutex);
+    done.wait(lock, [this] { return !busy; });
+    busy = true;
+    while (threads.size() < count) {
+        threads.emplace_back(&WorkerPool::work, this, threads.size() + 1);
+    }
+    this->task = &task;
+    active = count;
+    pending = count;
+    ++generation;
+    wake.notify_all();
+}
+
+void jvm::WorkerPool::wait() {
+    std::unique_lock<std::mutex> lock(mutex);
+    done.wait(lock, [this] { return pending == 0; });
+    busy = false;
+    task = nullptr;
+    // 唤醒在 start 中等待的其他调用者
+    done.notify_all();
+}
+
+void jvm::WorkerPool::work(size_t index) {
+    uint64_t seen = 0;
+    std::unique_lock<std::mutex> lock(mutex);
+    for (;;) {
+        wake.wait(lock, [&] { return stopping || (generation != seen && index <= active); });
+        if (stopping) return;
+        seen = generation;
+        auto &&current = *task;
+        lock.unlock();
+        current(index);
+        lock.lock();
+        if (--pending == 0) done.notify_all();
+    }
+}
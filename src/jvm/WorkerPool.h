@@ -0,0 +1,51 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace jvm {
+    /// 常驻的工作线程，供 Runtime::invokeBatch 在多次批量调用之间复用，
+    /// 避免每批都创建线程并重新分配线程私有的 FrameStack
+    /// @note 线程在首次需要时创建，数量只增不减，析构时结束；同一时刻只执行一个任务，
+    /// 其他调用者在 start 中等待当前任务完成
+    class WorkerPool {
+    public:
+        WorkerPool() = default;
+
+        ~WorkerPool();
+
+        WorkerPool(const WorkerPool &) = delete;
+
+        WorkerPool &operator=(const WorkerPool &) = delete;
+
+        /// 由 count 个工作线程分别执行 task(1) 至 task(count)，调用者随后可以自行执行 task(0)
+        /// @param task 需要在 wait 返回前保持有效，不能抛出异常
+        void start(size_t count, const std::function<void(size_t)> &task);
+
+        /// 等待 start 分派的任务全部完成
+        void wait();
+
+    private:
+        void work(size_t index);
+
+        std::mutex mutex;
+        /// 通知工作线程开始新的任务或者退出
+        std::condition_variable wake;
+        /// 通知任务完成或者工作线程空闲
+        std::condition_variable done;
+        std::vector<std::thread> threads;
+        const std::function<void(size_t)> *task{};
+        /// 任务编号，工作线程据此区分新的任务
+        uint64_t generation{};
+        /// 参与当前任务的工作线程数量，编号不超过此值的线程参与
+        size_t active{};
+        /// 尚未完成的工作线程数量
+        size_t pending{};
+        bool busy{};
+        bool stopping{};
+    };
+}
@@ -5,6 +5,10 @@
 #include <jvm/ClassLoader.h>
 #include <jvm/Runtime.h>
 #include <sese/util/Exception.h>
+#include <sese/io/File.h>
+#include <sese/io/ByteBuilder.h>
+
+#include <charconv>
 
 int main(int argc, char **argv) {
     sese::initCore(argc, argv);
@@ -18,22 +22,107 @@ int main(int argc, char **argv) {
     }
 
     auto mode = args.getValueByKey("--mode", "run");
-    if (mode != "run" && mode != "print") {
-        SESE_ERROR("require --mode=(run|print)");
+    if (mode != "run" && mode != "print" && mode != "stats") {
+        SESE_ERROR("require --mode=(run|print|stats)");
         return -1;
     }
     SESE_INFO("mode: %s", mode.c_str());
 
+    auto trace_path = args.getValueByKey("--trace", "");
+    std::unique_ptr<jvm::RingBufferTracer> tracer;
+    if (!trace_path.empty()) {
+        tracer = std::make_unique<jvm::RingBufferTracer>(65536);
+    }
+
+    auto pairs_path = args.getValueByKey("--opcode-pairs", "");
+    std::unique_ptr<jvm::OpcodeProfile> profile;
+    auto stats_path = args.getValueByKey("--stats", "stats.json");
+    if (!pairs_path.empty() || mode == "stats") {
+        profile = std::make_unique<jvm::OpcodeProfile>();
+    }
+
+    auto profiler_path = args.getValueByKey("--profile", "");
+    std::unique_ptr<jvm::Profiler> profiler;
+    if (!profiler_path.empty()) {
+        profiler = std::make_unique<jvm::Profiler>();
+    }
+    auto top = args.getValueByKey("--profile-top", "10");
+    size_t profiler_top = 0;
+    auto [end, error] = std::from_chars(top.data(), top.data() + top.size(), profiler_top);
+    if (error != std::errc() || end != top.data() + top.size() || profiler_top == 0) {
+        SESE_ERROR("require --profile-top=<positive integer>");
+        return -1;
+    }
+
+    auto fusion = args.getValueByKey("--fusion", "on");
+    if (fusion != "on" && fusion != "off") {
+        SESE_ERROR("require --fusion=(on|off)");
+        return -1;
+    }
+
+    auto jit = args.getValueByKey("--jit", "off");
+    if (jit != "on" && jit != "off") {
+        SESE_ERROR("require --jit=(on|off)");
+        return -1;
+    }
+
     try {
         auto cl = jvm::ClassLoader::loadFromFile(class_path);
-        if (mode == "run") {
+        if (mode == "run" || mode == "stats") {
             jvm::Runtime runtime;
+            // 统计原始字节码，融合后的超级指令以及编译后的代码均会影响计数
+            runtime.setFusion(fusion == "on" && mode == "run");
+            runtime.setJit(jit == "on" && mode == "run");
             runtime.regClass(cl);
             if (!runtime.hasMain()) {
                 SESE_ERROR("cannot found main method in class %s", cl->getThisName().c_str());
                 return -1;
             }
-            runtime.run();
+            runtime.setTracer(tracer.get());
+            runtime.setOpcodeProfile(profile.get());
+            runtime.setProfiler(profiler.get());
+            try {
+                runtime.run();
+            } catch (sese::Exception &e) {
+                e.printStacktrace();
+            }
+            if (tracer) {
+                auto file = sese::io::File::create(trace_path, sese::io::File::B_WRITE_TRUNC);
+                if (!file) {
+                    SESE_ERROR("failed open trace file %s", trace_path.c_str());
+                    return -1;
+                }
+                tracer->dump(file.get());
+            }
+            if (!pairs_path.empty()) {
+                auto file = sese::io::File::create(pairs_path, sese::io::File::B_WRITE_TRUNC);
+                if (!file) {
+                    SESE_ERROR("failed open opcode pairs file %s", pairs_path.c_str());
+                    return -1;
+                }
+                profile->dump(file.get(), 64);
+            }
+            if (mode == "stats") {
+                auto file = sese::io::File::create(stats_path, sese::io::File::B_WRITE_TRUNC);
+                if (!file) {
+                    SESE_ERROR("failed open stats file %s", stats_path.c_str());
+                    return -1;
+                }
+                profile->dumpJson(file.get(), 32);
+            }
+            if (profiler) {
+                auto file = sese::io::File::create(profiler_path, sese::io::File::B_WRITE_TRUNC);
+                if (!file) {
+                    SESE_ERROR("failed open profile file %s", profiler_path.c_str());
+                    return -1;
+                }
+                profiler->dumpFolded(file.get());
+                sese::io::ByteBuilder top;
+                profiler->dumpTop(&top, profiler_top);
+                std::string table(top.getReadableSize(), '\0');
+                top.read(table.data(), table.size());
+                SESE_INFO("profile:\n%s", table.c_str());
+            }
         } else if (mode == "print") {
             cl->printMethods();
             cl->printFields();
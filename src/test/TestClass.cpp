@@ -3,6 +3,8 @@
 #include <sese/Log.h>
 #include <sese/util/Exception.h>
 
+#include <fstream>
+
 TEST(TestClass, Parse) {
     try {
         auto cl = jvm::ClassLoader::loadFromFile(PATH_TO_HELLO_CLASS);
@@ -20,3 +22,18 @@ TEST(TestClass, Getter) {
     cl->printFields();
     cl->printAttributes();
 }
+
+TEST(TestClass, ConstantPool) {
+    auto cl = jvm::ClassLoader::loadFromFile(PATH_TO_HELLO_CLASS);
+    EXPECT_THROW((void) cl->getUtf8(0), sese::Exception);
+    EXPECT_THROW((void) cl->getConstant(UINT16_MAX, jvm::Class::utf8_info), sese::Exception);
+    EXPECT_THROW((void) cl->getMemberRef(0), sese::Exception);
+}
+
+TEST(TestClass, LoadFromMemory) {
+    std::ifstream input(PATH_TO_HELLO_CLASS, std::ios::binary);
+    std::vector<uint8_t> bytes(std::istreambuf_iterator<char>(input), {});
+    auto cl = jvm::ClassLoader::loadFromMemory(bytes.data(), bytes.size());
+    EXPECT_EQ(cl->getThisName(), "Hello");
+    EXPECT_THROW(jvm::ClassLoader::loadFromMemory(bytes.data(), bytes.size() / 2), sese::Exception);
+}
@@ -1,9 +1,15 @@
 #include <gtest/gtest.h>
 #include <jvm/Runtime.h>
 #include <jvm/ClassLoader.h>
+#include <jvm/Jit.h>
 #include <sese/Log.h>
+#include <sese/io/ByteBuilder.h>
 #include <sese/util/Exception.h>
 
+#include <algorithm>
+#include <atomic>
+#include <thread>
+
 
 TEST(TestRuntime, FindMain) {
     auto class_ = jvm::ClassLoader::loadFromFile(PATH_TO_WORLD_CLASS);
@@ -44,3 +50,572 @@ TEST(TestRuntime, Run_PiCalculator) {
         ex.printStacktrace();
     }
 }
+
+TEST(TestRuntime, Run_Recursion) {
+    auto class_ = jvm::ClassLoader::loadFromFile(PATH_TO_RECURSION_CLASS);
+    auto runtime = jvm::Runtime();
+    runtime.regClass(class_);
+    // 递归深度远超本机栈所能承受的 C++ 递归深度
+    EXPECT_NO_THROW(runtime.run());
+}
+
+TEST(TestRuntime, Trace) {
+    auto class_ = jvm::ClassLoader::loadFromFile(PATH_TO_PRIME_CALCULATOR_CLASS);
+    auto runtime = jvm::Runtime();
+    runtime.regClass(class_);
+    jvm::RingBufferTracer tracer(16);
+    runtime.setTracer(&tracer);
+    runtime.run();
+    auto events = tracer.snapshot();
+    ASSERT_EQ(events.size(), 16);
+    auto &&last = events.back();
+    EXPECT_EQ(last.kind, jvm::TraceEvent::exit);
+    EXPECT_EQ(last.method->name, "main");
+    auto &&result = events[events.size() - 2];
+    EXPECT_EQ(result.kind, jvm::TraceEvent::exit);
+    EXPECT_EQ(result.method->name, "findNthPrime");
+    EXPECT_EQ(result.value.i, 229);
+}
+
+TEST(TestRuntime, OpcodeProfile) {
+    auto class_ = jvm::ClassLoader::loadFromFile(PATH_TO_PRIME_CALCULATOR_CLASS);
+    auto runtime = jvm::Runtime();
+    runtime.setFusion(false);
+    runtime.regClass(class_);
+    jvm::OpcodeProfile profile;
+    runtime.setOpcodeProfile(&profile);
+    jvm::RingBufferTracer tracer(2);
+    runtime.setTracer(&tracer);
+    runtime.run();
+    EXPECT_EQ(tracer.snapshot().front().value.i, 229);
+    EXPECT_GT(profile.pairCount(jvm::irem, jvm::ifne), 0);
+    EXPECT_GT(profile.count(jvm::invokestatic), 0);
+    auto pairs = profile.topPairs(4);
+    ASSERT_EQ(pairs.size(), 4);
+    EXPECT_GE(pairs[0].count, pairs[3].count);
+    auto triples = profile.topTriples(4);
+    ASSERT_EQ(triples.size(), 4);
+    EXPECT_GE(triples[0].count, triples[3].count);
+    EXPECT_GT(profile.averageStackDepth(), 0);
+    // main 调用 findNthPrime 一次，isPrime 对 2 至 229 各调用一次，manualSqrt 只对其中的奇数调用
+    auto calls = profile.calls();
+    ASSERT_EQ(calls.size(), 3);
+    EXPECT_EQ(calls[0].target, "PrimeCalculator.isPrime(I)Z");
+    EXPECT_EQ(calls[0].count, 228);
+    EXPECT_EQ(calls[1].target, "PrimeCalculator.manualSqrt(I)I");
+    EXPECT_EQ(calls[1].count, 114);
+    EXPECT_EQ(calls[2].count, 1);
+    EXPECT_EQ(profile.count(jvm::invokestatic), 228 + 114 + 1);
+
+    sese::io::ByteBuilder output;
+    profile.dumpJson(&output, 8);
+    std::string json(output.getReadableSize(), '\0');
+    output.read(json.data(), json.size());
+    EXPECT_NE(json.find("\"irem\": "), std::string::npos);
+    EXPECT_NE(json.find("{\"target\": \"PrimeCalculator.isPrime(I)Z\", \"count\": 228}"), std::string::npos);
+}
+
+TEST(TestRuntime, Profiler) {
+    auto runtime = jvm::Runtime();
+    runtime.regClass(jvm::ClassLoader::loadFromFile(PATH_TO_WORLD_CLASS));
+    runtime.regClass(jvm::ClassLoader::loadFromFile(PATH_TO_PRIME_CALCULATOR_CLASS));
+    jvm::Profiler profiler;
+    runtime.setProfiler(&profiler);
+    runtime.run();
+    auto methods = profiler.methods();
+    ASSERT_EQ(methods.size(), 2);
+    auto find = [&methods](std::string_view name) {
+        return *std::find_if(methods.begin(), methods.end(), [name](auto &&item) { return item.method->name == name; });
+    };
+    auto main = find("main");
+    EXPECT_EQ(main.invocations, 1);
+    EXPECT_EQ(main.bytecodes, 9);
+    EXPECT_GE(main.total_cycles, main.self_cycles + find("add").self_cycles);
+    auto lines = jvm::Profiler::lines(main);
+    ASSERT_EQ(lines.size(), 4);
+    EXPECT_EQ(lines[0].line, 3);
+    EXPECT_EQ(lines[0].bytecodes, 2);
+    EXPECT_EQ(lines[2].line, 5);
+    EXPECT_EQ(lines[2].bytecodes, 4);
+    EXPECT_EQ(jvm::Profiler::lines(find("add")).front().line, 9);
+
+    profiler.clear();
+    EXPECT_EQ(runtime.invoke<int32_t>("PrimeCalculator", "findNthPrime(I)I", 50), 229);
+    methods = profiler.methods();
+    ASSERT_EQ(methods.size(), 3);
+    EXPECT_EQ(find("isPrime").invocations, 228);
+    EXPECT_EQ(find("manualSqrt").invocations, 114);
+    EXPECT_EQ(profiler.depth(), 0);
+    sese::io::ByteBuilder output;
+    profiler.dumpFolded(&output);
+    std::string folded(output.getReadableSize(), '\0');
+    output.read(folded.data(), folded.size());
+    EXPECT_NE(folded.find("PrimeCalculator.findNthPrime;PrimeCalculator.isPrime;PrimeCalculator.manualSqrt "),
+              std::string::npos);
+    // 未捕获的异常穿过入口帧后调用路径恢复到调用前的深度
+    runtime.regClass(jvm::ClassLoader::loadFromFile(PATH_TO_EXCEPTIONS_CLASS));
+    EXPECT_THROW(runtime.invoke<int32_t>("Exceptions", "check(I)I", 1), sese::Exception);
+    EXPECT_EQ(profiler.depth(), 0);
+}
+
+TEST(TestRuntime, Jit) {
+    if (!jvm::Jit::supported()) GTEST_SKIP();
+    auto prime = jvm::ClassLoader::loadFromFile(PATH_TO_PRIME_CALCULATOR_CLASS);
+    auto pi = jvm::ClassLoader::loadFromFile(PATH_TO_PI_CALCULATOR_CLASS);
+    auto recursion = jvm::ClassLoader::loadFromFile(PATH_TO_RECURSION_CLASS);
+    for (auto &&class_: {prime, pi, recursion}) {
+        auto runtime = jvm::Runtime();
+        runtime.setJit(true);
+        runtime.regClass(class_);
+        jvm::RingBufferTracer tracer(2);
+        runtime.setTracer(&tracer);
+        runtime.run();
+        auto result = tracer.snapshot().front();
+        if (class_ == prime) {
+            EXPECT_NE(class_->getMethod("manualSqrt(I)I")->code_info->native, nullptr);
+            EXPECT_EQ(result.value.i, 229);
+        } else if (class_ == pi) {
+            EXPECT_NE(class_->getMethod("calculatePi(I)D")->code_info->native, nullptr);
+            EXPECT_NEAR(result.value.d, 3.14158, 1e-5);
+        } else {
+            EXPECT_EQ(result.value.i, 100000);
+        }
+    }
+}
+
+TEST(TestRuntime, Category) {
+    for (auto jit: {false, true}) {
+        auto class_ = jvm::ClassLoader::loadFromFile(PATH_TO_CATEGORY_CLASS);
+        auto runtime = jvm::Runtime();
+        runtime.setJit(jit);
+        runtime.regClass(class_);
+        EXPECT_NO_THROW(runtime.run());
+        std::vector<jvm::Slot> args(1);
+        args[0].i = 1000;
+        EXPECT_EQ(runtime.invokeStatic("Category", "sum(I)J", args).l, 665667000);
+        args[0].i = 98432;
+        EXPECT_EQ(runtime.invokeStatic("Category", "narrow(I)I", args).i, 256);
+        // long 参数占用两个 Slot
+        std::vector<jvm::Slot> wide(2);
+        wide[0].l = 123456789012;
+        EXPECT_EQ(runtime.invokeStatic("Category", "convert(J)J", wide).l, 369273107475);
+        if (jit && jvm::Jit::supported()) {
+            EXPECT_NE(class_->getMethod("convert(J)J")->code_info->native, nullptr);
+        }
+    }
+}
+
+TEST(TestRuntime, Bits) {
+    for (auto jit: {false, true}) {
+        auto class_ = jvm::ClassLoader::loadFromFile(PATH_TO_BITS_CLASS);
+        auto runtime = jvm::Runtime();
+        runtime.setJit(jit);
+        runtime.regClass(class_);
+        // Integer 与 Long 未注册，位运算方法只能以内建函数执行
+        EXPECT_NO_THROW(runtime.run());
+        std::vector<jvm::Slot> args(1);
+        args[0].i = 1000;
+        EXPECT_EQ(runtime.invokeStatic("Bits", "hash(I)J", args).l, -1920992048439730104);
+        args[0].i = 12345;
+        EXPECT_EQ(runtime.invokeStatic("Bits", "bits(I)I", args).i, -2112748108);
+        args[0].i = -7;
+        EXPECT_EQ(runtime.invokeStatic("Bits", "bits(I)I", args).i, 623965780);
+        if (jit && jvm::Jit::supported()) {
+            EXPECT_NE(class_->getMethod("hash(I)J")->code_info->native, nullptr);
+        }
+    }
+}
+
+TEST(TestRuntime, Linked) {
+    for (auto jit: {false, true}) {
+        auto class_ = jvm::ClassLoader::loadFromFile(PATH_TO_LINKED_CLASS);
+        auto runtime = jvm::Runtime();
+        runtime.setJit(jit);
+        runtime.regClass(class_);
+        EXPECT_NO_THROW(runtime.run());
+        std::vector<jvm::Slot> args(1);
+        args[0].i = 1000;
+        EXPECT_EQ(runtime.invokeStatic("Linked", "build(I)J", args).l, 335927046);
+        // 对象头 16 字节，随后依次为 long/double/引用、int/float、char/short、byte/boolean
+        EXPECT_EQ(class_->getInstanceSize(), 56);
+    }
+}
+
+TEST(TestRuntime, Arrays) {
+    for (auto jit: {false, true}) {
+        auto class_ = jvm::ClassLoader::loadFromFile(PATH_TO_SIEVE_CLASS);
+        auto runtime = jvm::Runtime();
+        runtime.setJit(jit);
+        // 较小的新生代使 multianewarray 在构造各维数组期间触发收集
+        runtime.setHeapSize(512 * 1024, 8 * 1024 * 1024);
+        runtime.regClass(class_);
+        EXPECT_NO_THROW(runtime.run());
+        std::vector<jvm::Slot> args(1);
+        args[0].i = 100000;
+        EXPECT_EQ(runtime.invokeStatic("Sieve", "primes(I)I", args).i, 9592);
+        EXPECT_EQ(runtime.invokeStatic("Sieve", "mix(I)J", args).l, -7709514624916428088);
+        args[0].i = 300;
+        EXPECT_EQ(runtime.invokeStatic("Sieve", "matrix(I)J", args).l, 403659060000);
+        args[0].i = -1;
+        EXPECT_THROW(runtime.invokeStatic("Sieve", "mix(I)J", args), sese::Exception);
+        if (jit && jvm::Jit::supported()) {
+            EXPECT_NE(class_->getMethod("sieve([Z)I")->code_info->native, nullptr);
+        }
+    }
+}
+
+TEST(TestRuntime, Native) {
+    for (auto jit: {false, true}) {
+        auto class_ = jvm::ClassLoader::loadFromFile(PATH_TO_NUMERIC_CLASS);
+        auto runtime = jvm::Runtime();
+        runtime.setJit(jit);
+        runtime.regNative("Numeric.scale(I)I", [](jvm::Slot *args) { args[0].i = args[0].i * 3 + 1; }, true);
+        runtime.regClass(class_);
+        EXPECT_NO_THROW(runtime.run());
+        std::vector<jvm::Slot> args(1);
+        args[0].i = 100000;
+        EXPECT_EQ(runtime.invokeStatic("Numeric", "countPrimes(I)I", args).i, 9592);
+        args[0].i = 1000;
+        EXPECT_EQ(runtime.invokeStatic("Numeric", "mix(I)J", args).l, 7939458498461031552);
+        EXPECT_EQ(runtime.invokeStatic("Numeric", "callScale(I)I", args).i, 1499500);
+        EXPECT_EQ(runtime.invokeStatic("Numeric", "special()I", {}).i, 255);
+        EXPECT_EQ(runtime.invoke<int32_t>("Numeric", "exact(II)I", 6, 7), 13 * 10000 - 100 + 42);
+        EXPECT_EQ(runtime.invoke<int64_t>("Numeric", "exact(JJ)J", int64_t{6}, int64_t{7}), 13 * 10000 - 100 + 42);
+        EXPECT_THROW(runtime.invoke<int32_t>("Numeric", "exact(II)I", INT32_MAX, 1), sese::Exception);
+        EXPECT_THROW(runtime.invoke<int32_t>("Numeric", "exact(II)I", INT32_MIN, 1), sese::Exception);
+        EXPECT_THROW(runtime.invoke<int32_t>("Numeric", "exact(II)I", 65536, 65536), sese::Exception);
+        EXPECT_THROW(runtime.invoke<int64_t>("Numeric", "exact(JJ)J", INT64_MAX, int64_t{1}), sese::Exception);
+        EXPECT_THROW(runtime.invoke<int64_t>("Numeric", "exact(JJ)J", INT64_MIN, int64_t{1}), sese::Exception);
+        EXPECT_THROW(runtime.invoke<int64_t>("Numeric", "exact(JJ)J", int64_t{1} << 32, int64_t{1} << 32),
+                     sese::Exception);
+        if (jit && jvm::Jit::supported()) {
+            EXPECT_NE(class_->getMethod("countPrimes(I)I")->code_info->native, nullptr);
+            EXPECT_NE(class_->getMethod("callScale(I)I")->code_info->native, nullptr);
+        }
+    }
+    // 未注册的本地方法
+    {
+        auto class_ = jvm::ClassLoader::loadFromFile(PATH_TO_NUMERIC_CLASS);
+        auto runtime = jvm::Runtime();
+        runtime.regClass(class_);
+        std::vector<jvm::Slot> args(1);
+        args[0].i = 10;
+        EXPECT_THROW(runtime.invokeStatic("Numeric", "callScale(I)I", args), sese::Exception);
+    }
+}
+
+TEST(TestRuntime, Switch) {
+    for (auto jit: {false, true}) {
+        auto class_ = jvm::ClassLoader::loadFromFile(PATH_TO_SWITCH_CLASS);
+        auto runtime = jvm::Runtime();
+        runtime.setJit(jit);
+        runtime.regClass(class_);
+        EXPECT_NO_THROW(runtime.run());
+        std::vector<jvm::Slot> args(1);
+        args[0].i = 1000;
+        EXPECT_EQ(runtime.invokeStatic("Switch", "dense(I)J", args).l, 6093806542004946230);
+        EXPECT_EQ(runtime.invokeStatic("Switch", "sparse(I)J", args).l, 6379);
+        const std::pair<int32_t, int32_t> classes[] = {
+            {' ', 0}, {'\t', 0}, {'\n', 0}, {'+', 1}, {'-', 1}, {'*', 2}, {'/', 2}, {'(', 3}, {')', 3},
+            {INT32_MIN, 5}, {INT32_MAX, 6}, {0, 4}, {11, 4}, {44, 4}, {48, 4}, {-1, 4}, {INT32_MIN + 1, 4},
+            {INT32_MAX - 1, 4},
+        };
+        for (auto &&[key, expected]: classes) {
+            args[0].i = key;
+            EXPECT_EQ(runtime.invokeStatic("Switch", "classify(I)I", args).i, expected);
+        }
+        const int32_t gaps[] = {0, 10, 20, 0, 40, 0};
+        for (int32_t k = -1; k < 6; ++k) {
+            args[0].i = k;
+            EXPECT_EQ(runtime.invokeStatic("Switch", "gap(I)I", args).i, k < 0 ? 0 : gaps[k]);
+        }
+        if (jit && jvm::Jit::supported()) {
+            EXPECT_NE(class_->getMethod("dense(I)J")->code_info->native, nullptr);
+            EXPECT_NE(class_->getMethod("sparse(I)J")->code_info->native, nullptr);
+        }
+    }
+}
+
+TEST(TestRuntime, Exceptions) {
+    for (auto jit: {false, true}) {
+        auto class_ = jvm::ClassLoader::loadFromFile(PATH_TO_EXCEPTIONS_CLASS);
+        auto runtime = jvm::Runtime();
+        runtime.setJit(jit);
+        runtime.regClass(class_);
+        runtime.regClass(jvm::ClassLoader::loadFromFile(PATH_TO_FAILURE_CLASS));
+        EXPECT_NO_THROW(runtime.run());
+        std::vector<jvm::Slot> args(1);
+        args[0].i = 1000;
+        EXPECT_EQ(runtime.invokeStatic("Exceptions", "throwMany(I)I", args).i, 34967);
+        args[0].i = 100;
+        EXPECT_EQ(runtime.invokeStatic("Exceptions", "nested(I)I", args).i, 1075);
+        args[0].ref = nullptr;
+        EXPECT_EQ(runtime.invokeStatic("Exceptions", "nullPointer([I)I", args).i, -1);
+        args[0].i = 0;
+        EXPECT_GT(runtime.invokeStatic("Exceptions", "depth(I)I", args).i, 100);
+        // 未捕获的异常以 C++ 异常的形式交给调用者
+        for (auto &&[code, expected]: {std::pair{1, "Failure"}, std::pair{0, "java/lang/IllegalStateException"}}) {
+            args[0].i = code;
+            try {
+                runtime.invokeStatic("Exceptions", "fail(I)V", args);
+                ADD_FAILURE();
+            } catch (sese::Exception &ex) {
+                EXPECT_STREQ(ex.what(), expected);
+            }
+        }
+    }
+    // finally 块重新抛出的异常
+    {
+        auto class_ = jvm::ClassLoader::loadFromFile(PATH_TO_HELLO_CLASS);
+        auto runtime = jvm::Runtime();
+        runtime.regClass(class_);
+        try {
+            runtime.run();
+            ADD_FAILURE();
+        } catch (sese::Exception &ex) {
+            EXPECT_STREQ(ex.what(), "java/lang/ArrayIndexOutOfBoundsException: Index 0 out of bounds for length 0");
+        }
+    }
+}
+
+TEST(TestRuntime, Statics) {
+    for (auto jit: {false, true}) {
+        auto class_ = jvm::ClassLoader::loadFromFile(PATH_TO_STATICS_CLASS);
+        auto runtime = jvm::Runtime();
+        runtime.setJit(jit);
+        // 较小的新生代使 churn 多次触发收集，静态字段引用的对象随之移动
+        runtime.setHeapSize(512 * 1024, 8 * 1024 * 1024);
+        runtime.regClass(class_);
+        runtime.regClass(jvm::ClassLoader::loadFromFile(PATH_TO_COUNTER_CLASS));
+        runtime.regClass(jvm::ClassLoader::loadFromFile(PATH_TO_BROKEN_CLASS));
+        EXPECT_NO_THROW(runtime.run());
+        std::vector<jvm::Slot> args(1);
+        args[0].i = 100;
+        EXPECT_EQ(runtime.invokeStatic("Statics", "sumSquares(I)I", args).i, 328350);
+        EXPECT_EQ(runtime.invokeStatic("Statics", "counter()I", {}).i, 200);
+        args[0].i = 10;
+        EXPECT_EQ(runtime.invokeStatic("Statics", "accumulate(I)J", args).l, 73806);
+        EXPECT_EQ(runtime.invokeStatic("Statics", "mix()I", {}).i, -1105);
+        EXPECT_EQ(runtime.invokeStatic("Statics", "mix()I", {}).i, -1106);
+        // Counter 只在首次访问时初始化一次
+        EXPECT_EQ(runtime.invokeStatic("Statics", "other()I", {}).i, 35);
+        EXPECT_EQ(runtime.invokeStatic("Statics", "other()I", {}).i, 41);
+        EXPECT_EQ(runtime.invokeStatic("Statics", "inits()I", {}).i, 1);
+        // <clinit> 抛出异常后，再次访问得到 NoClassDefFoundError
+        EXPECT_EQ(runtime.invokeStatic("Statics", "broken()I", {}).i, -1);
+        EXPECT_EQ(runtime.invokeStatic("Statics", "broken()I", {}).i, -2);
+        args[0].i = 20000;
+        EXPECT_EQ(runtime.invokeStatic("Statics", "churn(I)I", args).i, 9872);
+        if (jit && jvm::Jit::supported()) {
+            EXPECT_NE(class_->getMethod("sumSquares(I)I")->code_info->native, nullptr);
+            EXPECT_NE(class_->getMethod("accumulate(I)J")->code_info->native, nullptr);
+        }
+    }
+}
+
+TEST(TestRuntime, Invoke) {
+    for (auto jit: {false, true}) {
+        auto runtime = jvm::Runtime();
+        runtime.setJit(jit);
+        runtime.regClass(jvm::ClassLoader::loadFromFile(PATH_TO_PI_CALCULATOR_CLASS));
+        runtime.regClass(jvm::ClassLoader::loadFromFile(PATH_TO_PRIME_CALCULATOR_CLASS));
+        runtime.regClass(jvm::ClassLoader::loadFromFile(PATH_TO_STATICS_CLASS));
+        EXPECT_NEAR(runtime.invoke<double>("PiCalculator", "calculatePi(I)D", 100000), 3.14159, 1e-4);
+        // 句柄只解析一次，之后的调用不再查找方法
+        auto prime = runtime.findStatic("PrimeCalculator", "findNthPrime(I)I");
+        auto is_prime = runtime.findStatic("PrimeCalculator", "isPrime(I)Z");
+        ASSERT_TRUE(prime.valid());
+        for (int32_t i = 0; i < 100; ++i) {
+            EXPECT_EQ(runtime.invoke<int32_t>(prime, 10), 29);
+        }
+        EXPECT_TRUE(runtime.invoke<bool>(is_prime, 7919));
+        EXPECT_FALSE(runtime.invoke<bool>(is_prime, 7917));
+        EXPECT_EQ(runtime.invoke<int64_t>("Statics", "accumulate(I)J", 10), 73806);
+        // 参数与返回值的类型需要与描述符一致
+        EXPECT_THROW(runtime.invoke<int32_t>(prime, int64_t{10}), sese::Exception);
+        EXPECT_THROW(runtime.invoke<int32_t>(prime), sese::Exception);
+        EXPECT_THROW(runtime.invoke<double>(prime, 10), sese::Exception);
+        EXPECT_THROW(runtime.invoke<int32_t>(jvm::StaticMethod(), 10), sese::Exception);
+        EXPECT_THROW(runtime.findStatic("PrimeCalculator", "missing()V"), sese::Exception);
+    }
+}
+
+TEST(TestRuntime, InvokeBatch) {
+    for (auto jit: {false, true}) {
+        auto runtime = jvm::Runtime();
+        runtime.setJit(jit);
+        runtime.regClass(jvm::ClassLoader::loadFromFile(PATH_TO_PRIME_CALCULATOR_CLASS));
+        runtime.regClass(jvm::ClassLoader::loadFromFile(PATH_TO_EXCEPTIONS_CLASS));
+        runtime.regClass(jvm::ClassLoader::loadFromFile(PATH_TO_FAILURE_CLASS));
+        auto is_prime = runtime.findStatic("PrimeCalculator", "isPrime(I)Z");
+        std::vector<jvm::Slot> args(100000);
+        for (size_t i = 0; i < args.size(); ++i) {
+            args[i].i = static_cast<int32_t>(i);
+        }
+        for (size_t threads: {1, 4}) {
+            std::vector<jvm::Slot> results(args.size());
+            runtime.invokeBatch(is_prime, args.data(), results.data(), args.size(), threads);
+            auto count = std::count_if(results.begin(), results.end(), [](auto &&slot) { return slot.i != 0; });
+            EXPECT_EQ(count, 9592);
+            EXPECT_EQ(results[7919].i, 1);
+            EXPECT_EQ(results[7917].i, 0);
+        }
+        // 任意一次调用抛出的异常传递给调用者
+        auto check = runtime.findStatic("Exceptions", "check(I)I");
+        for (size_t threads: {1, 2}) {
+            EXPECT_THROW(runtime.invokeBatch(check, args.data() + 1, nullptr, 8, threads), sese::Exception);
+        }
+        // 工作线程在多次批量调用之间复用
+        std::vector<jvm::Slot> results(args.size());
+        for (int i = 0; i < 8; ++i) {
+            runtime.invokeBatch(is_prime, args.data(), results.data(), 1000, 4);
+            EXPECT_EQ(results[997].i, 1);
+        }
+        // 引用类型的参数不会随垃圾收集更新，不接受
+        auto main = runtime.findStatic("PrimeCalculator", "main([Ljava/lang/String;)V");
+        EXPECT_THROW(runtime.invokeBatch(main, args.data(), nullptr, 1), sese::Exception);
+    }
+}
+
+TEST(TestRuntime, Virtual) {
+    for (auto jit: {false, true}) {
+        auto runtime = jvm::Runtime();
+        runtime.setJit(jit);
+        for (auto &&path: {PATH_TO_VIRTUAL_CLASS, PATH_TO_SHAPE_CLASS, PATH_TO_BASE_CLASS, PATH_TO_SQUARE_CLASS,
+                           PATH_TO_RECT_CLASS, PATH_TO_HEX_CLASS, PATH_TO_TRI_CLASS, PATH_TO_CIRCLE_CLASS}) {
+            runtime.regClass(jvm::ClassLoader::loadFromFile(path));
+        }
+        EXPECT_NO_THROW(runtime.run());
+        std::vector<jvm::Slot> args(1);
+        args[0].i = 1000;
+        // 单态调用点只在首次调用时未命中
+        auto before = runtime.getDispatchStats();
+        EXPECT_EQ(runtime.invokeStatic("Virtual", "monomorphic(I)I", args).i, 9000);
+        auto after = runtime.getDispatchStats();
+        EXPECT_EQ(after.misses - before.misses, 1);
+        EXPECT_EQ(after.hits - before.hits, 999);
+        EXPECT_EQ(runtime.invokeStatic("Virtual", "polymorphic(I)I", args).i, 5666);
+        before = runtime.getDispatchStats();
+        EXPECT_EQ(runtime.invokeStatic("Virtual", "megamorphic(I)I", args).i, 7400);
+        after = runtime.getDispatchStats();
+        EXPECT_EQ(after.megamorphic_transitions - before.megamorphic_transitions, 1);
+        EXPECT_GT(after.polymorphic_transitions, before.polymorphic_transitions);
+        EXPECT_EQ(runtime.invokeStatic("Virtual", "defaults()I", {}).i, 50);
+    }
+}
+
+TEST(TestRuntime, Gc) {
+    // 较小的新生代使分配频繁触发收集，持有者或数组晋升后仍需通过卡表找到其指向的新生代对象
+    {
+        auto class_ = jvm::ClassLoader::loadFromFile(PATH_TO_GARBAGE_CLASS);
+        auto runtime = jvm::Runtime();
+        runtime.setHeapSize(512 * 1024, 8 * 1024 * 1024);
+        runtime.regClass(class_);
+        std::vector<jvm::Slot> args(1);
+        args[0].i = 200000;
+        EXPECT_EQ(runtime.invokeStatic("Garbage", "churn(I)J", args).l, 120 * 200000);
+        EXPECT_EQ(runtime.invokeStatic("Garbage", "churnArray(I)J", args).l, 120 * 200000);
+        auto stats = runtime.getGcStats();
+        EXPECT_GT(stats.minor_collections, 0);
+        EXPECT_GT(stats.bytes_promoted, 0);
+        EXPECT_GE(stats.total_pause_ns, stats.max_pause_ns);
+    }
+    // 每次构建的链表均全部存活并晋升，老年代放不下两条链表，需要回收上一次的链表
+    {
+        auto class_ = jvm::ClassLoader::loadFromFile(PATH_TO_LINKED_CLASS);
+        auto runtime = jvm::Runtime();
+        runtime.setHeapSize(512 * 1024, 8 * 1024 * 1024);
+        runtime.regClass(class_);
+        std::vector<jvm::Slot> args(1);
+        args[0].i = 100000;
+        for (int i = 0; i < 3; ++i) {
+            EXPECT_EQ(runtime.invokeStatic("Linked", "build(I)J", args).l, 333343574748502);
+        }
+        auto stats = runtime.getGcStats();
+        EXPECT_GT(stats.major_collections, 0);
+        EXPECT_GT(stats.bytes_reclaimed, 0);
+    }
+}
+
+TEST(TestRuntime, Threads) {
+    for (auto jit: {false, true}) {
+        auto runtime = jvm::Runtime();
+        runtime.setJit(jit);
+        // 较小的新生代使各线程的分配频繁触发收集，收集时其他线程需要在安全点暂停
+        runtime.setHeapSize(512 * 1024, 8 * 1024 * 1024);
+        for (auto &&path: {PATH_TO_GARBAGE_CLASS, PATH_TO_SIEVE_CLASS, PATH_TO_STATICS_CLASS, PATH_TO_COUNTER_CLASS,
+                           PATH_TO_BROKEN_CLASS, PATH_TO_VIRTUAL_CLASS, PATH_TO_SHAPE_CLASS, PATH_TO_BASE_CLASS,
+                           PATH_TO_SQUARE_CLASS, PATH_TO_RECT_CLASS, PATH_TO_HEX_CLASS, PATH_TO_TRI_CLASS,
+                           PATH_TO_CIRCLE_CLASS}) {
+            runtime.regClass(jvm::ClassLoader::loadFromFile(path));
+        }
+        std::atomic<int> failures{0};
+        auto worker = [&](int id) {
+            std::vector<jvm::Slot> args(1);
+            try {
+                for (int round = 0; round < 3; ++round) {
+                    // 各线程以不同的顺序首次访问各个类，类的初始化与解析在线程之间竞争
+                    switch ((id + round) % 4) {
+                        case 0:
+                            args[0].i = 200000;
+                            if (runtime.invokeStatic("Garbage", "churn(I)J", args).l != 120 * 200000) ++failures;
+                            break;
+                        case 1:
+                            args[0].i = 100000;
+                            if (runtime.invokeStatic("Sieve", "primes(I)I", args).i != 9592) ++failures;
+                            break;
+                        case 2:
+                            args[0].i = 1000;
+                            if (runtime.invokeStatic("Virtual", "megamorphic(I)I", args).i != 7400) ++failures;
+                            break;
+                        default:
+                            args[0].i = 100;
+                            if (runtime.invokeStatic("Statics", "sumSquares(I)I", args).i != 328350) ++failures;
+                            runtime.invokeStatic("Statics", "other()I", {});
+                            break;
+                    }
+                }
+            } catch (const sese::Exception &e) {
+                SESE_ERROR("%s", e.what());
+                ++failures;
+            }
+        };
+        std::vector<std::thread> threads;
+        for (int i = 0; i < 4; ++i) {
+            threads.emplace_back(worker, i);
+        }
+        for (auto &&thread: threads) {
+            thread.join();
+        }
+        EXPECT_EQ(failures, 0);
+        // Counter 的 <clinit> 只执行一次
+        EXPECT_EQ(runtime.invokeStatic("Statics", "inits()I", {}).i, 1);
+        EXPECT_GT(runtime.getGcStats().minor_collections, 0);
+    }
+}
+
+TEST(TestRuntime, TypeMap) {
+    auto class_ = jvm::ClassLoader::loadFromFile(PATH_TO_CATEGORY_CLASS);
+    auto runtime = jvm::Runtime();
+    runtime.regClass(class_);
+    using VT = jvm::VerificationType;
+    auto &&code_info = *class_->getMethod("sum(I)J")->code_info;
+    auto &&map = code_info.type_map;
+    EXPECT_EQ(map.depths[0], 0);
+    EXPECT_EQ(map.at(0)[0], VT::int_);
+    EXPECT_EQ(map.at(0)[1], VT::top);
+    // lreturn 之前：n、total、last、i 与栈顶的 long
+    auto index = code_info.instructions.size() - 2;
+    ASSERT_EQ(map.depths[index], 2);
+    auto types = map.at(index);
+    EXPECT_EQ(types[0], VT::int_);
+    EXPECT_EQ(types[1], VT::long_);
+    EXPECT_EQ(types[2], VT::top);
+    EXPECT_EQ(types[3], VT::long_);
+    EXPECT_EQ(types[5], VT::int_);
+    EXPECT_EQ(types[code_info.max_locals], VT::long_);
+
+    // 含有对象、字段与异常处理器的类同样可以通过推导
+    auto hello = jvm::ClassLoader::loadFromFile(PATH_TO_HELLO_CLASS);
+    EXPECT_NO_THROW(runtime.regClass(hello));
+}
@@ -0,0 +1,33 @@
+public class Bits {
+
+    public static void main(String[] args) {
+        long hash = hash(1000);
+        int bits = bits(12345);
+    }
+
+    public static long hash(int n) {
+        long h = 0xcbf29ce484222325L;
+        for (int i = 0; i < n; i++) {
+            h ^= i & 0xff;
+            h *= 0x100000001b3L;
+            h ^= (long) i << 32 | i >>> 3;
+        }
+        h ^= h >>> 33;
+        h *= 0xff51afd7ed558ccdL;
+        h ^= h >>> 33;
+        h *= 0xc4ceb9fe1a85ec53L;
+        h ^= h >>> 33;
+        return h;
+    }
+
+    public static int bits(int x) {
+        int r = Integer.bitCount(x) + Integer.numberOfTrailingZeros(x) + Integer.numberOfLeadingZeros(x);
+        r ^= Integer.rotateLeft(x, 7) ^ Integer.rotateRight(x, 3) ^ Integer.reverseBytes(x);
+        long y = x * 0x9e3779b97f4a7c15L;
+        r += Long.bitCount(y) + Long.numberOfTrailingZeros(y) + Long.numberOfLeadingZeros(y);
+        r += (int) (Long.rotateLeft(y, 13) ^ Long.rotateRight(y, 17) ^ Long.reverseBytes(y));
+        r += (int) (y >> 7 & 0xffffL);
+        r += (x >> 2) + (x << 5) + (~x & 0xf0f0) | x ^ 0x5555;
+        return r;
+    }
+}
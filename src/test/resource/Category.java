@@ -0,0 +1,40 @@
+public class Category {
+
+    public static void main(String[] args) {
+        long sum = sum(1000);
+        int narrow = narrow(98432);
+        long convert = convert(123456789012L);
+        sum(10);
+    }
+
+    public static long sum(int n) {
+        long total = 0;
+        long last = 0;
+        for (int i = 0; i < n; i++) {
+            total = last = total + (long) i * i;
+        }
+        return total + last;
+    }
+
+    public static int narrow(int n) {
+        byte b = (byte) n;
+        char c = (char) n;
+        short s = (short) n;
+        int x, y;
+        x = y = b + c + s;
+        return x + y;
+    }
+
+    public static long convert(long value) {
+        double d = value;
+        int i = (int) value;
+        float f = i;
+        long a = (long) d;
+        int b = (int) d;
+        long c = (long) f;
+        int e = (int) (f * 4096f);
+        double g = (float) d;
+        float h = value;
+        return a + b + c + e + (long) g + (long) h;
+    }
+}
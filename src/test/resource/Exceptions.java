@@ -0,0 +1,76 @@
+public class Exceptions {
+    public static void main(String[] args) {
+        int value = throwMany(1000);
+    }
+
+    // 受检异常与运行时抛出的异常交替出现，在调用者中被不同的处理器捕获
+    public static int throwMany(int n) {
+        int sum = 0;
+        for (int i = 0; i < n; i++) {
+            try {
+                sum += check(i);
+            } catch (Failure e) {
+                sum += 2;
+            } catch (ArithmeticException e) {
+                sum += 3;
+            }
+        }
+        return sum;
+    }
+
+    public static int check(int i) throws Failure {
+        if (i % 3 == 0) {
+            throw new Failure();
+        }
+        return 100 / (i % 3 - 1);
+    }
+
+    // finally 块在正常和异常退出时都会执行，异常随后被外层的处理器捕获
+    public static int nested(int n) {
+        int sum = 0;
+        for (int i = 0; i < n; i++) {
+            try {
+                try {
+                    int[] values = new int[i % 4];
+                    sum += values[2];
+                } finally {
+                    sum += 10;
+                }
+            } catch (IndexOutOfBoundsException e) {
+                sum += 1;
+            }
+        }
+        return sum;
+    }
+
+    public static int nullPointer(int[] values) {
+        try {
+            return values.length;
+        } catch (NullPointerException e) {
+            return -1;
+        }
+    }
+
+    // 未捕获的异常传播到调用者
+    public static void fail(int code) throws Failure {
+        if (code > 0) {
+            throw new Failure();
+        }
+        throw new IllegalStateException();
+    }
+
+    // 递归直到栈溢出，最深的一层捕获异常
+    public static int depth(int d) {
+        try {
+            return depth(d + 1);
+        } catch (StackOverflowError e) {
+            return d;
+        }
+    }
+}
+
+class Failure extends Exception {
+    Failure() {
+        super();
+    }
+}
@@ -0,0 +1,58 @@
+public class Garbage {
+    Garbage next;
+    Garbage child;
+    long value;
+
+    public static void main(String[] args) {
+        long total = churn(200000);
+    }
+
+    public static long churn(int n) {
+        Garbage holders = null;
+        for (int i = 0; i < 16; i++) {
+            Garbage holder = new Garbage();
+            holder.next = holders;
+            holders = holder;
+        }
+        // 持有者晋升到老年代，此时其引用字段均指向老年代
+        garbage(n);
+        int i = 0;
+        for (Garbage holder = holders; holder != null; holder = holder.next) {
+            Garbage child = new Garbage();
+            child.value = (long) i * n;
+            holder.child = child;
+            i++;
+        }
+        // 新分配的对象仅被老年代的持有者引用
+        garbage(n);
+        long total = 0;
+        for (Garbage holder = holders; holder != null; holder = holder.next) {
+            total += holder.child.value;
+        }
+        return total;
+    }
+
+    public static long churnArray(int n) {
+        Garbage[] holders = new Garbage[16];
+        // 数组晋升到老年代
+        garbage(n);
+        for (int i = 0; i < holders.length; i++) {
+            Garbage child = new Garbage();
+            child.value = (long) i * n;
+            holders[i] = child;
+        }
+        // 新分配的对象仅被老年代的数组引用
+        garbage(n);
+        long total = 0;
+        for (int i = 0; i < holders.length; i++) {
+            total += holders[i].value;
+        }
+        return total;
+    }
+
+    public static void garbage(int n) {
+        for (int i = 0; i < n; i++) {
+            new Garbage();
+        }
+    }
+}
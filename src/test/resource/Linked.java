@@ -0,0 +1,42 @@
+public class Linked {
+    int value;
+    long weight;
+    byte tag;
+    char mark;
+    short level;
+    boolean flag;
+    double ratio;
+    float scale;
+    Linked next;
+
+    public Linked(int value, Linked next) {
+        this.value = value;
+        this.next = next;
+    }
+
+    public static void main(String[] args) {
+        long total = build(1000);
+    }
+
+    public static long build(int n) {
+        Linked head = null;
+        for (int i = 0; i < n; i++) {
+            head = new Linked(i, head);
+            head.weight = (long) i * i;
+            head.tag = (byte) i;
+            head.mark = (char) i;
+            head.level = (short) (i * 300);
+            head.flag = i % 3 == 0;
+            head.ratio = i * 0.5;
+            head.scale = i;
+        }
+        long total = 0;
+        for (Linked node = head; node != null; node = node.next) {
+            total += node.value + node.weight + node.tag + node.mark + node.level + (long) node.ratio + (long) node.scale;
+            if (node.flag) {
+                total++;
+            }
+        }
+        return total;
+    }
+}
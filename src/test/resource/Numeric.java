@@ -0,0 +1,69 @@
+public class Numeric {
+    public static void main(String[] args) {
+        long start = System.nanoTime();
+        int count = countPrimes(100000);
+        long elapsed = System.nanoTime() - start;
+    }
+
+    // 试除法，上界由 Math.sqrt 给出，可以被 JIT 编译
+    public static int countPrimes(int n) {
+        int count = 0;
+        for (int i = 2; i < n; i++) {
+            int limit = (int) Math.sqrt(i);
+            int j = 2;
+            while (j <= limit && i % j != 0) {
+                j++;
+            }
+            if (j > limit) {
+                count++;
+            }
+        }
+        return count;
+    }
+
+    public static long mix(int n) {
+        long hash = 0;
+        for (int i = -n; i < n; i++) {
+            hash = hash * 31 + Math.floorMod(i, 7);
+            hash = hash * 31 + Math.abs(i);
+            hash = hash * 31 + Math.max(i, 3) - Math.min(i, -3);
+            hash = hash * 31 + Math.round(Math.pow(i, 2) / 3.0);
+            hash = hash * 31 + (long) Math.floor(i / 3.0);
+        }
+        return hash;
+    }
+
+    // NaN、有符号零以及取整边界等与 C 标准库不同的语义，全部满足时返回 255
+    public static int special() {
+        int bits = 0;
+        if (Double.isNaN(Math.max(Double.NaN, 1.0))) bits |= 1;
+        if (Double.doubleToRawLongBits(Math.min(0.0, -0.0)) == Long.MIN_VALUE) bits |= 2;
+        if (Math.round(-2.5) == -2) bits |= 4;
+        if (Math.round(Double.NaN) == 0) bits |= 8;
+        if (Math.abs(Integer.MIN_VALUE) == Integer.MIN_VALUE) bits |= 16;
+        if (Math.floorDiv(-7, 2) == -4) bits |= 32;
+        if (Double.isNaN(Math.pow(1.0, Double.POSITIVE_INFINITY))) bits |= 64;
+        if (Math.round(0.49999999999999994) == 0) bits |= 128;
+        return bits;
+    }
+
+    // Math.*Exact 在结果溢出时抛出 ArithmeticException
+    public static int exact(int a, int b) {
+        return Math.addExact(a, b) * 10000 + Math.subtractExact(a, b) * 100 + Math.multiplyExact(a, b);
+    }
+
+    public static long exact(long a, long b) {
+        return Math.addExact(a, b) * 10000 + Math.subtractExact(a, b) * 100 + Math.multiplyExact(a, b);
+    }
+
+    // 由宿主通过 Runtime::regNative 提供
+    public static native int scale(int value);
+
+    public static int callScale(int n) {
+        int sum = 0;
+        for (int i = 0; i < n; i++) {
+            sum += scale(i);
+        }
+        return sum;
+    }
+}
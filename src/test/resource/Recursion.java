@@ -0,0 +1,21 @@
+public class Recursion {
+
+    public static void main(String[] args) {
+        int fib = fib(20);
+        int depth = depth(100000);
+    }
+
+    public static int fib(int n) {
+        if (n < 2) {
+            return n;
+        }
+        return fib(n - 1) + fib(n - 2);
+    }
+
+    public static int depth(int n) {
+        if (n == 0) {
+            return 0;
+        }
+        return depth(n - 1) + 1;
+    }
+}
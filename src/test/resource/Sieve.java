@@ -0,0 +1,83 @@
+import java.util.Arrays;
+
+public class Sieve {
+    public static void main(String[] args) {
+        int count = primes(args.length + 100000);
+    }
+
+    public static int primes(int n) {
+        boolean[] composite = new boolean[n + 1];
+        return sieve(composite);
+    }
+
+    // 埃氏筛，只访问数组，可以被 JIT 编译
+    static int sieve(boolean[] composite) {
+        int count = 0;
+        for (int i = 2; i < composite.length; i++) {
+            if (!composite[i]) {
+                count++;
+                for (int j = i + i; j < composite.length; j += i) {
+                    composite[j] = true;
+                }
+            }
+        }
+        return count;
+    }
+
+    // 各种元素类型的数组以及 System.arraycopy、Arrays.fill
+    public static long mix(int n) {
+        int[] ints = new int[n];
+        long[] longs = new long[n];
+        double[] doubles = new double[n];
+        float[] floats = new float[n];
+        char[] chars = new char[n];
+        short[] shorts = new short[n];
+        byte[] bytes = new byte[n];
+        for (int i = 0; i < n; i++) {
+            ints[i] = i * i;
+            longs[i] = (long) i << 33;
+            doubles[i] = i * 0.5;
+            floats[i] = i * 0.25f;
+            chars[i] = (char) (i * 7919);
+            shorts[i] = (short) (i * 7919);
+            bytes[i] = (byte) i;
+        }
+        int[] copy = new int[n * 2];
+        System.arraycopy(ints, 0, copy, n, n);
+        // 源与目标区间重叠
+        System.arraycopy(copy, n, copy, n / 2, n);
+        Arrays.fill(longs, n / 2, n, 7L);
+        Arrays.fill(bytes, (byte) -3);
+        long sum = 0;
+        for (int i = 0; i < n; i++) {
+            sum += copy[i] + longs[i] + (long) doubles[i] + (long) floats[i] + chars[i] + shorts[i] + bytes[i];
+        }
+        return sum + copy.length;
+    }
+
+    // 多维数组以及元素为数组的引用数组
+    public static long matrix(int n) {
+        long[][] m = new long[n][n];
+        for (int i = 0; i < n; i++) {
+            for (int j = 0; j < n; j++) {
+                m[i][j] = (long) i * j;
+            }
+        }
+        long[][] t = new long[n][];
+        for (int i = 0; i < n; i++) {
+            t[i] = new long[n];
+        }
+        for (int i = 0; i < n; i++) {
+            for (int j = 0; j < n; j++) {
+                t[j][i] = m[i][j] + 1;
+            }
+        }
+        long sum = 0;
+        for (int i = 0; i < n; i++) {
+            for (int j = 0; j < n; j++) {
+                sum += t[i][j] * (i + 1);
+            }
+        }
+        return sum;
+    }
+}
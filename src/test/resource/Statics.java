@@ -0,0 +1,102 @@
+public class Statics {
+    static int counter;
+    static long total = 1;
+    static int[] squares = new int[100];
+    static Statics instance;
+    static byte small = -3;
+    static char letter = 'x';
+    static short medium = -1234;
+    static boolean flag;
+    static float ratio = 0.5f;
+    static double scale = 2.5;
+    static int inits;
+
+    int value;
+
+    static {
+        for (int i = 0; i < squares.length; i++) {
+            squares[i] = i * i;
+        }
+        instance = new Statics();
+        instance.value = 7;
+    }
+
+    public static void main(String[] args) {
+        int sum = sumSquares(100);
+    }
+
+    // 读取在 <clinit> 中填充的静态数组并累加静态计数器
+    public static int sumSquares(int n) {
+        int sum = 0;
+        for (int i = 0; i < n; i++) {
+            sum += squares[i];
+            counter++;
+        }
+        return sum;
+    }
+
+    public static long accumulate(int n) {
+        for (int i = 0; i < n; i++) {
+            total = total * 3 + i;
+        }
+        return total;
+    }
+
+    public static int counter() {
+        return counter;
+    }
+
+    // 各种宽度的静态字段
+    public static int mix() {
+        flag = !flag;
+        return small + letter + medium + (flag ? 1 : 0) + (int) (ratio * 4) + (int) scale + instance.value;
+    }
+
+    // 访问其他类的静态字段与静态方法，触发其初始化
+    public static int other() {
+        return Counter.next() + Counter.next() + Counter.count;
+    }
+
+    public static int inits() {
+        return inits;
+    }
+
+    public static int broken() {
+        try {
+            return Broken.value;
+        } catch (ExceptionInInitializerError e) {
+            return -1;
+        } catch (NoClassDefFoundError e) {
+            return -2;
+        }
+    }
+
+    // 大量分配触发垃圾收集，静态字段引用的对象需要保持可达
+    public static int churn(int n) {
+        int[] last = null;
+        for (int i = 0; i < n; i++) {
+            last = new int[64];
+        }
+        return instance.value + squares[99] + last.length;
+    }
+}
+
+class Counter {
+    static int count = 10;
+
+    static {
+        Statics.inits++;
+    }
+
+    static int next() {
+        return ++count;
+    }
+}
+
+class Broken {
+    static int value = 1 / zero();
+
+    static int zero() {
+        return 0;
+    }
+}
@@ -0,0 +1,103 @@
+public class Switch {
+    public static void main(String[] args) {
+        long value = dense(1000) + sparse(1000);
+    }
+
+    // 连续的键，编译为 tableswitch
+    public static long dense(int n) {
+        long sum = 0;
+        for (int i = 0; i < n; i++) {
+            switch (i % 7 - 3) {
+                case -3:
+                    sum += 1;
+                    break;
+                case -2:
+                    sum += i;
+                    break;
+                case -1:
+                    sum -= 2;
+                    break;
+                case 0:
+                    sum *= 3;
+                    break;
+                case 1:
+                    sum ^= i;
+                    break;
+                case 2:
+                    sum += 7;
+                    break;
+                default:
+                    sum -= i;
+                    break;
+            }
+        }
+        return sum;
+    }
+
+    // 稀疏的键，编译为 lookupswitch
+    public static long sparse(int n) {
+        long sum = 0;
+        for (int i = 0; i < n; i++) {
+            switch (i * 37 % 101) {
+                case 3:
+                    sum += 1;
+                    break;
+                case 10:
+                    sum += i;
+                    break;
+                case 32:
+                    sum -= 5;
+                    break;
+                case 64:
+                    sum ^= i;
+                    break;
+                case 99:
+                    sum += 11;
+                    break;
+                default:
+                    sum += 2;
+                    break;
+            }
+        }
+        return sum;
+    }
+
+    // 词法分析中常见的字符分类，键包含 int 的两端
+    public static int classify(int c) {
+        switch (c) {
+            case ' ':
+            case '\t':
+            case '\n':
+                return 0;
+            case '+':
+            case '-':
+                return 1;
+            case '*':
+            case '/':
+                return 2;
+            case '(':
+            case ')':
+                return 3;
+            case Integer.MIN_VALUE:
+                return 5;
+            case Integer.MAX_VALUE:
+                return 6;
+            default:
+                return 4;
+        }
+    }
+
+    // 键之间存在空缺
+    public static int gap(int k) {
+        switch (k) {
+            case 1:
+                return 10;
+            case 2:
+                return 20;
+            case 4:
+                return 40;
+            default:
+                return 0;
+        }
+    }
+}
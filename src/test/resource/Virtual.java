@@ -0,0 +1,131 @@
+public class Virtual {
+    public static void main(String[] args) {
+        int value = polymorphic(1000);
+    }
+
+    // 调用点只出现一种接收者类型
+    public static int monomorphic(int n) {
+        Shape shape = new Square(3);
+        int sum = 0;
+        for (int i = 0; i < n; i++) {
+            sum += shape.area();
+        }
+        return sum;
+    }
+
+    // 抽象类中调用由子类实现的方法，调用点出现三种接收者类型
+    public static int polymorphic(int n) {
+        Base[] shapes = {new Square(2), new Rect(2, 3), new Hex(1)};
+        int sum = 0;
+        for (int i = 0; i < n; i++) {
+            sum += shapes[i % shapes.length].describe();
+        }
+        return sum;
+    }
+
+    // 接收者类型超过内联缓存的容量，默认方法与重写的默认方法交替出现
+    public static int megamorphic(int n) {
+        Shape[] shapes = {new Square(2), new Rect(2, 3), new Hex(1), new Tri(4), new Circle(1)};
+        int sum = 0;
+        for (int i = 0; i < n; i++) {
+            sum += shapes[i % shapes.length].scaled(i % 4);
+        }
+        return sum;
+    }
+
+    // 通过类调用接口中的默认方法
+    public static int defaults() {
+        return new Square(5).scaled(2);
+    }
+}
+
+interface Shape {
+    int area();
+
+    default int scaled(int k) {
+        return area() * k;
+    }
+}
+
+abstract class Base implements Shape {
+    int size;
+
+    Base(int size) {
+        this.size = size;
+    }
+
+    public int id() {
+        return 0;
+    }
+
+    int describe() {
+        return area() + id();
+    }
+}
+
+class Square extends Base {
+    Square(int side) {
+        super(side);
+    }
+
+    public int area() {
+        return size * size;
+    }
+
+    public int id() {
+        return 1;
+    }
+}
+
+class Rect extends Base {
+    int height;
+
+    Rect(int width, int height) {
+        super(width);
+        this.height = height;
+    }
+
+    public int area() {
+        return size * height;
+    }
+
+    public int id() {
+        return 2;
+    }
+
+    public int scaled(int k) {
+        return area() * k + 1;
+    }
+}
+
+class Hex extends Square {
+    Hex(int side) {
+        super(side);
+    }
+
+    public int area() {
+        return super.area() * 3;
+    }
+}
+
+class Tri extends Base {
+    Tri(int base) {
+        super(base);
+    }
+
+    public int area() {
+        return size * size / 2;
+    }
+}
+
+class Circle implements Shape {
+    int radius;
+
+    Circle(int radius) {
+        this.radius = radius;
+    }
+
+    public int area() {
+        return 3 * radius * radius;
+    }
+}